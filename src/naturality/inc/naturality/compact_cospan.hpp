@@ -0,0 +1,77 @@
+#ifndef __COMPACT_COSPAN_HPP_
+#define __COMPACT_COSPAN_HPP_
+
+#include "naturality/cospan.hpp"
+#include "naturality/cospan_shared_count.hpp"
+#include "naturality/cospan_substitution.hpp"
+
+#include <cstdint>
+
+namespace Project {
+namespace Naturality {
+
+enum class CompactTag : std::uint8_t { VALUE, PAIR, EMPTY, MORPHISM };
+
+struct CompactNode {
+  std::uint8_t tag;
+  std::uint32_t first;
+  std::uint32_t second;
+};
+
+struct CompactMorphism {
+  std::vector<CompactNode> nodes;
+};
+
+struct CompactCospan {
+  std::vector<CompactMorphism> domains;
+  std::vector<std::pair<std::size_t, std::size_t>> shared_counts;
+  std::size_t start_identifier;
+  std::size_t total_number_of_identifiers;
+};
+
+CompactNode create_compact_node(CompactTag, Types::Variance, std::uint32_t,
+                                std::uint32_t);
+
+CompactTag get_tag(CompactNode const &);
+
+Types::Variance get_variance(CompactNode const &);
+
+std::size_t subtree_size(CompactNode const &);
+
+CompactMorphism to_compact(CospanMorphism const &);
+
+CospanMorphism from_compact(CompactMorphism const &);
+
+std::vector<CompactMorphism> to_compact(std::vector<CospanMorphism> const &);
+
+std::vector<CospanMorphism> from_compact(std::vector<CompactMorphism> const &);
+
+CompactCospan to_compact(CospanStructure const &);
+
+CospanStructure from_compact(CompactCospan const &);
+
+bool is_equal(CompactMorphism const &, CompactMorphism const &);
+
+bool is_equal(CompactCospan const &, CompactCospan const &);
+
+std::size_t hash_value(CompactMorphism const &);
+
+std::size_t hash_value(CompactCospan const &);
+
+CompactMorphism zip_cospan_morphisms(CompactMorphism const &,
+                                     CompactMorphism const &);
+
+MorphismBounds morphism_bounds(CompactMorphism const &);
+
+std::vector<std::pair<std::size_t, std::size_t>>
+shared_count(std::vector<CompactMorphism> const &);
+
+CompactMorphism cospan_substitution(VariableSubstitution &,
+                                    SubstitutionTemplates const &,
+                                    CompactMorphism const &,
+                                    Types::TypeConstructor const &);
+
+} // namespace Naturality
+} // namespace Project
+
+#endif
@@ -0,0 +1,118 @@
+#ifndef __COMPOSITION_CACHE_HPP_
+#define __COMPOSITION_CACHE_HPP_
+
+#include "naturality/compact_cospan.hpp"
+#include "naturality/cospan.hpp"
+#include "naturality/cospan_composition.hpp"
+#include "naturality/natural_transformation.hpp"
+
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+namespace Project {
+namespace Naturality {
+
+struct CachedComposition {
+  NaturalTransformation transformation;
+  CompositionResult result;
+};
+
+struct CompositionCacheStatistics {
+  std::size_t hits;
+  std::size_t misses;
+  std::size_t evictions;
+  std::size_t store_hits;
+  std::size_t entries;
+  std::size_t memory_footprint;
+};
+
+struct CompositionKey {
+  NaturalTransformation left;
+  CompactCospan left_cospan;
+  NaturalTransformation right;
+  CompactCospan right_cospan;
+  std::size_t hash;
+};
+
+struct CompositionKeyHash {
+  std::size_t operator()(CompositionKey const &) const;
+  std::size_t operator()(CompositionKey const *) const;
+};
+
+struct CompositionKeyEqual {
+  bool operator()(CompositionKey const &, CompositionKey const &) const;
+  bool operator()(CompositionKey const *, CompositionKey const *) const;
+};
+
+class CompositionStore;
+
+CompositionKey create_composition_key(NaturalTransformation const &,
+                                      CospanStructure const &,
+                                      NaturalTransformation const &,
+                                      CospanStructure const &);
+
+std::size_t hash_value(CompositionKey const &);
+
+CachedComposition compose(NaturalTransformation const &,
+                          CospanStructure const &,
+                          NaturalTransformation const &,
+                          CospanStructure const &);
+
+class CompositionCache {
+public:
+  using Entry = std::shared_ptr<CachedComposition const>;
+
+  explicit CompositionCache(std::size_t);
+
+  Entry find(NaturalTransformation const &, CospanStructure const &,
+             NaturalTransformation const &, CospanStructure const &);
+  Entry insert(NaturalTransformation const &, CospanStructure const &,
+               NaturalTransformation const &, CospanStructure const &,
+               CachedComposition &&);
+  Entry compose(NaturalTransformation const &, CospanStructure const &,
+                NaturalTransformation const &, CospanStructure const &);
+
+  void set_store(std::shared_ptr<CompositionStore>);
+  void set_memory_limit(std::size_t);
+  void clear();
+  CompositionCacheStatistics statistics() const;
+
+private:
+  struct Node {
+    CompositionKey key;
+    Entry entry;
+    std::size_t footprint;
+  };
+
+  using Nodes = std::list<Node>;
+  using Index = std::unordered_map<CompositionKey const *, Nodes::iterator,
+                                   CompositionKeyHash, CompositionKeyEqual>;
+
+  Entry find_cached(CompositionKey const &);
+  Entry find_stored(CompositionKey const &);
+  Entry insert(CompositionKey &&, CachedComposition &&);
+  Entry remember(CompositionKey &&, CachedComposition &&);
+  void evict();
+
+  mutable std::mutex m_mutex;
+  Nodes m_nodes;
+  Index m_index;
+  std::size_t m_memory_limit;
+  std::size_t m_memory_footprint;
+  std::size_t m_hits;
+  std::size_t m_misses;
+  std::size_t m_evictions;
+  std::size_t m_store_hits;
+  std::shared_ptr<CompositionStore> m_store;
+};
+
+std::size_t memory_footprint(NaturalTransformation const &);
+
+std::size_t memory_footprint(CospanStructure const &);
+
+} // namespace Naturality
+} // namespace Project
+
+#endif
@@ -0,0 +1,63 @@
+#ifndef __COMPOSITION_STORE_HPP_
+#define __COMPOSITION_STORE_HPP_
+
+#include "naturality/composition_cache.hpp"
+
+#include <cstdint>
+#include <istream>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace Project {
+namespace Naturality {
+
+constexpr std::uint32_t composition_store_version = 2;
+constexpr std::size_t default_composition_store_limit = 256u << 20;
+
+class CompositionStore {
+public:
+  explicit CompositionStore(std::string, std::size_t size_limit =
+                                             default_composition_store_limit);
+
+  std::optional<CachedComposition> find(CompositionKey const &);
+  void append(CompositionKey const &, CachedComposition const &);
+
+  std::size_t size();
+  std::string const &path() const;
+
+private:
+  struct Location {
+    std::size_t hash;
+    std::uint64_t offset;
+    std::uint64_t size;
+  };
+
+  using Index = std::unordered_multimap<std::size_t, std::size_t>;
+
+  void load();
+  bool read_locations(std::istream &);
+  std::optional<CachedComposition> read(CompositionKey const &);
+  void compact(std::string const &, std::size_t);
+  void add_location(Location const &);
+
+  std::mutex m_mutex;
+  std::string m_path;
+  std::size_t m_size_limit;
+  std::vector<Location> m_locations;
+  Index m_index;
+  std::uint64_t m_end;
+  bool m_loaded;
+  bool m_consistent;
+};
+
+std::string serialize(CompositionKey const &, CachedComposition const &);
+
+bool deserialize(std::string const &, CompositionKey &, CachedComposition &);
+
+} // namespace Naturality
+} // namespace Project
+
+#endif
@@ -5,6 +5,7 @@
 
 #include <cstddef>
 #include <memory>
+#include <stdexcept>
 #include <string>
 #include <variant>
 #include <vector>
@@ -28,9 +29,28 @@ struct CospanStructure {
   std::size_t total_number_of_identifiers;
 };
 
+struct CospanMismatch {
+  std::size_t domain;
+  std::vector<std::size_t> path;
+  std::string reason;
+};
+
+template <typename T> using Checked = std::variant<T, CospanMismatch>;
+
+std::string to_string(CospanMismatch const &);
+
+template <typename T> T get_checked(Checked<T> &&checked) {
+  if (auto const mismatch = std::get_if<CospanMismatch>(&checked))
+    throw std::runtime_error(mismatch->reason);
+  return std::move(std::get<T>(checked));
+}
+
 CospanStructure create_default_cospan(Types::TypeConstructor const &,
                                       Types::TypeConstructor const &);
 
+CospanStructure
+create_default_cospan(std::vector<Types::TypeConstructor> const &);
+
 } // namespace Naturality
 } // namespace Project
 
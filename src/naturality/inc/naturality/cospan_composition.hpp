@@ -2,6 +2,8 @@
 #define __COSPAN_COMPOSITION_HPP_
 
 #include "naturality/cospan.hpp"
+#include "naturality/cospan_shared_count.hpp"
+#include "naturality/cospan_substitution.hpp"
 #include "naturality/natural_transformation.hpp"
 #include "polymorphic_types/unification.hpp"
 
@@ -13,11 +15,62 @@ struct CompositionResult {
   std::vector<std::size_t> value_count;
 };
 
+struct CompositionTemplates {
+  SubstitutionTemplates left;
+  SubstitutionTemplates right;
+};
+
+struct LeftComposition {
+  std::vector<CospanMorphism> domains;
+  VariableSubstitution substitution;
+  std::vector<MorphismBounds> bounds;
+  std::vector<std::pair<std::size_t, std::size_t>> shared_counts;
+};
+
+using CospanPairs = std::vector<std::pair<CospanStructure, CospanStructure>>;
+
+CompositionTemplates create_composition_templates(Types::Unification const &);
+
+LeftComposition compose_left_cospan(CospanStructure const &,
+                                    NaturalTransformation const &,
+                                    CompositionTemplates const &, std::size_t,
+                                    bool parallel = false);
+
+CompositionResult compose_cospans(LeftComposition const &,
+                                  CospanStructure const &,
+                                  CospanStructure const &,
+                                  NaturalTransformation const &,
+                                  NaturalTransformation const &,
+                                  CompositionTemplates const &,
+                                  bool parallel = false);
+
+CompositionResult compose_cospans(CospanStructure const &,
+                                  CospanStructure const &,
+                                  NaturalTransformation const &,
+                                  NaturalTransformation const &,
+                                  CompositionTemplates const &, std::size_t,
+                                  bool parallel = false);
+
+// Composes without the parallel paths and reports the first domain of the
+// composite whose substitution or zip does not match its type.
+Checked<CompositionResult> try_compose_cospans(CospanStructure const &,
+                                               CospanStructure const &,
+                                               NaturalTransformation const &,
+                                               NaturalTransformation const &,
+                                               CompositionTemplates const &,
+                                               std::size_t);
+
 CompositionResult compose_cospans(CospanStructure const &,
                                   CospanStructure const &,
                                   NaturalTransformation const &,
                                   NaturalTransformation const &,
                                   Types::Unification const &, std::size_t);
+
+std::vector<Checked<CompositionResult>>
+compose_cospans(CospanPairs const &, NaturalTransformation const &,
+                NaturalTransformation const &, Types::Unification const &,
+                std::size_t, bool parallel = true);
+
 } // namespace Naturality
 } // namespace Project
 
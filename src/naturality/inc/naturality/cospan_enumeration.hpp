@@ -0,0 +1,41 @@
+#ifndef __COSPAN_ENUMERATION_HPP_
+#define __COSPAN_ENUMERATION_HPP_
+
+#include "naturality/cospan.hpp"
+#include "naturality/natural_transformation.hpp"
+
+#include <functional>
+#include <optional>
+
+namespace Project {
+namespace Naturality {
+
+class CospanEnumerator {
+public:
+  CospanEnumerator(NaturalTransformation const &, std::size_t);
+  CospanEnumerator(NaturalTransformation const &, std::size_t,
+                   std::vector<std::size_t> const &);
+
+  std::optional<CospanStructure> next();
+
+private:
+  NaturalTransformation m_transformation;
+  CospanStructure m_cospan;
+  std::vector<std::size_t> m_identifiers;
+  std::vector<std::size_t> m_values;
+  std::size_t m_fixed;
+  std::size_t m_maximum_values;
+  bool m_started;
+  bool m_finished;
+};
+
+using CospanPredicate = std::function<bool(CospanStructure const &)>;
+
+std::vector<CospanStructure>
+enumerate_cospans(NaturalTransformation const &, std::size_t,
+                  CospanPredicate const &, bool parallel = true);
+
+} // namespace Naturality
+} // namespace Project
+
+#endif
@@ -14,6 +14,10 @@ std::size_t const *get_identifier(CospanMorphism const &);
 
 CospanMorphism::PairType const *get_pair(CospanMorphism const &);
 
+std::size_t hash_value(CospanMorphism const &);
+
+std::size_t hash_value(CospanStructure const &);
+
 bool is_equal(CospanMorphism const &, CospanMorphism const &);
 
 bool is_equal(CospanMorphism::Type const &, CospanMorphism const &);
@@ -6,9 +6,27 @@
 namespace Project {
 namespace Naturality {
 
+struct MorphismBounds {
+  std::pair<std::size_t, std::size_t> left;
+  std::pair<std::size_t, std::size_t> right;
+};
+
+MorphismBounds create_empty_bounds();
+
+MorphismBounds morphism_bounds(CospanMorphism const &);
+
+std::vector<MorphismBounds>
+morphism_bounds(std::vector<CospanMorphism> const &);
+
+std::vector<std::pair<std::size_t, std::size_t>>
+shared_count(std::vector<MorphismBounds> const &);
+
 std::vector<std::pair<std::size_t, std::size_t>>
 shared_count(std::vector<CospanMorphism> const &);
 
+void update_shared_count(std::vector<std::pair<std::size_t, std::size_t>> &,
+                         std::vector<MorphismBounds> const &, std::size_t);
+
 } // namespace Naturality
 } // namespace Project
 
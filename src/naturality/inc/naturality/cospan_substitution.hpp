@@ -5,30 +5,98 @@
 #include "naturality/natural_transformation.hpp"
 #include "polymorphic_types/unification.hpp"
 
+#include <cstdint>
+
 namespace Project {
 namespace Naturality {
 
+class SubstitutionTable {
+public:
+  CospanMorphism::Type const *find(std::size_t) const;
+  CospanMorphism::Type const &insert(std::size_t, CospanMorphism::Type &&);
+  std::size_t size() const;
+  std::size_t memory_footprint() const;
+
+private:
+  std::size_t find_slot(std::size_t) const;
+  void grow();
+
+  std::vector<std::uint32_t> m_slots;
+  std::vector<std::size_t> m_keys;
+  std::vector<CospanMorphism::Type> m_values;
+};
+
 struct CospanSubstitutions {
-  std::vector<std::optional<CospanMorphism::Type>> values;
-  std::vector<std::size_t> maximum;
+  SubstitutionTable values;
+  std::vector<std::pair<std::size_t, std::size_t>> maximum;
+};
+
+struct VariableSubstitution {
+  std::vector<CospanSubstitutions> variables;
+  std::vector<std::size_t> counts;
+};
+
+struct SubstitutionTemplate {
+  CospanMorphism::Type type;
+  std::vector<std::optional<std::size_t>> identifiers;
+};
+
+using SubstitutionTemplates = std::vector<std::optional<SubstitutionTemplate>>;
+
+SubstitutionTemplates create_substitution_templates(
+    std::vector<std::optional<Types::TypeConstructor::Type>> const &);
+
+CospanMorphism::Type substitute_cospan_value(VariableSubstitution &,
+                                             SubstitutionTemplates const &,
+                                             std::size_t, std::size_t);
+
+// On a mismatch the substitution is left partly filled in and the
+// mismatch refers to domain 0; callers substituting several domains set it.
+Checked<CospanMorphism> try_cospan_substitution(VariableSubstitution &,
+                                                SubstitutionTemplates const &,
+                                                CospanMorphism const &,
+                                                Types::TypeConstructor const &);
+
+CospanMorphism cospan_substitution(VariableSubstitution &,
+                                   SubstitutionTemplates const &,
+                                   CospanMorphism const &,
+                                   Types::TypeConstructor const &);
+
+struct SubstitutionPartition {
+  std::size_t index;
+  std::size_t count;
 };
 
-using VariableSubstitution = std::vector<CospanSubstitutions>;
+using SubstitutedValues = std::vector<std::vector<CospanMorphism::Type>>;
+
+void partitioned_cospan_substitution(VariableSubstitution &,
+                                     SubstitutionTemplates const &,
+                                     SubstitutionPartition,
+                                     CospanMorphism const &,
+                                     Types::TypeConstructor const &,
+                                     SubstitutedValues &);
+
+CospanMorphism merge_cospan_substitution(SubstitutedValues const &,
+                                         std::vector<std::size_t> &,
+                                         CospanMorphism const &,
+                                         Types::TypeConstructor const &);
 
 CospanMorphism cospan_substitution(
     VariableSubstitution &,
     std::vector<std::optional<Types::TypeConstructor::Type>> const &,
     CospanMorphism const &, Types::TypeConstructor const &);
 
-VariableSubstitution create_empty_substitution(CospanStructure const &,
-                                               NaturalTransformation const &,
+VariableSubstitution create_empty_substitution(NaturalTransformation const &,
                                                std::size_t);
 
 VariableSubstitution
-create_empty_substitution(CospanStructure const &,
-                          NaturalTransformation const &,
+create_empty_substitution(NaturalTransformation const &,
                           std::vector<std::size_t> const &);
 
+std::vector<std::size_t> maximum_counts(VariableSubstitution const &);
+
+std::size_t memory_footprint(VariableSubstitution const &);
+
 } // namespace Naturality
 } // namespace Project
 
@@ -6,6 +6,13 @@
 namespace Project {
 namespace Naturality {
 
+Checked<CospanMorphism::Type>
+try_zip_cospan_types(CospanMorphism::Type const &,
+                     CospanMorphism::Type const &);
+
+Checked<CospanMorphism> try_zip_cospan_morphisms(CospanMorphism const &,
+                                                 CospanMorphism const &);
+
 CospanMorphism::Type zip_cospan_types(CospanMorphism::Type const &,
                                       CospanMorphism::Type const &);
 
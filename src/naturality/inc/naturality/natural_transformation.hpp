@@ -3,6 +3,9 @@
 
 #include "polymorphic_types/type_constructor.hpp"
 
+#include <string>
+#include <vector>
+
 namespace Project {
 namespace Naturality {
 
@@ -0,0 +1,46 @@
+#ifndef __PARALLEL_FOR_HPP_
+#define __PARALLEL_FOR_HPP_
+
+#include <algorithm>
+#include <future>
+#include <thread>
+#include <vector>
+
+namespace Project {
+namespace Naturality {
+
+inline bool &is_parallel_worker() {
+  thread_local bool worker = false;
+  return worker;
+}
+
+// Calls made from inside a worker run sequentially, so nested loops never
+// start more threads than the hardware has.
+template <typename Function>
+void parallel_for(std::size_t size, Function const &function) {
+  auto const hardware = std::max(1u, std::thread::hardware_concurrency());
+  auto const workers = std::min<std::size_t>(size, hardware);
+
+  if (workers <= 1 || is_parallel_worker()) {
+    for (auto i = 0u; i < size; ++i)
+      function(i);
+    return;
+  }
+
+  std::vector<std::future<void>> tasks;
+  tasks.reserve(workers);
+  for (auto worker = 0u; worker < workers; ++worker)
+    tasks.emplace_back(std::async(std::launch::async, [&, worker]() {
+      is_parallel_worker() = true;
+      for (auto i = worker; i < size; i += workers)
+        function(i);
+    }));
+
+  for (auto &&task : tasks)
+    task.get();
+}
+
+} // namespace Naturality
+} // namespace Project
+
+#endif
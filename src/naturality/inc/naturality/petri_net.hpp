@@ -0,0 +1,61 @@
+#ifndef __PETRI_NET_HPP_
+#define __PETRI_NET_HPP_
+
+#include "naturality/cospan.hpp"
+#include "polymorphic_types/type_constructor.hpp"
+
+#include <cstddef>
+#include <vector>
+
+namespace Project {
+namespace Naturality {
+
+struct PetriNetNodes {
+  std::vector<std::size_t> identifiers;
+  std::vector<std::size_t> types;
+  std::vector<Types::Variance> variances;
+  std::vector<std::size_t> counts;
+  std::vector<std::size_t> offsets;
+};
+
+struct PetriNetEdges {
+  std::vector<std::size_t> sources;
+  std::vector<std::size_t> targets;
+  std::vector<double> distances;
+};
+
+struct PetriNet {
+  PetriNetNodes nodes;
+  std::vector<std::size_t> transition_offsets;
+  PetriNetEdges incoming_edges;
+  PetriNetEdges outgoing_edges;
+  PetriNetEdges invisible_edges;
+};
+
+Checked<PetriNet>
+try_create_petri_net(std::vector<Types::TypeConstructor> const &,
+                     CospanStructure const &, std::size_t, std::size_t,
+                     bool parallel = false);
+
+Checked<std::vector<PetriNet>>
+try_create_petri_nets(std::vector<Types::TypeConstructor> const &,
+                      CospanStructure const &, std::vector<std::size_t> const &,
+                      bool parallel = false);
+
+PetriNet create_petri_net(std::vector<Types::TypeConstructor> const &,
+                          CospanStructure const &, std::size_t, std::size_t,
+                          bool parallel = false);
+
+std::vector<PetriNet>
+create_petri_nets(std::vector<Types::TypeConstructor> const &,
+                  CospanStructure const &, std::vector<std::size_t> const &,
+                  bool parallel = false);
+
+void add_edge(PetriNetEdges &, std::size_t, std::size_t, double);
+
+std::size_t number_of_vertices(PetriNet const &);
+
+} // namespace Naturality
+} // namespace Project
+
+#endif
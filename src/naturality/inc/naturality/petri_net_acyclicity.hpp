@@ -0,0 +1,67 @@
+#ifndef __PETRI_NET_ACYCLICITY_HPP_
+#define __PETRI_NET_ACYCLICITY_HPP_
+
+#include "naturality/petri_net.hpp"
+
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+namespace Project {
+namespace Naturality {
+
+constexpr std::size_t transition_type = std::numeric_limits<std::size_t>::max();
+
+struct PetriNetVertex {
+  std::size_t link;
+  std::size_t type;
+  std::size_t identifier;
+};
+
+struct AcyclicityResult {
+  bool acyclic;
+  std::vector<PetriNetVertex> cycle;
+};
+
+class AcyclicityChecker {
+public:
+  AcyclicityChecker();
+
+  AcyclicityResult const &extend(std::vector<PetriNet> const &);
+  AcyclicityResult const &result() const;
+  std::size_t length() const;
+
+private:
+  using Edges = std::vector<std::pair<std::size_t, std::size_t>>;
+
+  std::vector<std::size_t> add_net(PetriNet const &, std::size_t,
+                                   std::vector<std::size_t> &, Edges &);
+  void glue_places(PetriNetNodes const &, std::size_t,
+                   std::vector<std::size_t> &) const;
+  bool is_matching(std::vector<PetriNet> const &) const;
+  std::size_t add_vertex(PetriNetVertex const &);
+  void connect(std::size_t, std::size_t);
+  void order_link(std::size_t, Edges const &);
+  void sort_link(std::size_t);
+  void insert_edge(std::size_t, std::size_t);
+  void reorder(std::size_t, std::size_t);
+  void set_cycle(std::vector<std::size_t> const &);
+
+  std::vector<PetriNetVertex> m_vertices;
+  std::vector<std::vector<std::size_t>> m_successors;
+  std::vector<std::vector<std::size_t>> m_predecessors;
+  std::vector<std::size_t> m_positions;
+  std::size_t m_sorted;
+  std::vector<std::size_t> m_marks;
+  std::size_t m_mark;
+  std::vector<std::vector<std::size_t>> m_boundaries;
+  std::size_t m_length;
+  AcyclicityResult m_result;
+};
+
+AcyclicityResult check_acyclicity(std::vector<PetriNet> const &);
+
+} // namespace Naturality
+} // namespace Project
+
+#endif
@@ -0,0 +1,26 @@
+#ifndef __PETRI_NET_CHUNKS_HPP_
+#define __PETRI_NET_CHUNKS_HPP_
+
+#include "naturality/petri_net.hpp"
+
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+namespace Project {
+namespace Naturality {
+
+constexpr std::size_t transition_chunk_group =
+    std::numeric_limits<std::size_t>::max();
+
+struct PetriNetChunk {
+  std::size_t group;
+  PetriNet net;
+};
+
+std::vector<PetriNetChunk> split_petri_net(PetriNet const &, std::size_t);
+
+} // namespace Naturality
+} // namespace Project
+
+#endif
@@ -0,0 +1,37 @@
+#ifndef __PETRI_NET_DIFF_HPP_
+#define __PETRI_NET_DIFF_HPP_
+
+#include "naturality/petri_net.hpp"
+
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+namespace Project {
+namespace Naturality {
+
+constexpr std::size_t no_previous_vertex =
+    std::numeric_limits<std::size_t>::max();
+
+struct PetriNetEdgeDiff {
+  PetriNetEdges added;
+  PetriNetEdges removed;
+  PetriNetEdges changed;
+};
+
+struct PetriNetDiff {
+  std::vector<std::size_t> previous;
+  std::vector<std::size_t> added_vertices;
+  std::vector<std::size_t> removed_vertices;
+  std::vector<std::size_t> changed_vertices;
+  PetriNetEdgeDiff incoming_edges;
+  PetriNetEdgeDiff outgoing_edges;
+  PetriNetEdgeDiff invisible_edges;
+};
+
+PetriNetDiff diff_petri_nets(PetriNet const &, PetriNet const &);
+
+} // namespace Naturality
+} // namespace Project
+
+#endif
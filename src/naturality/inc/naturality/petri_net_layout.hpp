@@ -0,0 +1,29 @@
+#ifndef __PETRI_NET_LAYOUT_HPP_
+#define __PETRI_NET_LAYOUT_HPP_
+
+#include "naturality/petri_net.hpp"
+
+#include <cstddef>
+#include <vector>
+
+namespace Project {
+namespace Naturality {
+
+struct PetriNetLayoutOptions {
+  std::size_t iterations = 300;
+  double link_distance = 30.0;
+  double repulsion = 300.0;
+  double theta = 0.9;
+  double velocity_decay = 0.4;
+  double layer_spacing = 90.0;
+  double layer_strength = 0.1;
+  bool parallel = true;
+};
+
+std::vector<double> layout_petri_net(PetriNet const &,
+                                     PetriNetLayoutOptions const & = {});
+
+} // namespace Naturality
+} // namespace Project
+
+#endif
@@ -0,0 +1,26 @@
+#ifndef __PETRI_NET_SUMMARY_HPP_
+#define __PETRI_NET_SUMMARY_HPP_
+
+#include "naturality/petri_net.hpp"
+
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+namespace Project {
+namespace Naturality {
+
+struct PetriNetSummary {
+  PetriNet net;
+  std::vector<std::size_t> multiplicities;
+};
+
+PetriNetSummary
+summarise_petri_net(PetriNet const &, std::vector<std::size_t> const &,
+                    std::vector<std::size_t> const &,
+                    std::size_t = std::numeric_limits<std::size_t>::max());
+
+} // namespace Naturality
+} // namespace Project
+
+#endif
@@ -4,13 +4,46 @@
 #include "naturality/cospan.hpp"
 #include "naturality/natural_transformation.hpp"
 
+#include <optional>
+#include <string>
+#include <variant>
+
 namespace Project {
 namespace Naturality {
 
+using CospanUnification = Checked<std::vector<std::size_t>>;
+
+std::optional<CospanMismatch>
+validate_cospan(NaturalTransformation const &transformation,
+                CospanStructure const &cospan);
+
+CospanUnification
+try_unify_cospan_with_type(NaturalTransformation const &transformation,
+                           CospanStructure &cospan);
+
 std::vector<std::size_t>
 unify_cospan_with_type(NaturalTransformation const &transformation,
                        CospanStructure &cospan);
 
+std::vector<std::size_t>
+canonicalize_cospan(NaturalTransformation const &transformation,
+                    CospanStructure &cospan);
+
+std::size_t canonical_hash(NaturalTransformation const &transformation,
+                           CospanStructure const &cospan);
+
+std::vector<std::size_t>
+cospan_value_identifiers(NaturalTransformation const &transformation,
+                         CospanStructure &cospan);
+
+void assign_cospan_values(NaturalTransformation const &transformation,
+                          CospanStructure &cospan,
+                          std::vector<std::size_t> const &values);
+
+std::vector<std::size_t>
+compact_cospan_values(NaturalTransformation const &transformation,
+                      CospanStructure &cospan);
+
 } // namespace Naturality
 } // namespace Project
 
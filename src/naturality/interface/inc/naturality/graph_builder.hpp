@@ -1,17 +1,38 @@
 #ifndef __GRAPH_BUILDER_HPP_
 #define __GRAPH_BUILDER_HPP_
 
-#include "naturality/cospan.hpp"
-#include "polymorphic_types/type_constructor.hpp"
+#include "naturality/petri_net.hpp"
+#include "naturality/petri_net_acyclicity.hpp"
+#include "naturality/petri_net_chunks.hpp"
+#include "naturality/petri_net_diff.hpp"
+#include "naturality/petri_net_summary.hpp"
 
 #include <napi.h>
 
 namespace Project {
 namespace Naturality {
 
-Napi::Value generate_graph(std::vector<Types::TypeConstructor> const &,
-                           CospanStructure const &, std::size_t, std::size_t,
-                           Napi::Env &);
+Napi::Value create_graph(PetriNet const &, Napi::Env &);
+
+Napi::Value create_flat_graph(PetriNet const &, Napi::Env &);
+
+Napi::Value create_graphs(std::vector<PetriNet> const &, Napi::Env &);
+
+Napi::Value create_flat_graphs(std::vector<PetriNet> const &, Napi::Env &);
+
+Napi::Value create_layout(std::vector<double> const &, Napi::Env &);
+
+Napi::Value create_graph_chunk(std::vector<PetriNetChunk> const &, std::size_t,
+                               Napi::Env &);
+
+Napi::Value create_graph_summary(PetriNetSummary const &, Napi::Env &);
+
+Napi::Value create_unsummarised_graph(Napi::Env &);
+
+Napi::Value create_graph_diff(PetriNet const &, PetriNetDiff const &,
+                              Napi::Env &);
+
+Napi::Value create_acyclicity(AcyclicityResult const &, Napi::Env &);
 }
 } // namespace Project
 
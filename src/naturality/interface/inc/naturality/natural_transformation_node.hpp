@@ -1,14 +1,65 @@
 #ifndef __NATURAL_TRANSFORMATION_NODE_HPP_
 #define __NATURAL_TRANSFORMATION_NODE_HPP_
 
+#include "naturality/composition_cache.hpp"
 #include "naturality/cospan.hpp"
+#include "naturality/cospan_composition.hpp"
 #include "naturality/natural_transformation.hpp"
+#include "naturality/petri_net.hpp"
+#include "naturality/petri_net_chunks.hpp"
+#include "type_parsers/unified_cospan_parser.hpp"
 
 #include <napi.h>
 
+#include <map>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
 namespace Project {
 namespace Naturality {
 
+class NodeNaturalTransformation;
+
+struct NodeRevision {
+  std::size_t transformation;
+  std::size_t cospan;
+};
+
+struct NodeComposition {
+  Napi::ObjectReference left_reference;
+  Napi::ObjectReference right_reference;
+  NodeNaturalTransformation *left;
+  NodeNaturalTransformation *right;
+  CompositionTemplates templates;
+  std::optional<LeftComposition> left_composition;
+  NodeRevision left_revision;
+  NodeRevision right_revision;
+};
+
+struct NodeArtifacts {
+  using Reference = Napi::Reference<Napi::Value>;
+
+  NodeRevision revision;
+  Reference string;
+  Reference cospan_string;
+  std::unordered_map<std::size_t, Reference> graphs;
+  std::unordered_map<std::size_t, Reference> flat_graphs;
+  std::unordered_map<std::size_t, Reference> layouts;
+  std::unordered_map<std::size_t, Reference> graph_diffs;
+  std::map<std::pair<std::size_t, std::size_t>, std::vector<PetriNetChunk>>
+      chunks;
+  std::optional<std::vector<PetriNet>> nets;
+  Reference all_graphs;
+  Reference all_flat_graphs;
+  Reference acyclicity;
+};
+
+using UpdateSchedule = std::vector<std::vector<NodeNaturalTransformation *>>;
+
+using UpdateLevels =
+    std::unordered_map<NodeNaturalTransformation const *, std::size_t>;
+
 class NodeNaturalTransformation
     : public Napi::ObjectWrap<NodeNaturalTransformation> {
 public:
@@ -16,20 +67,52 @@ public:
 
   static Napi::Function initialize(Napi::Env);
   static Napi::Object create(Napi::CallbackInfo const &);
+  static Napi::Value set_composition_cache_limit(Napi::CallbackInfo const &);
+  static Napi::Value composition_cache_statistics(Napi::CallbackInfo const &);
+  static Napi::Value set_composition_cache_path(Napi::CallbackInfo const &);
 
 private:
   Napi::Value graph(Napi::CallbackInfo const &);
+  Napi::Value flat_graph(Napi::CallbackInfo const &);
+  Napi::Value graphs(Napi::CallbackInfo const &);
+  Napi::Value flat_graphs(Napi::CallbackInfo const &);
+  Napi::Value acyclicity(Napi::CallbackInfo const &);
+  Napi::Value layout(Napi::CallbackInfo const &);
+  Napi::Value graph_diff(Napi::CallbackInfo const &);
+  Napi::Value graph_chunk(Napi::CallbackInfo const &);
+  Napi::Value summary_graph(Napi::CallbackInfo const &);
   Napi::Value string(Napi::CallbackInfo const &);
   Napi::Value cospan_string(Napi::CallbackInfo const &);
   Napi::Value set_cospan(Napi::CallbackInfo const &);
+  Napi::Value edit_cospan(Napi::CallbackInfo const &);
+  Napi::Value set_transformation(Napi::CallbackInfo const &);
   Napi::Value compose(Napi::CallbackInfo const &);
   Napi::Value variable(Napi::CallbackInfo const &);
+  Napi::Value recompose(Napi::CallbackInfo const &);
+
+  void update();
+  std::size_t schedule_update(UpdateSchedule &, UpdateLevels &);
+  void update_composite();
+  void compose_operands(bool, bool);
+  void compose_types();
+  void set_composite_cospan(CompositionResult &&);
+  Napi::Value set_parsed_cospan(Napi::CallbackInfo const &,
+                                Types::CospanParse &&);
+  NodeArtifacts &artifacts();
+  std::vector<PetriNet> const &petri_nets();
+  PetriNet const &petri_net(std::size_t);
 
   static Napi::FunctionReference g_constructor;
+  static CompositionCache g_composition_cache;
 
   NaturalTransformation m_transformation;
   CospanStructure m_type;
   std::vector<std::size_t> m_cospan_value_count;
+  NodeRevision m_revision;
+  NodeArtifacts m_artifacts;
+  std::unordered_map<std::size_t, PetriNet> m_previous_nets;
+  std::optional<NodeComposition> m_composition;
+  std::optional<Types::IncrementalCospanParser> m_cospan_parser;
 };
 
 } // namespace Naturality
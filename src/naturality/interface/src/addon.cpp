@@ -1,6 +1,8 @@
 #include "naturality/addon.hpp"
 #include "naturality/natural_transformation_node.hpp"
 
+#include <stdexcept>
+
 namespace {
 
 using namespace Project::Naturality;
@@ -1,513 +1,367 @@
 #include "naturality/graph_builder.hpp"
-#include "naturality/cospan_equality.hpp"
-#include "polymorphic_types/type_equality.hpp"
 
-#include <naturality/cospan_to_string.hpp>
+#include <algorithm>
+#include <cstdint>
 
 namespace {
 
 using namespace Project::Naturality;
-using namespace Project::Types;
-
-struct TypeNode {
-  std::size_t type;
-  bool is_domain;
-};
-
-struct GraphData {
-  std::vector<std::vector<Napi::Object>> nodes;
-  std::vector<std::vector<Napi::Object>> transitions;
-  std::vector<Napi::Object> incoming_edges;
-  std::vector<Napi::Object> outgoing_edges;
-  std::vector<Napi::Object> invisible_edges;
-  std::size_t transition_ids;
-  std::size_t node_count;
-};
 
 Napi::Value escape_value(Napi::EscapableHandleScope &scope, Napi::Value value) {
   return scope.Escape(napi_value(value));
 }
 
-bool is_edge_source(TypeNode const &type_node, Variance variance) {
-  return (type_node.is_domain && Variance::COVARIANCE == variance) ||
-         (!type_node.is_domain && Variance::CONTRAVARIANCE == variance);
-}
-
-Napi::Object create_type_node(std::size_t identifier, TypeNode const &node,
-                              Variance variance, Napi::Env &env) {
+Napi::Object create_type_node(PetriNetNodes const &nodes, std::size_t index,
+                              Napi::Env &env) {
   Napi::Object object = Napi::Object::New(env);
-  object.Set("id", identifier);
-  object.Set("type", node.type);
-  object.Set("variance", static_cast<std::size_t>(variance));
-  object.Set("count", is_edge_source(node, variance) ? 1 : 0);
+  object.Set("id", nodes.identifiers[index]);
+  object.Set("type", nodes.types[index]);
+  object.Set("variance", static_cast<std::size_t>(nodes.variances[index]));
+  object.Set("count", nodes.counts[index]);
   return std::move(object);
 }
 
-Napi::Object create_type_node(std::size_t identifier, std::size_t type,
-                              Variance variance, Napi::Env &env) {
+Napi::Object create_transition_node(std::size_t identifier, Napi::Env &env) {
   Napi::Object object = Napi::Object::New(env);
   object.Set("id", identifier);
-  object.Set("type", type);
-  object.Set("variance", static_cast<std::size_t>(variance));
-  object.Set("count", 0);
   return std::move(object);
 }
 
-Napi::Object create_transition_node(std::size_t identifier, Napi::Env &env) {
+Napi::Object create_cycle_vertex(PetriNetVertex const &vertex,
+                                Napi::Env &env) {
+  auto const type = transition_type == vertex.type
+                        ? -1.0
+                        : static_cast<double>(vertex.type);
+
   Napi::Object object = Napi::Object::New(env);
-  object.Set("id", identifier);
+  object.Set("link", vertex.link);
+  object.Set("type", type);
+  object.Set("id", vertex.identifier);
   return std::move(object);
 }
 
-Napi::Object create_edge(std::size_t source, std::size_t target,
-                         double distance, Napi::Env &env) {
+Napi::Object create_edge(PetriNetEdges const &edges, std::size_t index,
+                         Napi::Env &env) {
   Napi::Object object = Napi::Object::New(env);
-  object.Set("source", source);
-  object.Set("target", target);
-  object.Set("distance", distance);
+  object.Set("source", edges.sources[index]);
+  object.Set("target", edges.targets[index]);
+  object.Set("distance", edges.distances[index]);
   return std::move(object);
 }
 
-Variance invert_variance(Variance variance) {
-  switch (variance) {
-  case Variance::CONTRAVARIANCE:
-    return Variance::COVARIANCE;
-  case Variance::COVARIANCE:
-    return Variance::CONTRAVARIANCE;
-  default:
-    return variance;
-  }
-}
-
-Variance calculate_variance(Variance variance, Variance environment_variance) {
-  switch (environment_variance) {
-  case Variance::CONTRAVARIANCE:
-    return invert_variance(variance);
-  default:
-    return variance;
-  }
-}
-
-void create_edge(GraphData &graph, std::size_t node, TypeNode const &type_node,
-                 Variance variance, std::size_t transition, Napi::Env &env) {
-  if (is_edge_source(type_node, variance))
-    graph.incoming_edges.emplace_back(create_edge(node, transition, 2.0, env));
-  else
-    graph.outgoing_edges.emplace_back(create_edge(transition, node, 2.0, env));
-}
-
-void generate_graph_part(GraphData &, std::size_t, TypeNode const &, Variance,
-                         Napi::Env &, TypeConstructor const &,
-                         CospanMorphism const &);
-
-void generate_graph_part(GraphData &, std::size_t, TypeNode const &, Variance,
-                         Napi::Env &, FunctorTypeConstructor const &,
-                         CospanMorphism const &);
-
-void add_graph_node(GraphData &graph, std::size_t part,
-                    TypeNode const &type_node, Variance variance,
-                    Napi::Env &env) {
-  auto &nodes = graph.nodes[part];
-  nodes.emplace_back(
-      create_type_node(graph.node_count, type_node, variance, env));
-  ++graph.node_count;
-}
-
-void add_graph_node(GraphData &graph, std::size_t part, std::size_t type,
-                    Variance variance, Napi::Env &env) {
-  auto &nodes = graph.nodes[part];
-  nodes.emplace_back(create_type_node(graph.node_count, type, variance, env));
-  ++graph.node_count;
+template <typename F>
+Napi::Value create_napi_array(std::size_t from, std::size_t to,
+                              F const &create, Napi::Env &env) {
+  Napi::Array array = Napi::Array::New(env, to - from);
+  for (auto i = from; i < to; ++i)
+    array[i - from] = create(i);
+  return std::move(array);
 }
 
-void add_graph_edge(GraphData &graph, TypeNode const &type_node,
-                    Variance variance, Napi::Env &env, std::size_t transition) {
-  create_edge(graph, graph.node_count, type_node, variance, transition, env);
+template <typename F>
+Napi::Value create_napi_groups(std::vector<std::size_t> const &offsets,
+                               F const &create, Napi::Env &env) {
+  auto const groups = offsets.empty() ? 0 : offsets.size() - 1;
+  Napi::Array array = Napi::Array::New(env, groups);
+  for (auto i = 0u; i < groups; ++i)
+    array[i] = create_napi_array(offsets[i], offsets[i + 1], create, env);
+  return std::move(array);
 }
 
-void create_graph_part(GraphData &graph, std::size_t part,
-                       TypeNode const &type_node, Variance variance,
-                       Napi::Env &env, std::size_t type,
-                       std::size_t transition) {
-  if (type == type_node.type) {
-    add_graph_edge(graph, type_node, variance, env, transition);
-    add_graph_node(graph, part, type_node, variance, env);
-  }
+Napi::Value create_napi_array(PetriNetEdges const &edges, Napi::Env &env) {
+  return create_napi_array(
+      0, edges.sources.size(),
+      [&](std::size_t i) { return create_edge(edges, i, env); }, env);
 }
 
-void create_graph_part(GraphData &graph, std::size_t part,
-                       TypeNode const &type_node, Variance variance,
-                       Napi::Env &env, std::size_t type,
-                       CospanMorphism::PairType const &transitions) {
-  if (type == type_node.type) {
-    add_graph_edge(graph, {type, false}, variance, env, transitions.first);
-    add_graph_edge(graph, {type, true}, variance, env, transitions.second);
-    add_graph_node(graph, part, type_node.type, variance, env);
-  }
+Napi::Value create_edges_object(PetriNet const &net, Napi::Env &env) {
+  Napi::Object edges = Napi::Object::New(env);
+  edges.Set("incoming", create_napi_array(net.incoming_edges, env));
+  edges.Set("outgoing", create_napi_array(net.outgoing_edges, env));
+  edges.Set("invisible", create_napi_array(net.invisible_edges, env));
+  return std::move(edges);
 }
 
-template <typename T>
-void generate_graph_part_with(GraphData &, std::size_t, TypeNode const &,
-                              Variance, Napi::Env &,
-                              TypeConstructor::Type const &, T const &);
-
-template <typename T>
-void generate_graph_part_with(GraphData &, std::size_t, TypeNode const &,
-                              Variance, Napi::Env &, T const &,
-                              CospanMorphism::Type const &);
-
-struct GenerateGraphPart {
-
-  void operator()(GraphData &graph, std::size_t part, TypeNode const &type_node,
-                  Variance variance, Napi::Env &env, std::size_t type,
-                  std::size_t transition) const {
-    create_graph_part(graph, part, type_node, variance, env, type, transition);
+struct FlatGraphLayout {
+  std::size_t nodes;
+  std::size_t node_groups;
+  std::size_t transition_groups;
+  std::size_t edges;
+
+  std::size_t distances() const { return 0; }
+  std::size_t node_ids() const { return edges * sizeof(double); }
+  std::size_t node_types() const { return after(node_ids(), nodes); }
+  std::size_t node_variances() const { return after(node_types(), nodes); }
+  std::size_t node_counts() const { return after(node_variances(), nodes); }
+  std::size_t node_offsets() const { return after(node_counts(), nodes); }
+  std::size_t transition_offsets() const {
+    return after(node_offsets(), node_groups);
   }
-
-  void operator()(GraphData &graph, std::size_t part, TypeNode const &type_node,
-                  Variance variance, Napi::Env &env, std::size_t type,
-                  CospanMorphism::PairType const &transitions) const {
-    create_graph_part(graph, part, type_node, variance, env, type, transitions);
+  std::size_t edge_sources() const {
+    return after(transition_offsets(), transition_groups);
   }
+  std::size_t edge_targets() const { return after(edge_sources(), edges); }
+  std::size_t edge_offsets() const { return after(edge_targets(), edges); }
+  std::size_t size() const { return after(edge_offsets(), 4); }
 
-  void operator()(GraphData &graph, std::size_t part, TypeNode const &type_node,
-                  Variance variance, Napi::Env &env,
-                  TypeConstructor const &constructor,
-                  CospanMorphism const &morphism) const {
-    generate_graph_part(graph, part, type_node, variance, env, constructor,
-                        morphism);
+  static std::size_t after(std::size_t offset, std::size_t length) {
+    return offset + length * sizeof(std::uint32_t);
   }
+};
 
-  void operator()(GraphData &graph, std::size_t part, TypeNode const &type_node,
-                  Variance variance, Napi::Env &env,
-                  FunctorTypeConstructor const &functor,
-                  CospanMorphism const &morphism) const {
-    generate_graph_part(graph, part, type_node, variance, env, functor,
-                        morphism);
-  }
-
-  template <typename T>
-  void operator()(GraphData &graph, std::size_t part, TypeNode const &type_node,
-                  Variance variance, Napi::Env &env,
-                  FunctorTypeConstructor const &functor,
-                  T const &cospan_value) const {
-    if (functor.type.size() == 1)
-      generate_graph_part_with(graph, part, type_node, variance, env,
-                               functor.type[0].type, cospan_value);
-    else
-      throw std::runtime_error(
-          "cospan type does not match polymorphic type: functor found");
-  }
-
-  template <typename T>
-  void operator()(GraphData &graph, std::size_t part, TypeNode const &type_node,
-                  Variance variance, Napi::Env &env,
-                  TypeConstructor const &type, T const &cospan_value) const {
-    if (type.type.size() == 1)
-      generate_graph_part_with(graph, part, type_node, variance, env,
-                               type.type[0].type, cospan_value);
-    else
-      throw std::runtime_error(
-          "cospan type does not match polymorphic type: constructor found");
-  }
-
-  template <typename T>
-  void operator()(GraphData &graph, std::size_t part, TypeNode const &type_node,
-                  Variance variance, Napi::Env &env, T const &type,
-                  CospanMorphism const &morphism) const {
-    if (morphism.map.size() == 1)
-      generate_graph_part_with(graph, part, type_node, variance, env, type,
-                               morphism.map[0]);
-    else
-      throw std::runtime_error(
-          "cospan type does not match polymorphic type: morphism found");
-  }
-
-  template <typename T, typename U>
-  void operator()(GraphData &, std::size_t, TypeNode const &, Variance,
-                  Napi::Env &, T const &, U const &) const {
-    throw std::runtime_error(
-        "cospan type does not match polymorphic type: unknown");
-  }
-} _generate_graph_part;
-
-template <typename T>
-void generate_graph_part_with(GraphData &graph, std::size_t part,
-                              TypeNode const &type_node, Variance variance,
-                              Napi::Env &env, TypeConstructor::Type const &type,
-                              T const &cospan_value) {
-  std::visit(std::bind(_generate_graph_part, std::ref(graph), part,
-                       std::cref(type_node), variance, std::ref(env),
-                       std::placeholders::_1, std::cref(cospan_value)),
-             type);
+std::uint32_t *flat_array(Napi::ArrayBuffer &buffer, std::size_t offset) {
+  return reinterpret_cast<std::uint32_t *>(
+      static_cast<char *>(buffer.Data()) + offset);
 }
 
 template <typename T>
-void generate_graph_part_with(GraphData &graph, std::size_t part,
-                              TypeNode const &type_node, Variance variance,
-                              Napi::Env &env, T const &type,
-                              CospanMorphism::Type const &cospan_value) {
-  std::visit(std::bind(_generate_graph_part, std::ref(graph), part,
-                       std::cref(type_node), variance, std::ref(env),
-                       std::cref(type), std::placeholders::_1),
-             cospan_value);
+void fill_flat_array(Napi::ArrayBuffer &buffer, std::size_t offset,
+                     std::vector<T> const &values) {
+  auto output = flat_array(buffer, offset);
+  for (auto &&value : values)
+    *output++ = static_cast<std::uint32_t>(value);
+}
+
+std::size_t fill_flat_edges(Napi::ArrayBuffer &buffer,
+                            FlatGraphLayout const &layout,
+                            PetriNetEdges const &edges, std::size_t index) {
+  auto distances = reinterpret_cast<double *>(buffer.Data());
+  auto sources = flat_array(buffer, layout.edge_sources());
+  auto targets = flat_array(buffer, layout.edge_targets());
+
+  for (auto i = 0u; i < edges.sources.size(); ++i, ++index) {
+    distances[index] = edges.distances[i];
+    sources[index] = static_cast<std::uint32_t>(edges.sources[i]);
+    targets[index] = static_cast<std::uint32_t>(edges.targets[i]);
+  }
+  return index;
 }
 
-template <typename F>
-void generate_graph_part(F const &create_graph_part, Variance variance,
-                         TypeConstructor::AtomicType const &type,
-                         CospanMorphism::MappedType const &cospan_type) {
-  if (type.variance != cospan_type.variance)
-    throw std::runtime_error("cospan type does not match polymorphic type");
-
-  auto const create_part =
-      std::bind(create_graph_part, calculate_variance(type.variance, variance),
-                std::placeholders::_1, std::placeholders::_2);
-  std::visit(create_part, type.type, cospan_type.type);
+void fill_flat_edges(Napi::ArrayBuffer &buffer, FlatGraphLayout const &layout,
+                     PetriNet const &net) {
+  auto offsets = flat_array(buffer, layout.edge_offsets());
+  std::size_t index = 0;
+  offsets[0] = 0;
+  index = fill_flat_edges(buffer, layout, net.incoming_edges, index);
+  offsets[1] = static_cast<std::uint32_t>(index);
+  index = fill_flat_edges(buffer, layout, net.outgoing_edges, index);
+  offsets[2] = static_cast<std::uint32_t>(index);
+  index = fill_flat_edges(buffer, layout, net.invisible_edges, index);
+  offsets[3] = static_cast<std::uint32_t>(index);
 }
 
-void generate_graph_part(GraphData &graph, std::size_t part,
-                         TypeNode const &type_node, Variance variance,
-                         Napi::Env &env,
-                         TypeConstructor::ConstructorType const &types,
-                         CospanMorphism const &morphism) {
-  auto const create_graph_part =
-      std::bind(_generate_graph_part, std::ref(graph), part,
-                std::cref(type_node), std::placeholders::_1, std::ref(env),
-                std::placeholders::_2, std::placeholders::_3);
-
-  for (auto i = 0u; i < morphism.map.size(); ++i)
-    generate_graph_part(create_graph_part, variance, types[i], morphism.map[i]);
+Napi::Value create_flat_view(Napi::ArrayBuffer &buffer, std::size_t offset,
+                             std::size_t length, Napi::Env &env) {
+  return Napi::Uint32Array::New(env, length, buffer, offset);
 }
 
-void generate_graph_part(GraphData &graph, std::size_t part,
-                         TypeNode const &type_node, Variance variance,
-                         Napi::Env &env, FunctorTypeConstructor const &functor,
-                         CospanMorphism const &morphism) {
-  auto const &nested_morphism = get_nested(morphism);
-
-  if (nested_morphism.map.size() == functor.type.size())
-    generate_graph_part(graph, part, type_node, variance, env, functor.type,
-                        nested_morphism);
-  else if (nested_morphism.map.size() == 1)
-    generate_graph_part_with(graph, part, type_node, variance, env, functor,
-                             nested_morphism.map[0]);
-  else if (functor.type.size() == 1)
-    generate_graph_part_with(graph, part, type_node, variance, env,
-                             functor.type[0].type, nested_morphism);
-  else
-    throw std::runtime_error("cospan type does not match polymorphic type");
+std::uint32_t to_flat_vertex(std::size_t vertex) {
+  return no_previous_vertex == vertex ? UINT32_MAX
+                                      : static_cast<std::uint32_t>(vertex);
 }
 
-void generate_graph_part(GraphData &graph, std::size_t part,
-                         TypeNode const &type_node, Variance variance,
-                         Napi::Env &env, TypeConstructor const &constructor,
-                         CospanMorphism const &morphism) {
-  auto const &nested_constructor = get_nested(constructor);
-  auto const &nested_morphism = get_nested(morphism);
-
-  if (nested_morphism.map.size() == nested_constructor.type.size())
-    generate_graph_part(graph, part, type_node, variance, env,
-                        nested_constructor.type, nested_morphism);
-  else if (nested_morphism.map.size() == 1)
-    generate_graph_part_with(graph, part, type_node, variance, env,
-                             nested_constructor, nested_morphism.map[0]);
-  else if (nested_constructor.type.size() == 1)
-    generate_graph_part_with(graph, part, type_node, variance, env,
-                             nested_constructor.type[0].type, nested_morphism);
-  else
-    throw std::runtime_error("cospan type does not match polymorphic type");
+Napi::Value create_flat_vertices(std::vector<std::size_t> const &vertices,
+                                 Napi::Env &env) {
+  auto array = Napi::Uint32Array::New(env, vertices.size());
+  std::transform(vertices.begin(), vertices.end(), array.Data(),
+                 to_flat_vertex);
+  return std::move(array);
 }
 
-void add_invisible_edges(std::vector<Napi::Object> &edges, std::size_t from,
-                         std::size_t to, Napi::Env &env) {
-  if (0 == to || from == to)
-    return;
+Napi::Value create_flat_edges(PetriNetEdges const &edges, Napi::Env &env) {
+  auto distances = Napi::Float64Array::New(env, edges.distances.size());
+  std::copy(edges.distances.begin(), edges.distances.end(), distances.Data());
 
-  edges.reserve(edges.size() + (to - from));
-  for (auto i = from; i < to - 1; ++i)
-    edges.emplace_back(create_edge(i, i + 1, 0.5, env));
+  Napi::Object object = Napi::Object::New(env);
+  object.Set("source", create_flat_vertices(edges.sources, env));
+  object.Set("target", create_flat_vertices(edges.targets, env));
+  object.Set("distance", distances);
+  return std::move(object);
 }
 
-void add_invisible_edges(std::vector<Napi::Object> &edges,
-                         std::vector<Napi::Object> const &nodes,
-                         std::size_t &start, Napi::Env &env) {
-  for (auto i = 0u; i < nodes.size() - 1; ++i) {
-    edges.emplace_back(create_edge(start, start + 1, 1.0, env));
-    start += 1;
-  }
-  start += 1;
+Napi::Value create_edge_diff(PetriNetEdgeDiff const &diff, Napi::Env &env) {
+  Napi::Object object = Napi::Object::New(env);
+  object.Set("added", create_flat_edges(diff.added, env));
+  object.Set("removed", create_flat_edges(diff.removed, env));
+  object.Set("changed", create_flat_edges(diff.changed, env));
+  return std::move(object);
 }
 
-void add_invisible_edges(std::vector<Napi::Object> &edges,
-                         std::vector<std::vector<Napi::Object>> const &nodes,
-                         std::size_t start, Napi::Env &env) {
-  for (auto &&node_group : nodes) {
-    if (node_group.size() > 0)
-      add_invisible_edges(edges, node_group, start, env);
-  }
-}
+} // namespace
 
-std::vector<Napi::Object> generate_invisible_edges(
-    std::size_t transitions,
-    std::vector<std::pair<std::size_t, std::size_t>> const &shared_count,
-    Napi::Env &env) {
-  std::vector<Napi::Object> edges;
-  auto const edge_sets = shared_count.size() - 1;
-  std::size_t current = 0;
-
-  for (auto i = 0u; i < edge_sets; ++i) {
-    auto const shared = shared_count[i].second;
-    auto const maximum = shared + current;
-
-    if (transitions > maximum)
-      add_invisible_edges(edges, current, maximum, env);
-    else {
-      add_invisible_edges(edges, current, transitions, env);
-      return std::move(edges);
-    }
-
-    current = maximum;
-  }
-  return std::move(edges);
-}
+namespace Project {
+namespace Naturality {
 
-std::vector<Napi::Object> generate_invisible_edges(
-    std::vector<std::pair<std::size_t, std::size_t>> const &transitions,
-    Napi::Env &env) {
-  std::vector<Napi::Object> edges;
-  edges.reserve(transitions.back().second - transitions.size());
-  for (auto &&transition : transitions) {
-    for (auto i = transition.first; i < transition.second - 1; ++i)
-      edges.emplace_back(create_edge(i, i + 1, 0.5, env));
-  }
-  return std::move(edges);
-}
+Napi::Value create_graph(PetriNet const &net, Napi::Env &env) {
+  Napi::EscapableHandleScope scope(env);
+  auto const &nodes = net.nodes;
 
-std::vector<std::pair<std::size_t, std::size_t>> group_transitions(
-    std::size_t transitions,
-    std::vector<std::pair<std::size_t, std::size_t>> const &shared_count) {
-  std::vector<std::pair<std::size_t, std::size_t>> grouped;
-  grouped.reserve(shared_count.size() - 1);
-
-  std::size_t current_count = 0u;
-  for (auto i = 0u; i < shared_count.size() - 1; ++i) {
-    auto const &count = shared_count[i];
-    grouped.emplace_back(current_count, current_count + count.second);
-    current_count += count.second;
-  }
-  return std::move(grouped);
+  Napi::Object graph = Napi::Object::New(env);
+  graph.Set("nodes", create_napi_groups(
+                         nodes.offsets,
+                         [&](std::size_t i) {
+                           return create_type_node(nodes, i, env);
+                         },
+                         env));
+  graph.Set("transitions", create_napi_groups(
+                               net.transition_offsets,
+                               [&](std::size_t i) {
+                                 return create_transition_node(i, env);
+                               },
+                               env));
+  graph.Set("edges", create_edges_object(net, env));
+  return escape_value(scope, graph);
 }
 
-std::vector<Napi::Object> generate_transitions(std::size_t transitions,
-                                               Napi::Env &env) {
-  std::vector<Napi::Object> nodes;
-  nodes.reserve(transitions);
-  for (auto transition = 0u; transition < transitions; ++transition)
-    nodes.emplace_back(create_transition_node(transition, env));
-  return std::move(nodes);
-}
+Napi::Value create_flat_graph(PetriNet const &net, Napi::Env &env) {
+  Napi::EscapableHandleScope scope(env);
+  auto const &nodes = net.nodes;
+
+  FlatGraphLayout layout{
+      nodes.identifiers.size(), nodes.offsets.size(),
+      net.transition_offsets.size(),
+      net.incoming_edges.sources.size() + net.outgoing_edges.sources.size() +
+          net.invisible_edges.sources.size()};
+
+  auto buffer = Napi::ArrayBuffer::New(env, layout.size());
+  fill_flat_array(buffer, layout.node_ids(), nodes.identifiers);
+  fill_flat_array(buffer, layout.node_types(), nodes.types);
+  fill_flat_array(buffer, layout.node_variances(), nodes.variances);
+  fill_flat_array(buffer, layout.node_counts(), nodes.counts);
+  fill_flat_array(buffer, layout.node_offsets(), nodes.offsets);
+  fill_flat_array(buffer, layout.transition_offsets(),
+                  net.transition_offsets);
+  fill_flat_edges(buffer, layout, net);
+
+  Napi::Object flat_nodes = Napi::Object::New(env);
+  flat_nodes.Set("id", create_flat_view(buffer, layout.node_ids(),
+                                        layout.nodes, env));
+  flat_nodes.Set("type", create_flat_view(buffer, layout.node_types(),
+                                          layout.nodes, env));
+  flat_nodes.Set("variance", create_flat_view(buffer, layout.node_variances(),
+                                              layout.nodes, env));
+  flat_nodes.Set("count", create_flat_view(buffer, layout.node_counts(),
+                                           layout.nodes, env));
+  flat_nodes.Set("offsets", create_flat_view(buffer, layout.node_offsets(),
+                                             layout.node_groups, env));
 
-std::vector<Napi::Object>
-generate_transitions(std::pair<std::size_t, std::size_t> const &transitions,
-                     Napi::Env &env) {
-  std::vector<Napi::Object> nodes;
-  nodes.reserve(transitions.second - transitions.first);
-  for (auto i = transitions.first; i < transitions.second; ++i)
-    nodes.emplace_back(create_transition_node(i, env));
-  return std::move(nodes);
-}
+  Napi::Object edges = Napi::Object::New(env);
+  edges.Set("source", create_flat_view(buffer, layout.edge_sources(),
+                                       layout.edges, env));
+  edges.Set("target", create_flat_view(buffer, layout.edge_targets(),
+                                       layout.edges, env));
+  edges.Set("distance", Napi::Float64Array::New(env, layout.edges, buffer,
+                                                layout.distances()));
+  edges.Set("offsets",
+            create_flat_view(buffer, layout.edge_offsets(), 4, env));
 
-std::vector<std::vector<Napi::Object>> generate_transitions(
-    std::vector<std::pair<std::size_t, std::size_t>> const &transitions,
-    Napi::Env &env) {
-  std::vector<std::vector<Napi::Object>> nodes;
-  nodes.reserve(transitions.size());
-  for (auto &&transition_group : transitions)
-    nodes.emplace_back(generate_transitions(transition_group, env));
-  return std::move(nodes);
+  Napi::Object graph = Napi::Object::New(env);
+  graph.Set("buffer", buffer);
+  graph.Set("nodes", flat_nodes);
+  graph.Set("transitions",
+            create_flat_view(buffer, layout.transition_offsets(),
+                             layout.transition_groups, env));
+  graph.Set("edges", edges);
+  return escape_value(scope, graph);
 }
 
-Napi::Value create_napi_array(std::vector<Napi::Object> const &objects,
-                              Napi::Env &env) {
-  Napi::Array array = Napi::Array::New(env, objects.size());
-  for (auto i = 0u; i < objects.size(); ++i)
-    array[i] = objects[i];
-  return std::move(array);
+Napi::Value create_graphs(std::vector<PetriNet> const &nets, Napi::Env &env) {
+  Napi::EscapableHandleScope scope(env);
+  Napi::Array graphs = Napi::Array::New(env, nets.size());
+  for (auto i = 0u; i < nets.size(); ++i)
+    graphs[i] = create_graph(nets[i], env);
+  return escape_value(scope, graphs);
 }
 
-Napi::Value
-create_napi_array(std::vector<std::vector<Napi::Object>> const &objects,
-                  Napi::Env &env) {
-  Napi::Array array = Napi::Array::New(env, objects.size());
-  for (auto i = 0u; i < objects.size(); ++i)
-    array[i] = create_napi_array(objects[i], env);
-  return std::move(array);
+Napi::Value create_layout(std::vector<double> const &positions,
+                          Napi::Env &env) {
+  auto layout = Napi::Float64Array::New(env, positions.size());
+  std::copy(positions.begin(), positions.end(), layout.Data());
+  return std::move(layout);
 }
 
-Napi::Value
-create_edges_object(std::vector<Napi::Object> const &incoming_edges,
-                    std::vector<Napi::Object> const &outgoing_edges,
-                    std::vector<Napi::Object> const &invisible_edges,
-                    Napi::Env &env) {
-  Napi::Object edges = Napi::Object::New(env);
-  edges.Set("incoming", create_napi_array(incoming_edges, env));
-  edges.Set("outgoing", create_napi_array(outgoing_edges, env));
-  edges.Set("invisible", create_napi_array(invisible_edges, env));
-  return std::move(edges);
-}
+Napi::Value create_graph_chunk(std::vector<PetriNetChunk> const &chunks,
+                               std::size_t index, Napi::Env &env) {
+  if (index >= chunks.size())
+    return env.Undefined();
 
-Napi::Value create_graph(GraphData &data, Napi::Env &env,
-                         Napi::EscapableHandleScope &scope) {
-  Napi::Object graph = Napi::Object::New(env);
-  graph.Set("nodes", create_napi_array(data.nodes, env));
-  graph.Set("transitions", create_napi_array(data.transitions, env));
-  graph.Set("edges",
-            create_edges_object(data.incoming_edges, data.outgoing_edges,
-                                data.invisible_edges, env));
-  return escape_value(scope, graph);
+  Napi::EscapableHandleScope scope(env);
+  auto const &chunk = chunks[index];
+  auto const group = transition_chunk_group == chunk.group
+                         ? -1.0
+                         : static_cast<double>(chunk.group);
+
+  Napi::Object result = Napi::Object::New(env);
+  result.Set("index", index);
+  result.Set("count", chunks.size());
+  result.Set("group", group);
+  result.Set("graph", create_flat_graph(chunk.net, env));
+  return escape_value(scope, result);
 }
 
-void generate_graph_parts(GraphData &graph,
-                          std::vector<TypeConstructor> const &domains,
-                          CospanStructure const &cospan, std::size_t type,
-                          Napi::Env &env) {
-  if (domains.empty())
-    return;
+Napi::Value create_graph_summary(PetriNetSummary const &summary,
+                                 Napi::Env &env) {
+  Napi::EscapableHandleScope scope(env);
 
-  generate_graph_part(graph, 0, {type, true}, Variance::COVARIANCE, env,
-                      domains[0], cospan.domains[0]);
+  Napi::Object result = Napi::Object::New(env);
+  result.Set("summarised", true);
+  result.Set("graph", create_flat_graph(summary.net, env));
+  result.Set("multiplicity",
+             create_flat_vertices(summary.multiplicities, env));
+  return escape_value(scope, result);
+}
 
-  for (auto i = 1u; i < domains.size(); ++i)
-    generate_graph_part(graph, i, {type, false}, Variance::COVARIANCE, env,
-                        domains[i], cospan.domains[i]);
+Napi::Value create_unsummarised_graph(Napi::Env &env) {
+  Napi::EscapableHandleScope scope(env);
+
+  Napi::Object result = Napi::Object::New(env);
+  result.Set("summarised", false);
+  return escape_value(scope, result);
 }
 
-} // namespace
+Napi::Value create_graph_diff(PetriNet const &net, PetriNetDiff const &diff,
+                              Napi::Env &env) {
+  Napi::EscapableHandleScope scope(env);
 
-namespace Project {
-namespace Naturality {
+  Napi::Object edges = Napi::Object::New(env);
+  edges.Set("incoming", create_edge_diff(diff.incoming_edges, env));
+  edges.Set("outgoing", create_edge_diff(diff.outgoing_edges, env));
+  edges.Set("invisible", create_edge_diff(diff.invisible_edges, env));
 
-Napi::Value generate_graph(std::vector<TypeConstructor> const &domains,
-                           CospanStructure const &cospan,
-                           std::size_t transitions, std::size_t type,
-                           Napi::Env &env) {
-  GraphData graph;
-  graph.nodes = std::vector<std::vector<Napi::Object>>(
-      domains.size(), std::vector<Napi::Object>());
+  Napi::Object changes = Napi::Object::New(env);
+  changes.Set("previous", create_flat_vertices(diff.previous, env));
+  changes.Set("added", create_flat_vertices(diff.added_vertices, env));
+  changes.Set("removed", create_flat_vertices(diff.removed_vertices, env));
+  changes.Set("changed", create_flat_vertices(diff.changed_vertices, env));
+  changes.Set("edges", edges);
 
+  Napi::Object result = Napi::Object::New(env);
+  result.Set("graph", create_flat_graph(net, env));
+  result.Set("diff", changes);
+  return escape_value(scope, result);
+}
+
+Napi::Value create_flat_graphs(std::vector<PetriNet> const &nets,
+                               Napi::Env &env) {
   Napi::EscapableHandleScope scope(env);
-  graph.node_count = transitions;
+  Napi::Array graphs = Napi::Array::New(env, nets.size());
+  for (auto i = 0u; i < nets.size(); ++i)
+    graphs[i] = create_flat_graph(nets[i], env);
+  return escape_value(scope, graphs);
+}
 
-  auto const &grouped_transitions =
-      group_transitions(transitions, cospan.shared_counts);
-  graph.invisible_edges = generate_invisible_edges(grouped_transitions, env);
-  graph.transitions = generate_transitions(grouped_transitions, env);
+Napi::Value create_acyclicity(AcyclicityResult const &result,
+                              Napi::Env &env) {
+  Napi::EscapableHandleScope scope(env);
 
-  generate_graph_parts(graph, domains, cospan, type, env);
-  add_invisible_edges(graph.invisible_edges, graph.nodes, transitions, env);
+  Napi::Array cycle = Napi::Array::New(env, result.cycle.size());
+  for (auto i = 0u; i < result.cycle.size(); ++i)
+    cycle[i] = create_cycle_vertex(result.cycle[i], env);
 
-  return create_graph(graph, env, scope);
+  Napi::Object object = Napi::Object::New(env);
+  object.Set("acyclic", result.acyclic);
+  object.Set("cycle", cycle);
+  return escape_value(scope, object);
 }
 
 } // namespace Naturality
@@ -1,13 +1,20 @@
 #include "naturality/natural_transformation_node.hpp"
+#include "naturality/composition_store.hpp"
 #include "naturality/cospan_composition.hpp"
 #include "naturality/cospan_to_string.hpp"
 #include "naturality/graph_builder.hpp"
 #include "naturality/natural_composition.hpp"
+#include "naturality/parallel_for.hpp"
+#include "naturality/petri_net.hpp"
+#include "naturality/petri_net_acyclicity.hpp"
+#include "naturality/petri_net_diff.hpp"
+#include "naturality/petri_net_layout.hpp"
+#include "naturality/petri_net_summary.hpp"
 #include "naturality/unify_cospan_with_type.hpp"
 #include "polymorphic_types/type_to_string.hpp"
 #include "polymorphic_types/unification.hpp"
-#include "type_parsers/cospan_parser.hpp"
 #include "type_parsers/transformation_parser.hpp"
+#include "type_parsers/unified_cospan_parser.hpp"
 
 #include <algorithm>
 #include <functional>
@@ -19,6 +26,10 @@ namespace {
 using namespace Project::Naturality;
 using namespace Project::Types;
 
+constexpr std::size_t default_cache_limit = 64 * 1024 * 1024;
+constexpr std::size_t default_chunk_size = 512;
+constexpr std::size_t parallel_threshold = 256;
+
 Napi::Value throw_wrong_number_of_graph_arguments(Napi::Env &env,
                                                   std::size_t length) {
   Napi::TypeError::New(
@@ -41,12 +52,39 @@ std::string variance_to_string(Variance variance) {
   }
 }
 
+Napi::Value throw_invalid_arguments_to_graph_chunk(Napi::Env env) {
+  Napi::TypeError::New(env, "graphChunk expects a type, a chunk index and an "
+                            "optional chunk size")
+      .ThrowAsJavaScriptException();
+  return env.Null();
+}
+
+Napi::Value throw_invalid_arguments_to_summary_graph(Napi::Env env) {
+  Napi::TypeError::New(env, "summaryGraph expects a type, the expanded place "
+                            "and transition groups and a vertex limit")
+      .ThrowAsJavaScriptException();
+  return env.Null();
+}
+
 Napi::Value throw_invalid_cospan_structure(Napi::Env env) {
   Napi::TypeError::New(env, "invalid cospan specified")
       .ThrowAsJavaScriptException();
   return env.Null();
 }
 
+Napi::Value throw_invalid_cospan_structure(Napi::Env env,
+                                           CospanMismatch const &mismatch) {
+  Napi::TypeError::New(env, "invalid cospan specified: " + to_string(mismatch))
+      .ThrowAsJavaScriptException();
+  return env.Null();
+}
+
+Napi::Value throw_cospan_not_editable(Napi::Env env) {
+  Napi::TypeError::New(env, "cospan is not editable")
+      .ThrowAsJavaScriptException();
+  return env.Null();
+}
+
 Napi::Value throw_cospan_parse_error(Napi::Env &&env) {
   Napi::TypeError::New(env, "unable to parse cospan")
       .ThrowAsJavaScriptException();
@@ -60,6 +98,13 @@ Napi::Value throw_failed_to_generate_graph(std::string const &what,
   return env.Null();
 }
 
+Napi::Value throw_failed_to_check_acyclicity(std::string const &what,
+                                             Napi::Env &&env) {
+  Napi::TypeError::New(env, "failed to check acyclicity: " + what)
+      .ThrowAsJavaScriptException();
+  return env.Null();
+}
+
 Napi::Value throw_invalid_arguments_to_compose(Napi::Env env) {
   Napi::TypeError::New(env, "compose expects 1 argument, 0 received")
       .ThrowAsJavaScriptException();
@@ -73,6 +118,18 @@ Napi::Value throw_invalid_argument_type_to_compose(Napi::Env env) {
   return env.Null();
 }
 
+Napi::Value throw_invalid_cache_limit(Napi::Env env) {
+  Napi::TypeError::New(env, "setCompositionCacheLimit expects a byte count")
+      .ThrowAsJavaScriptException();
+  return env.Null();
+}
+
+Napi::Value throw_invalid_cache_path(Napi::Env env) {
+  Napi::TypeError::New(env, "setCompositionCachePath expects a file path")
+      .ThrowAsJavaScriptException();
+  return env.Null();
+}
+
 Napi::Value throw_failed_to_compose_types(Napi::Env env) {
   Napi::TypeError::New(env, "failed to compose types")
       .ThrowAsJavaScriptException();
@@ -85,6 +142,24 @@ Napi::Value throw_failed_to_compose_cospans(Napi::Env env) {
   return env.Null();
 }
 
+Napi::Value throw_transformation_parse_error(Napi::Env env) {
+  Napi::TypeError::New(env, "unable to parse transformation")
+      .ThrowAsJavaScriptException();
+  return env.Null();
+}
+
+Napi::Value throw_failed_to_update(std::string const &what, Napi::Env env) {
+  Napi::TypeError::New(env, "failed to update composite: " + what)
+      .ThrowAsJavaScriptException();
+  return env.Null();
+}
+
+Napi::Value throw_not_a_composite(Napi::Env env) {
+  Napi::TypeError::New(env, "recompose expects a composite transformation")
+      .ThrowAsJavaScriptException();
+  return env.Null();
+}
+
 Napi::Value throw_no_arguments_to_variable(Napi::Env env) {
   Napi::TypeError::New(env, "variable expects 1 argument, 0 received")
       .ThrowAsJavaScriptException();
@@ -97,6 +172,17 @@ Napi::Value throw_invalid_argument_to_variable(Napi::Env env) {
   return env.Null();
 }
 
+bool is_large(CospanStructure const &cospan) {
+  return cospan.total_number_of_identifiers >= parallel_threshold;
+}
+
+std::vector<std::size_t> get_groups(Napi::Array const &array) {
+  std::vector<std::size_t> groups;
+  for (auto i = 0u; i < array.Length(); ++i)
+    groups.emplace_back(array[i].ToNumber().Uint32Value());
+  return std::move(groups);
+}
+
 NaturalTransformation create_transformation(Napi::Value const &transform) {
   if (transform.IsString())
     return parse_transformation(transform.ToString().Utf8Value());
@@ -119,24 +205,29 @@ NaturalTransformation create_transformation(Napi::CallbackInfo const &info) {
   return create_transformation(info[0], info[1]);
 }
 
-CospanStructure create_cospan(Napi::Value const &domain,
-                              Napi::Value const &codomain) {
+CospanParse create_cospan(Napi::Value const &domain,
+                          Napi::Value const &codomain,
+                          NaturalTransformation const &transformation) {
   if (domain.IsString() && codomain.IsString())
-    return parse_cospan(domain.ToString().Utf8Value(),
-                        codomain.ToString().Utf8Value());
-  throw std::runtime_error("invalid arguments");
+    return parse_unified_cospan(domain.ToString().Utf8Value(),
+                                codomain.ToString().Utf8Value(),
+                                transformation);
+  return CospanSyntaxError{0};
 }
 
-CospanStructure create_cospan(Napi::Value const &cospan) {
+CospanParse create_cospan(Napi::Value const &cospan,
+                          NaturalTransformation const &transformation) {
   if (cospan.IsString())
-    return parse_cospan(cospan.ToString().Utf8Value());
-  throw std::runtime_error("invalid arguments");
+    return parse_unified_cospan(cospan.ToString().Utf8Value(),
+                                transformation);
+  return CospanSyntaxError{0};
 }
 
-CospanStructure create_cospan(Napi::CallbackInfo const &info) {
+CospanParse create_cospan(Napi::CallbackInfo const &info,
+                          NaturalTransformation const &transformation) {
   if (info.Length() == 1)
-    return create_cospan(info[0]);
-  return create_cospan(info[0], info[1]);
+    return create_cospan(info[0], transformation);
+  return create_cospan(info[0], info[1], transformation);
 }
 
 std::size_t get_type(std::string const &symbol,
@@ -182,12 +273,40 @@ calculate_unification(NaturalTransformation const &left,
                                right.functor_symbols.size());
 }
 
+bool is_type_changed(NodeRevision const &composed,
+                     NodeRevision const &current) {
+  return composed.transformation != current.transformation;
+}
+
+bool is_cospan_changed(NodeRevision const &composed,
+                       NodeRevision const &current) {
+  return is_type_changed(composed, current) ||
+         composed.cospan != current.cospan;
+}
+
+template <typename F>
+Napi::Value cached_value(NodeArtifacts::Reference &reference,
+                         F const &create) {
+  if (reference.IsEmpty())
+    reference = Napi::Persistent(Napi::Value(create()));
+  return reference.Value();
+}
+
+template <typename F>
+void for_each_in_parallel(std::vector<NodeNaturalTransformation *> const &nodes,
+                          F const &function) {
+  parallel_for(nodes.size(),
+               [&](std::size_t index) { function(nodes[index]); });
+}
+
 } // namespace
 
 namespace Project {
 namespace Naturality {
 
 Napi::FunctionReference NodeNaturalTransformation::g_constructor;
+CompositionCache
+    NodeNaturalTransformation::g_composition_cache(default_cache_limit);
 
 NodeNaturalTransformation::NodeNaturalTransformation(
     Napi::CallbackInfo const &info)
@@ -195,7 +314,8 @@ NodeNaturalTransformation::NodeNaturalTransformation(
       m_transformation(create_transformation(info)),
       m_type(create_default_cospan(m_transformation.domains[0],
                                    m_transformation.domains[1])),
-      m_cospan_value_count(m_transformation.symbols.size(), 1) {}
+      m_cospan_value_count(m_transformation.symbols.size(), 1),
+      m_revision{0, 0}, m_artifacts{m_revision} {}
 
 Napi::Function NodeNaturalTransformation::initialize(Napi::Env env) {
   Napi::HandleScope scope(env);
@@ -203,12 +323,31 @@ Napi::Function NodeNaturalTransformation::initialize(Napi::Env env) {
   Napi::Function func = DefineClass(
       env, "NaturalTransformation",
       {InstanceMethod("graph", &NodeNaturalTransformation::graph),
+       InstanceMethod("flatGraph", &NodeNaturalTransformation::flat_graph),
+       InstanceMethod("graphs", &NodeNaturalTransformation::graphs),
+       InstanceMethod("flatGraphs", &NodeNaturalTransformation::flat_graphs),
+       InstanceMethod("acyclicity", &NodeNaturalTransformation::acyclicity),
+       InstanceMethod("layout", &NodeNaturalTransformation::layout),
+       InstanceMethod("graphDiff", &NodeNaturalTransformation::graph_diff),
+       InstanceMethod("graphChunk", &NodeNaturalTransformation::graph_chunk),
+       InstanceMethod("summaryGraph",
+                      &NodeNaturalTransformation::summary_graph),
        InstanceMethod("string", &NodeNaturalTransformation::string),
        InstanceMethod("cospanString",
                       &NodeNaturalTransformation::cospan_string),
        InstanceMethod("setCospan", &NodeNaturalTransformation::set_cospan),
+       InstanceMethod("editCospan", &NodeNaturalTransformation::edit_cospan),
+       InstanceMethod("setTransformation",
+                      &NodeNaturalTransformation::set_transformation),
        InstanceMethod("compose", &NodeNaturalTransformation::compose),
-       InstanceMethod("variable", &NodeNaturalTransformation::variable)});
+       InstanceMethod("variable", &NodeNaturalTransformation::variable),
+       InstanceMethod("recompose", &NodeNaturalTransformation::recompose),
+       StaticMethod("setCompositionCacheLimit",
+                    &NodeNaturalTransformation::set_composition_cache_limit),
+       StaticMethod("compositionCacheStatistics",
+                    &NodeNaturalTransformation::composition_cache_statistics),
+       StaticMethod("setCompositionCachePath",
+                    &NodeNaturalTransformation::set_composition_cache_path)});
 
   g_constructor = Napi::Persistent(func);
   g_constructor.SuppressDestruct();
@@ -223,6 +362,46 @@ Napi::Object NodeNaturalTransformation::create(Napi::CallbackInfo const &info) {
   return g_constructor.New({info[0], info[1]});
 }
 
+Napi::Value NodeNaturalTransformation::set_composition_cache_limit(
+    Napi::CallbackInfo const &info) {
+  Napi::Env env = info.Env();
+
+  if (info.Length() == 0 || !info[0].IsNumber())
+    return throw_invalid_cache_limit(env);
+
+  g_composition_cache.set_memory_limit(
+      static_cast<std::size_t>(info[0].ToNumber().Int64Value()));
+  return env.Undefined();
+}
+
+Napi::Value NodeNaturalTransformation::composition_cache_statistics(
+    Napi::CallbackInfo const &info) {
+  Napi::Env env = info.Env();
+  auto const statistics = g_composition_cache.statistics();
+
+  auto result = Napi::Object::New(env);
+  result.Set("hits", Napi::Number::New(env, statistics.hits));
+  result.Set("misses", Napi::Number::New(env, statistics.misses));
+  result.Set("evictions", Napi::Number::New(env, statistics.evictions));
+  result.Set("storeHits", Napi::Number::New(env, statistics.store_hits));
+  result.Set("entries", Napi::Number::New(env, statistics.entries));
+  result.Set("memoryFootprint",
+             Napi::Number::New(env, statistics.memory_footprint));
+  return result;
+}
+
+Napi::Value NodeNaturalTransformation::set_composition_cache_path(
+    Napi::CallbackInfo const &info) {
+  Napi::Env env = info.Env();
+
+  if (info.Length() == 0 || !info[0].IsString())
+    return throw_invalid_cache_path(env);
+
+  g_composition_cache.set_store(std::make_shared<CompositionStore>(
+      info[0].As<Napi::String>().Utf8Value()));
+  return env.Undefined();
+}
+
 Napi::Value NodeNaturalTransformation::graph(Napi::CallbackInfo const &info) {
   Napi::Env env = info.Env();
 
@@ -230,9 +409,159 @@ Napi::Value NodeNaturalTransformation::graph(Napi::CallbackInfo const &info) {
     return throw_wrong_number_of_graph_arguments(env, info.Length());
 
   try {
+    update();
+    auto const type = get_type(info[0], m_transformation.symbols);
+    return cached_value(artifacts().graphs[type], [&]() {
+      return create_graph(petri_net(type), env);
+    });
+  } catch (std::runtime_error &err) {
+    return throw_failed_to_generate_graph(err.what(), info.Env());
+  }
+}
+
+Napi::Value
+NodeNaturalTransformation::flat_graph(Napi::CallbackInfo const &info) {
+  Napi::Env env = info.Env();
+
+  if (info.Length() != 1)
+    return throw_wrong_number_of_graph_arguments(env, info.Length());
+
+  try {
+    update();
+    auto const type = get_type(info[0], m_transformation.symbols);
+    return cached_value(artifacts().flat_graphs[type], [&]() {
+      return create_flat_graph(petri_net(type), env);
+    });
+  } catch (std::runtime_error &err) {
+    return throw_failed_to_generate_graph(err.what(), info.Env());
+  }
+}
+
+Napi::Value NodeNaturalTransformation::graphs(Napi::CallbackInfo const &info) {
+  Napi::Env env = info.Env();
+
+  try {
+    update();
+    return cached_value(artifacts().all_graphs, [&]() {
+      return create_graphs(petri_nets(), env);
+    });
+  } catch (std::runtime_error &err) {
+    return throw_failed_to_generate_graph(err.what(), info.Env());
+  }
+}
+
+Napi::Value
+NodeNaturalTransformation::flat_graphs(Napi::CallbackInfo const &info) {
+  Napi::Env env = info.Env();
+
+  try {
+    update();
+    return cached_value(artifacts().all_flat_graphs, [&]() {
+      return create_flat_graphs(petri_nets(), env);
+    });
+  } catch (std::runtime_error &err) {
+    return throw_failed_to_generate_graph(err.what(), info.Env());
+  }
+}
+
+Napi::Value
+NodeNaturalTransformation::acyclicity(Napi::CallbackInfo const &info) {
+  Napi::Env env = info.Env();
+
+  try {
+    update();
+    return cached_value(artifacts().acyclicity, [&]() {
+      return create_acyclicity(check_acyclicity(petri_nets()), env);
+    });
+  } catch (std::runtime_error &err) {
+    return throw_failed_to_check_acyclicity(err.what(), info.Env());
+  }
+}
+
+Napi::Value NodeNaturalTransformation::layout(Napi::CallbackInfo const &info) {
+  Napi::Env env = info.Env();
+
+  if (info.Length() != 1)
+    return throw_wrong_number_of_graph_arguments(env, info.Length());
+
+  try {
+    update();
+    auto const type = get_type(info[0], m_transformation.symbols);
+    return cached_value(artifacts().layouts[type], [&]() {
+      return create_layout(layout_petri_net(petri_net(type)), env);
+    });
+  } catch (std::runtime_error &err) {
+    return throw_failed_to_generate_graph(err.what(), info.Env());
+  }
+}
+
+Napi::Value
+NodeNaturalTransformation::graph_diff(Napi::CallbackInfo const &info) {
+  Napi::Env env = info.Env();
+
+  if (info.Length() != 1)
+    return throw_wrong_number_of_graph_arguments(env, info.Length());
+
+  try {
+    update();
+    auto const type = get_type(info[0], m_transformation.symbols);
+    return cached_value(artifacts().graph_diffs[type], [&]() {
+      auto &previous = m_previous_nets[type];
+      auto const &net = petri_net(type);
+      auto const diff = diff_petri_nets(previous, net);
+      previous = net;
+      return create_graph_diff(previous, diff, env);
+    });
+  } catch (std::runtime_error &err) {
+    return throw_failed_to_generate_graph(err.what(), info.Env());
+  }
+}
+
+Napi::Value
+NodeNaturalTransformation::graph_chunk(Napi::CallbackInfo const &info) {
+  Napi::Env env = info.Env();
+
+  if (info.Length() < 2 || !info[1].IsNumber() ||
+      (info.Length() > 2 && !info[2].IsNumber()))
+    return throw_invalid_arguments_to_graph_chunk(env);
+
+  auto const index = info[1].ToNumber().Uint32Value();
+  auto const size = info.Length() > 2 ? info[2].ToNumber().Uint32Value()
+                                      : default_chunk_size;
+
+  try {
+    update();
+    auto const type = get_type(info[0], m_transformation.symbols);
+    auto &chunks = artifacts().chunks[{type, size}];
+    if (chunks.empty())
+      chunks = split_petri_net(petri_net(type), size);
+    return create_graph_chunk(chunks, index, env);
+  } catch (std::runtime_error &err) {
+    return throw_failed_to_generate_graph(err.what(), info.Env());
+  }
+}
+
+Napi::Value
+NodeNaturalTransformation::summary_graph(Napi::CallbackInfo const &info) {
+  Napi::Env env = info.Env();
+
+  if (info.Length() != 4 || !info[1].IsArray() || !info[2].IsArray() ||
+      !info[3].IsNumber())
+    return throw_invalid_arguments_to_summary_graph(env);
+
+  try {
+    update();
     auto const type = get_type(info[0], m_transformation.symbols);
-    return generate_graph(m_transformation.domains, m_type,
-                          m_cospan_value_count[type], type, env);
+    auto const &net = petri_net(type);
+    auto const limit = info[3].ToNumber().Uint32Value();
+
+    if (number_of_vertices(net) <= limit)
+      return create_unsummarised_graph(env);
+
+    return create_graph_summary(
+        summarise_petri_net(net, get_groups(info[1].As<Napi::Array>()),
+                            get_groups(info[2].As<Napi::Array>()), limit),
+        env);
   } catch (std::runtime_error &err) {
     return throw_failed_to_generate_graph(err.what(), info.Env());
   }
@@ -243,20 +572,72 @@ NodeNaturalTransformation::set_cospan(Napi::CallbackInfo const &info) {
   if (info.Length() == 0)
     throw std::runtime_error("no arguments passed");
 
-  CospanStructure cospan;
-  try {
-    cospan = create_cospan(info);
-  } catch (std::runtime_error &) {
-    return throw_cospan_parse_error(info.Env());
+  if (info.Length() == 1 && info[0].IsString()) {
+    m_cospan_parser.emplace(m_transformation);
+    return set_parsed_cospan(
+        info, m_cospan_parser->parse(info[0].ToString().Utf8Value()));
   }
 
+  m_cospan_parser.reset();
+  return set_parsed_cospan(info, create_cospan(info, m_transformation));
+}
+
+Napi::Value
+NodeNaturalTransformation::edit_cospan(Napi::CallbackInfo const &info) {
+  if (info.Length() < 3 || !info[0].IsNumber() || !info[1].IsNumber() ||
+      !info[2].IsString())
+    throw std::runtime_error("invalid arguments");
+
+  if (m_composition)
+    return throw_cospan_not_editable(info.Env());
+
+  if (!m_cospan_parser) {
+    m_cospan_parser = create_cospan_editor(m_transformation, m_type);
+    if (!m_cospan_parser)
+      return throw_cospan_not_editable(info.Env());
+  }
+
+  return set_parsed_cospan(
+      info, m_cospan_parser->edit(info[0].ToNumber().Uint32Value(),
+                                  info[1].ToNumber().Uint32Value(),
+                                  info[2].ToString().Utf8Value()));
+}
+
+Napi::Value
+NodeNaturalTransformation::set_parsed_cospan(Napi::CallbackInfo const &info,
+                                             CospanParse &&parsed) {
+  if (std::holds_alternative<CospanSyntaxError>(parsed))
+    return throw_cospan_parse_error(info.Env());
+  if (auto const mismatch = std::get_if<CospanMismatch>(&parsed))
+    return throw_invalid_cospan_structure(info.Env(), *mismatch);
+
+  auto &unified = std::get<UnifiedCospan>(parsed);
+  m_cospan_value_count = std::move(unified.value_count);
+  m_type = std::move(unified.cospan);
+  ++m_revision.cospan;
+  return info.This();
+}
+
+Napi::Value
+NodeNaturalTransformation::set_transformation(Napi::CallbackInfo const &info) {
+  if (info.Length() == 0)
+    throw std::runtime_error("no arguments passed");
+
   try {
-    m_cospan_value_count = unify_cospan_with_type(m_transformation, cospan);
-  } catch (std::runtime_error &ex) {
-    return throw_invalid_cospan_structure(info.Env());
+    m_transformation = create_transformation(info);
+  } catch (std::runtime_error &) {
+    return throw_transformation_parse_error(info.Env());
   }
 
-  m_type = std::move(cospan);
+  m_type = create_default_cospan(m_transformation.domains.front(),
+                                 m_transformation.domains.back());
+  m_cospan_value_count =
+      std::vector<std::size_t>(m_transformation.symbols.size(), 1);
+  m_composition.reset();
+  m_cospan_parser.reset();
+  m_previous_nets.clear();
+  ++m_revision.transformation;
+  ++m_revision.cospan;
   return info.This();
 }
 
@@ -264,13 +645,29 @@ Napi::Value
 NodeNaturalTransformation::cospan_string(Napi::CallbackInfo const &info) {
   Napi::Env env = info.Env();
   Napi::EscapableHandleScope scope(env);
-  return Napi::String::New(env, to_string(m_type));
+
+  try {
+    update();
+  } catch (std::runtime_error &err) {
+    return throw_failed_to_update(err.what(), env);
+  }
+  return cached_value(artifacts().cospan_string, [&]() {
+    return Napi::String::New(env, to_string(m_type));
+  });
 }
 
 Napi::Value NodeNaturalTransformation::string(Napi::CallbackInfo const &info) {
   Napi::Env env = info.Env();
   Napi::EscapableHandleScope scope(env);
-  return Napi::String::New(env, to_string(m_transformation));
+
+  try {
+    update();
+  } catch (std::runtime_error &err) {
+    return throw_failed_to_update(err.what(), env);
+  }
+  return cached_value(artifacts().string, [&]() {
+    return Napi::String::New(env, to_string(m_transformation));
+  });
 }
 
 Napi::Value NodeNaturalTransformation::compose(Napi::CallbackInfo const &info) {
@@ -280,30 +677,175 @@ Napi::Value NodeNaturalTransformation::compose(Napi::CallbackInfo const &info) {
   if (info.Length() == 0)
     return throw_invalid_arguments_to_compose(env);
 
-  auto const *right = get_transformation(info[0]);
+  auto *right = get_transformation(info[0]);
   auto composite_object = g_constructor.New({});
   auto *composite = get_transformation(composite_object);
 
   if (!right)
     return throw_invalid_argument_type_to_compose(env);
 
-  auto unification =
-      calculate_unification(m_transformation, right->m_transformation);
+  try {
+    update();
+    right->update();
+  } catch (std::runtime_error &err) {
+    return throw_failed_to_update(err.what(), env);
+  }
 
-  if (!unification)
+  if (!calculate_unification(m_transformation, right->m_transformation))
     return throw_failed_to_compose_types(env);
 
-  composite->m_transformation = compose_transformations(
-      m_transformation, right->m_transformation, *unification);
+  composite->m_composition = NodeComposition{Napi::Persistent(Value()),
+                                             Napi::Persistent(right->Value()),
+                                             this,
+                                             right,
+                                             {},
+                                             {},
+                                             m_revision,
+                                             right->m_revision};
 
-  auto composition = compose_cospans(
-      m_type, right->m_type, m_transformation, right->m_transformation,
-      *unification, composite->m_transformation.symbols.size());
-  composite->m_type = std::move(composition.cospan);
-  composite->m_cospan_value_count = std::move(composition.value_count);
+  try {
+    composite->compose_operands(true, true);
+  } catch (std::runtime_error &) {
+    return throw_failed_to_compose_cospans(env);
+  }
   return composite_object;
 }
 
+Napi::Value
+NodeNaturalTransformation::recompose(Napi::CallbackInfo const &info) {
+  Napi::Env env = info.Env();
+
+  if (!m_composition)
+    return throw_not_a_composite(env);
+
+  try {
+    update();
+  } catch (std::runtime_error &err) {
+    return throw_failed_to_update(err.what(), env);
+  }
+  return info.This();
+}
+
+std::vector<PetriNet> const &NodeNaturalTransformation::petri_nets() {
+  auto &nets = artifacts().nets;
+  if (!nets)
+    nets = create_petri_nets(m_transformation.domains, m_type,
+                             m_cospan_value_count, is_large(m_type));
+  return *nets;
+}
+
+PetriNet const &NodeNaturalTransformation::petri_net(std::size_t type) {
+  return petri_nets()[type];
+}
+
+NodeArtifacts &NodeNaturalTransformation::artifacts() {
+  if (is_cospan_changed(m_artifacts.revision, m_revision))
+    m_artifacts = NodeArtifacts{m_revision};
+  return m_artifacts;
+}
+
+void NodeNaturalTransformation::update() {
+  UpdateSchedule schedule;
+  UpdateLevels levels;
+  schedule_update(schedule, levels);
+
+  for (auto &&level : schedule)
+    for_each_in_parallel(level, [](NodeNaturalTransformation *node) {
+      node->update_composite();
+    });
+}
+
+std::size_t
+NodeNaturalTransformation::schedule_update(UpdateSchedule &schedule,
+                                           UpdateLevels &levels) {
+  if (!m_composition)
+    return 0;
+
+  auto const scheduled = levels.find(this);
+  if (levels.end() != scheduled)
+    return scheduled->second;
+
+  auto const level =
+      1 + std::max(m_composition->left->schedule_update(schedule, levels),
+                   m_composition->right->schedule_update(schedule, levels));
+
+  if (schedule.size() < level)
+    schedule.resize(level);
+  schedule[level - 1].emplace_back(this);
+  return levels[this] = level;
+}
+
+void NodeNaturalTransformation::update_composite() {
+  auto const &composition = *m_composition;
+  auto const &left = composition.left->m_revision;
+  auto const &right = composition.right->m_revision;
+  auto const types_changed = is_type_changed(composition.left_revision, left) ||
+                             is_type_changed(composition.right_revision, right);
+  auto const left_changed = is_cospan_changed(composition.left_revision, left);
+
+  if (types_changed || left_changed ||
+      is_cospan_changed(composition.right_revision, right))
+    compose_operands(types_changed, left_changed);
+}
+
+void NodeNaturalTransformation::compose_operands(bool types_changed,
+                                                 bool left_changed) {
+  auto &composition = *m_composition;
+  auto const &left = *composition.left;
+  auto const &right = *composition.right;
+
+  if (types_changed)
+    compose_types();
+
+  if (auto cached = g_composition_cache.find(
+          left.m_transformation, left.m_type, right.m_transformation,
+          right.m_type)) {
+    composition.left_composition.reset();
+    set_composite_cospan(CompositionResult(cached->result));
+  } else {
+    if (types_changed || left_changed || !composition.left_composition)
+      composition.left_composition =
+          compose_left_cospan(left.m_type, left.m_transformation,
+                              composition.templates,
+                              m_transformation.symbols.size(), true);
+
+    auto result = compose_cospans(
+        *composition.left_composition, left.m_type, right.m_type,
+        left.m_transformation, right.m_transformation, composition.templates,
+        true);
+    g_composition_cache.insert(left.m_transformation, left.m_type,
+                               right.m_transformation, right.m_type,
+                               {m_transformation, result});
+    set_composite_cospan(std::move(result));
+  }
+  composition.left_revision = left.m_revision;
+  composition.right_revision = right.m_revision;
+}
+
+void NodeNaturalTransformation::compose_types() {
+  auto &composition = *m_composition;
+  auto const &left = composition.left->m_transformation;
+  auto const &right = composition.right->m_transformation;
+  auto unification = calculate_unification(left, right);
+
+  if (!unification)
+    throw std::runtime_error("failed to compose types");
+
+  m_transformation = compose_transformations(left, right, *unification);
+  composition.templates = create_composition_templates(*unification);
+  m_cospan_parser.reset();
+  m_previous_nets.clear();
+  ++m_revision.transformation;
+}
+
+void NodeNaturalTransformation::set_composite_cospan(
+    CompositionResult &&composition) {
+  m_type = std::move(composition.cospan);
+  m_cospan_value_count = compact_cospan_values(m_transformation, m_type);
+  m_cospan_parser.reset();
+  ++m_revision.cospan;
+}
+
 Napi::Value
 NodeNaturalTransformation::variable(Napi::CallbackInfo const &info) {
   Napi::Env env = info.Env();
@@ -316,6 +858,12 @@ NodeNaturalTransformation::variable(Napi::CallbackInfo const &info) {
   if (!value.IsNumber())
     return throw_invalid_argument_to_variable(env);
 
+  try {
+    update();
+  } catch (std::runtime_error &err) {
+    return throw_failed_to_update(err.what(), env);
+  }
+
   auto const &symbol = m_transformation.symbols[value.ToNumber().Uint32Value()];
   return Napi::String::New(env, symbol);
 }
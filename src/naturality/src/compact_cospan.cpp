@@ -0,0 +1,571 @@
+#include "naturality/compact_cospan.hpp"
+#include "naturality/cospan_zip.hpp"
+#include "polymorphic_types/type_equality.hpp"
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+using namespace Project::Naturality;
+using namespace Project::Types;
+
+using CompactNodes = std::vector<CompactNode>;
+
+std::size_t hash_combine(std::size_t seed, std::size_t value) {
+  return seed ^ (value + 0x9E3779B97F4A7C15ull + (seed << 6) + (seed >> 2));
+}
+
+std::uint32_t to_compact_value(std::size_t value) {
+  if (value > std::numeric_limits<std::uint32_t>::max())
+    throw std::runtime_error("cospan value is too large to be compacted");
+  return static_cast<std::uint32_t>(value);
+}
+
+bool is_morphism(CompactNodes const &nodes, std::size_t index) {
+  return CompactTag::MORPHISM == get_tag(nodes[index]);
+}
+
+std::size_t next_sibling(CompactNodes const &nodes, std::size_t index) {
+  return index + subtree_size(nodes[index]);
+}
+
+std::size_t nested_index(CompactNodes const &nodes, std::size_t index) {
+  while (is_morphism(nodes, index) && 1 == nodes[index].first &&
+         is_morphism(nodes, index + 1))
+    ++index;
+  return index;
+}
+
+std::size_t begin_morphism(CompactNodes &nodes, Variance variance,
+                           std::size_t children) {
+  nodes.emplace_back(create_compact_node(CompactTag::MORPHISM, variance,
+                                         to_compact_value(children), 0));
+  return nodes.size() - 1;
+}
+
+void end_morphism(CompactNodes &nodes, std::size_t index) {
+  nodes[index].second = to_compact_value(nodes.size() - index);
+}
+
+void append_value(CompactNodes &nodes, Variance variance, std::size_t value) {
+  nodes.emplace_back(create_compact_node(CompactTag::VALUE, variance,
+                                         to_compact_value(value), 0));
+}
+
+void append_empty(CompactNodes &nodes, Variance variance) {
+  nodes.emplace_back(create_compact_node(CompactTag::EMPTY, variance, 0, 0));
+}
+
+void append_morphism(CompactNodes &, CospanMorphism const &, Variance);
+
+struct AppendCompactType {
+
+  void operator()(CompactNodes &nodes, Variance variance,
+                  std::size_t value) const {
+    append_value(nodes, variance, value);
+  }
+
+  void operator()(CompactNodes &nodes, Variance variance,
+                  CospanMorphism::PairType const &pair) const {
+    nodes.emplace_back(create_compact_node(CompactTag::PAIR, variance,
+                                           to_compact_value(pair.first),
+                                           to_compact_value(pair.second)));
+  }
+
+  void operator()(CompactNodes &nodes, Variance variance, EmptyType) const {
+    append_empty(nodes, variance);
+  }
+
+  void operator()(CompactNodes &nodes, Variance variance,
+                  CospanMorphism const &morphism) const {
+    append_morphism(nodes, morphism, variance);
+  }
+
+} _append_compact_type;
+
+void append_compact_type(CompactNodes &nodes, CospanMorphism::Type const &type,
+                         Variance variance) {
+  std::visit(std::bind(_append_compact_type, std::ref(nodes), variance,
+                       std::placeholders::_1),
+             type);
+}
+
+void append_morphism(CompactNodes &nodes, CospanMorphism const &morphism,
+                     Variance variance) {
+  auto const index = begin_morphism(nodes, variance, morphism.map.size());
+  for (auto &&type : morphism.map)
+    append_compact_type(nodes, type.type, type.variance);
+  end_morphism(nodes, index);
+}
+
+CospanMorphism read_morphism(CompactNodes const &, std::size_t);
+
+CospanMorphism::Type read_type(CompactNodes const &nodes, std::size_t index) {
+  auto const &node = nodes[index];
+  switch (get_tag(node)) {
+  case CompactTag::VALUE:
+    return std::size_t{node.first};
+  case CompactTag::PAIR:
+    return CospanMorphism::PairType{node.first, node.second};
+  case CompactTag::EMPTY:
+    return EmptyType{};
+  case CompactTag::MORPHISM:
+    return read_morphism(nodes, index);
+  }
+  throw std::runtime_error("invalid compact cospan tag");
+}
+
+CospanMorphism read_morphism(CompactNodes const &nodes, std::size_t index) {
+  CospanMorphism morphism;
+  auto const children = nodes[index].first;
+  morphism.map.reserve(children);
+
+  auto child = index + 1;
+  for (auto i = 0u; i < children; ++i) {
+    morphism.map.emplace_back(CospanMorphism::MappedType{
+        read_type(nodes, child), get_variance(nodes[child])});
+    child = next_sibling(nodes, child);
+  }
+  return std::move(morphism);
+}
+
+bool is_equal_leaves(CompactNode const &left, CompactNode const &right) {
+  if (get_tag(left) != get_tag(right))
+    return false;
+  else if (CompactTag::VALUE == get_tag(left))
+    return left.first == right.first;
+  else if (CompactTag::PAIR == get_tag(left))
+    return left.first == right.first && left.second == right.second;
+  return true;
+}
+
+bool is_equal_to_leaf(CompactNode const &leaf, CompactNodes const &nodes,
+                      std::size_t morphism) {
+  auto const nested = nested_index(nodes, morphism);
+  return 1 == nodes[nested].first && is_equal_leaves(leaf, nodes[nested + 1]);
+}
+
+bool is_equal_nodes(CompactNodes const &, std::size_t, CompactNodes const &,
+                    std::size_t);
+
+bool is_equal_morphisms(CompactNodes const &left, std::size_t left_index,
+                        CompactNodes const &right, std::size_t right_index) {
+  auto const left_nested = nested_index(left, left_index);
+  auto const right_nested = nested_index(right, right_index);
+  auto const children = left[left_nested].first;
+
+  if (children != right[right_nested].first)
+    return false;
+
+  auto left_child = left_nested + 1;
+  auto right_child = right_nested + 1;
+  for (auto i = 0u; i < children; ++i) {
+    if (get_variance(left[left_child]) != get_variance(right[right_child]) ||
+        !is_equal_nodes(left, left_child, right, right_child))
+      return false;
+    left_child = next_sibling(left, left_child);
+    right_child = next_sibling(right, right_child);
+  }
+  return true;
+}
+
+bool is_equal_nodes(CompactNodes const &left, std::size_t left_index,
+                    CompactNodes const &right, std::size_t right_index) {
+  auto const left_morphism = is_morphism(left, left_index);
+  auto const right_morphism = is_morphism(right, right_index);
+
+  if (left_morphism && right_morphism)
+    return is_equal_morphisms(left, left_index, right, right_index);
+  else if (left_morphism)
+    return is_equal_to_leaf(right[right_index], left, left_index);
+  else if (right_morphism)
+    return is_equal_to_leaf(left[left_index], right, right_index);
+  return is_equal_leaves(left[left_index], right[right_index]);
+}
+
+std::size_t hash_leaf(CompactNode const &leaf) {
+  switch (get_tag(leaf)) {
+  case CompactTag::VALUE:
+    return hash_combine(0, leaf.first);
+  case CompactTag::PAIR:
+    return hash_combine(hash_combine(1, leaf.first), leaf.second);
+  default:
+    return 2;
+  }
+}
+
+std::size_t hash_nodes(CompactNodes const &nodes, std::size_t index) {
+  if (!is_morphism(nodes, index))
+    return hash_leaf(nodes[index]);
+
+  auto const nested = nested_index(nodes, index);
+  auto const children = nodes[nested].first;
+  if (1 == children)
+    return hash_nodes(nodes, nested + 1);
+
+  auto hash = hash_combine(3, children);
+  auto child = nested + 1;
+  for (auto i = 0u; i < children; ++i) {
+    hash = hash_combine(hash,
+                        static_cast<std::size_t>(get_variance(nodes[child])));
+    hash = hash_combine(hash, hash_nodes(nodes, child));
+    child = next_sibling(nodes, child);
+  }
+  return hash;
+}
+
+std::optional<std::uint32_t> get_identifier(CompactNodes const &nodes,
+                                            std::size_t index) {
+  auto const nested = nested_index(nodes, index);
+  if (1 == nodes[nested].first &&
+      CompactTag::VALUE == get_tag(nodes[nested + 1]))
+    return nodes[nested + 1].first;
+  return std::nullopt;
+}
+
+void append_pair(CompactNodes &nodes, Variance variance, std::uint32_t first,
+                 std::uint32_t second) {
+  nodes.emplace_back(
+      create_compact_node(CompactTag::PAIR, variance, first, second));
+}
+
+void zip_morphisms(CompactNodes const &, std::size_t, CompactNodes const &,
+                   std::size_t, Variance, CompactNodes &);
+
+void zip_types(CompactNodes const &left, std::size_t left_index,
+               CompactNodes const &right, std::size_t right_index,
+               Variance variance, CompactNodes &zipped) {
+  auto const left_tag = get_tag(left[left_index]);
+  auto const right_tag = get_tag(right[right_index]);
+
+  if (CompactTag::MORPHISM == left_tag && CompactTag::MORPHISM == right_tag)
+    return zip_morphisms(left, left_index, right, right_index, variance,
+                         zipped);
+  else if (CompactTag::MORPHISM == left_tag &&
+           CompactTag::VALUE == right_tag) {
+    if (auto const identifier = get_identifier(left, left_index))
+      return append_pair(zipped, variance, *identifier,
+                         right[right_index].first);
+    throw std::runtime_error(
+        "attempted to zip cospans with differing structures");
+  } else if (CompactTag::VALUE == left_tag &&
+             CompactTag::MORPHISM == right_tag) {
+    if (auto const identifier = get_identifier(right, right_index))
+      return append_pair(zipped, variance, left[left_index].first,
+                         *identifier);
+    throw std::runtime_error(
+        "attempted to zip cospans with differing structures");
+  } else if (CompactTag::VALUE == left_tag && CompactTag::VALUE == right_tag)
+    return append_pair(zipped, variance, left[left_index].first,
+                       right[right_index].first);
+  else if (CompactTag::EMPTY == left_tag && CompactTag::EMPTY == right_tag)
+    return append_empty(zipped, variance);
+  else if (CompactTag::EMPTY == left_tag && CompactTag::VALUE == right_tag)
+    return append_pair(zipped, variance, 0, right[right_index].first);
+  else if (CompactTag::VALUE == left_tag && CompactTag::EMPTY == right_tag)
+    return append_pair(zipped, variance, left[left_index].first, 0);
+  else if (CompactTag::PAIR == left_tag && CompactTag::PAIR == right_tag)
+    throw std::runtime_error("unable to zip cospan pair types");
+  throw std::runtime_error("unable to zip cospans type");
+}
+
+void zip_morphisms(CompactNodes const &left, std::size_t left_index,
+                   CompactNodes const &right, std::size_t right_index,
+                   Variance variance, CompactNodes &zipped) {
+  auto const left_nested = nested_index(left, left_index);
+  auto const right_nested = nested_index(right, right_index);
+  auto const children = left[left_nested].first;
+
+  if (right[right_nested].first != children)
+    throw std::runtime_error(
+        "attempted to zip cospans with differing internal morphisms");
+
+  auto const index = begin_morphism(zipped, variance, children);
+  auto left_child = left_nested + 1;
+  auto right_child = right_nested + 1;
+  for (auto i = 0u; i < children; ++i) {
+    zip_types(left, left_child, right, right_child,
+              get_variance(left[left_child]), zipped);
+    left_child = next_sibling(left, left_child);
+    right_child = next_sibling(right, right_child);
+  }
+  end_morphism(zipped, index);
+}
+
+void include_value(std::pair<std::size_t, std::size_t> &bounds,
+                   std::size_t value) {
+  bounds.first = std::min(bounds.first, value);
+  bounds.second = std::max(bounds.second, value);
+}
+
+struct CompactSubstitution {
+  VariableSubstitution &substitutions;
+  SubstitutionTemplates const &templates;
+  CompactNodes const &nodes;
+  CompactNodes &result;
+};
+
+void substitute_node(CompactSubstitution const &, std::size_t, Variance,
+                     TypeConstructor::Type const &);
+
+void substitute_morphism(CompactSubstitution const &substitution,
+                         std::size_t index, Variance variance,
+                         TypeConstructor::ConstructorType const &constructor,
+                         std::string const &kind) {
+  auto const &nodes = substitution.nodes;
+  auto const nested = nested_index(nodes, index);
+  auto const morphism_size = nodes[nested].first;
+  auto const constructor_size = constructor.size();
+
+  if (constructor_size == morphism_size) {
+    auto const start =
+        begin_morphism(substitution.result, variance, morphism_size);
+    auto child = nested + 1;
+    for (auto i = 0u; i < morphism_size; ++i) {
+      substitute_node(substitution, child, get_variance(nodes[child]),
+                      constructor[i].type);
+      child = next_sibling(nodes, child);
+    }
+    end_morphism(substitution.result, start);
+  } else if (morphism_size == 1)
+    throw std::runtime_error("cospan and type constructor do not match (" +
+                             kind + ")");
+  else if (constructor_size == 1)
+    substitute_node(substitution, nested, variance, constructor[0].type);
+  else
+    throw std::runtime_error("cospan and type constructor do not match (" +
+                             kind + " size)");
+}
+
+template <typename T>
+void substitute_single(CompactSubstitution const &substitution,
+                       std::size_t index, Variance variance, T const &type) {
+  if (1 == substitution.nodes[index].first)
+    return substitute_node(substitution, index + 1, variance, type);
+  throw std::runtime_error(
+      "cospan and type constructor do not match (morphism)");
+}
+
+struct SubstituteCompactNode {
+
+  void operator()(CompactSubstitution const &substitution, std::size_t index,
+                  Variance variance, std::size_t identifier) const {
+    auto const &node = substitution.nodes[index];
+    auto const substitute = [&](std::size_t value) {
+      return substitute_cospan_value(substitution.substitutions,
+                                     substitution.templates, value,
+                                     identifier);
+    };
+
+    switch (get_tag(node)) {
+    case CompactTag::VALUE:
+      return append_compact_type(substitution.result, substitute(node.first),
+                                 variance);
+    case CompactTag::PAIR: {
+      auto const first = substitute(node.first);
+      auto const second = substitute(node.second);
+      return append_compact_type(substitution.result,
+                                 zip_cospan_types(first, second), variance);
+    }
+    case CompactTag::MORPHISM:
+      return substitute_single(substitution, index, variance,
+                               TypeConstructor::Type{identifier});
+    case CompactTag::EMPTY:
+      return append_value(substitution.result, variance, 0);
+    }
+  }
+
+  void operator()(CompactSubstitution const &substitution, std::size_t index,
+                  Variance variance,
+                  FunctorTypeConstructor const &functor) const {
+    if (is_morphism(substitution.nodes, index))
+      return substitute_morphism(substitution, index, variance, functor.type,
+                                 "functor");
+    else if (functor.type.size() == 1)
+      return substitute_node(substitution, index, variance,
+                             functor.type[0].type);
+    throw std::runtime_error(
+        "cospan and type constructor do not match (functor)");
+  }
+
+  void operator()(CompactSubstitution const &substitution, std::size_t index,
+                  Variance variance, TypeConstructor const &constructor) const {
+    if (is_morphism(substitution.nodes, index))
+      return substitute_morphism(substitution, index, variance,
+                                 get_nested(constructor).type, "constructor");
+    else if (constructor.type.size() == 1)
+      return substitute_node(substitution, index, variance,
+                             constructor.type[0].type);
+    throw std::runtime_error(
+        "cospan and type constructor do not match (constructor)");
+  }
+
+  template <typename T>
+  void operator()(CompactSubstitution const &substitution, std::size_t index,
+                  Variance variance, T const &type) const {
+    if (is_morphism(substitution.nodes, index))
+      return substitute_single(substitution, index, variance,
+                               TypeConstructor::Type{type});
+    append_value(substitution.result, variance, 0);
+  }
+
+} _substitute_compact_node;
+
+void substitute_node(CompactSubstitution const &substitution, std::size_t index,
+                     Variance variance, TypeConstructor::Type const &type) {
+  std::visit(std::bind(_substitute_compact_node, std::cref(substitution),
+                       index, variance, std::placeholders::_1),
+             type);
+}
+
+CompactMorphism move_to_compact_morphism(CompactMorphism &&morphism) {
+  auto &nodes = morphism.nodes;
+  if (!nodes.empty() && !is_morphism(nodes, 0))
+    nodes.insert(nodes.begin(),
+                 create_compact_node(CompactTag::MORPHISM,
+                                     Variance::COVARIANCE, 1,
+                                     to_compact_value(nodes.size() + 1)));
+  return std::move(morphism);
+}
+
+} // namespace
+
+namespace Project {
+namespace Naturality {
+
+CompactNode create_compact_node(CompactTag tag, Types::Variance variance,
+                                std::uint32_t first, std::uint32_t second) {
+  auto const packed = static_cast<std::uint8_t>(tag) |
+                      static_cast<std::uint8_t>(variance) << 2;
+  return CompactNode{static_cast<std::uint8_t>(packed), first, second};
+}
+
+CompactTag get_tag(CompactNode const &node) {
+  return static_cast<CompactTag>(node.tag & 0x3);
+}
+
+Types::Variance get_variance(CompactNode const &node) {
+  return static_cast<Types::Variance>(node.tag >> 2);
+}
+
+std::size_t subtree_size(CompactNode const &node) {
+  return CompactTag::MORPHISM == get_tag(node) ? node.second : 1;
+}
+
+CompactMorphism to_compact(CospanMorphism const &morphism) {
+  CompactMorphism compact;
+  append_morphism(compact.nodes, morphism, Types::Variance::COVARIANCE);
+  return std::move(compact);
+}
+
+CospanMorphism from_compact(CompactMorphism const &morphism) {
+  return read_morphism(morphism.nodes, 0);
+}
+
+std::vector<CompactMorphism>
+to_compact(std::vector<CospanMorphism> const &morphisms) {
+  std::vector<CompactMorphism> compact;
+  compact.reserve(morphisms.size());
+  for (auto &&morphism : morphisms)
+    compact.emplace_back(to_compact(morphism));
+  return std::move(compact);
+}
+
+std::vector<CospanMorphism>
+from_compact(std::vector<CompactMorphism> const &morphisms) {
+  std::vector<CospanMorphism> structured;
+  structured.reserve(morphisms.size());
+  for (auto &&morphism : morphisms)
+    structured.emplace_back(from_compact(morphism));
+  return std::move(structured);
+}
+
+CompactCospan to_compact(CospanStructure const &cospan) {
+  return CompactCospan{to_compact(cospan.domains), cospan.shared_counts,
+                       cospan.start_identifier,
+                       cospan.total_number_of_identifiers};
+}
+
+CospanStructure from_compact(CompactCospan const &cospan) {
+  return CospanStructure{from_compact(cospan.domains), cospan.shared_counts,
+                         cospan.start_identifier,
+                         cospan.total_number_of_identifiers};
+}
+
+bool is_equal(CompactMorphism const &left, CompactMorphism const &right) {
+  return is_equal_morphisms(left.nodes, 0, right.nodes, 0);
+}
+
+bool is_equal(CompactCospan const &left, CompactCospan const &right) {
+  if (left.domains.size() != right.domains.size())
+    return false;
+
+  for (auto i = 0u; i < left.domains.size(); ++i) {
+    if (!is_equal(left.domains[i], right.domains[i]))
+      return false;
+  }
+  return true;
+}
+
+std::size_t hash_value(CompactMorphism const &morphism) {
+  return hash_nodes(morphism.nodes, 0);
+}
+
+std::size_t hash_value(CompactCospan const &cospan) {
+  auto hash = hash_combine(4, cospan.domains.size());
+  for (auto &&domain : cospan.domains)
+    hash = hash_combine(hash, hash_value(domain));
+  return hash;
+}
+
+CompactMorphism zip_cospan_morphisms(CompactMorphism const &left,
+                                     CompactMorphism const &right) {
+  CompactMorphism zipped;
+  zip_morphisms(left.nodes, 0, right.nodes, 0, Types::Variance::COVARIANCE,
+                zipped.nodes);
+  return std::move(zipped);
+}
+
+MorphismBounds morphism_bounds(CompactMorphism const &morphism) {
+  auto bounds = create_empty_bounds();
+  for (auto &&node : morphism.nodes) {
+    auto const tag = get_tag(node);
+    if (CompactTag::VALUE == tag) {
+      include_value(bounds.left, node.first);
+      include_value(bounds.right, node.first);
+    } else if (CompactTag::PAIR == tag) {
+      include_value(bounds.left, node.first);
+      include_value(bounds.right, node.second);
+    }
+  }
+  return bounds;
+}
+
+std::vector<std::pair<std::size_t, std::size_t>>
+shared_count(std::vector<CompactMorphism> const &morphisms) {
+  std::vector<MorphismBounds> bounds;
+  bounds.reserve(morphisms.size());
+  for (auto &&morphism : morphisms)
+    bounds.emplace_back(morphism_bounds(morphism));
+  return shared_count(bounds);
+}
+
+CompactMorphism cospan_substitution(VariableSubstitution &substitutions,
+                                    SubstitutionTemplates const &templates,
+                                    CompactMorphism const &morphism,
+                                    Types::TypeConstructor const &constructor) {
+  CompactMorphism substituted;
+  substitute_morphism({substitutions, templates, morphism.nodes,
+                       substituted.nodes},
+                      0, Types::Variance::COVARIANCE,
+                      Types::get_nested(constructor).type, "constructor");
+  return move_to_compact_morphism(std::move(substituted));
+}
+
+} // namespace Naturality
+} // namespace Project
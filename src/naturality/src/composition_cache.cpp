@@ -0,0 +1,335 @@
+#include "naturality/composition_cache.hpp"
+#include "naturality/composition_store.hpp"
+#include "naturality/cospan_equality.hpp"
+#include "naturality/natural_composition.hpp"
+#include "naturality/unify_cospan_with_type.hpp"
+#include "polymorphic_types/type_equality.hpp"
+#include "polymorphic_types/unification.hpp"
+
+#include <functional>
+#include <stdexcept>
+
+namespace {
+
+using namespace Project::Naturality;
+using namespace Project::Types;
+
+std::size_t hash_combine(std::size_t seed, std::size_t value) {
+  return seed ^ (value + 0x9E3779B97F4A7C15ull + (seed << 6) + (seed >> 2));
+}
+
+std::size_t hash_transformation(NaturalTransformation const &transformation) {
+  return std::hash<std::string>()(debug_string(transformation));
+}
+
+bool is_equal_transformations(NaturalTransformation const &left,
+                              NaturalTransformation const &right) {
+  if (left.symbols != right.symbols ||
+      left.functor_symbols != right.functor_symbols ||
+      left.domains.size() != right.domains.size())
+    return false;
+
+  for (auto i = 0u; i < left.domains.size(); ++i) {
+    if (!is_equal(left.domains[i], right.domains[i]))
+      return false;
+  }
+  return true;
+}
+
+std::size_t memory_footprint(CospanMorphism const &morphism) {
+  auto footprint = sizeof(CospanMorphism) +
+                   morphism.map.capacity() * sizeof(CospanMorphism::MappedType);
+  for (auto &&mapped : morphism.map) {
+    if (auto nested = std::get_if<CospanMorphism>(&mapped.type))
+      footprint += memory_footprint(*nested) - sizeof(CospanMorphism);
+  }
+  return footprint;
+}
+
+std::size_t memory_footprint(CompactCospan const &cospan) {
+  auto footprint = sizeof(CompactCospan) +
+                   cospan.shared_counts.capacity() *
+                       sizeof(std::pair<std::size_t, std::size_t>) +
+                   cospan.domains.capacity() * sizeof(CompactMorphism);
+  for (auto &&domain : cospan.domains)
+    footprint += domain.nodes.capacity() * sizeof(CompactNode);
+  return footprint;
+}
+
+std::size_t
+memory_footprint(TypeConstructor::ConstructorType const &constructor) {
+  auto footprint = constructor.capacity() * sizeof(TypeConstructor::AtomicType);
+  for (auto &&atomic : constructor) {
+    if (auto nested = std::get_if<TypeConstructor>(&atomic.type))
+      footprint += memory_footprint(nested->type);
+    else if (auto functor = std::get_if<FunctorTypeConstructor>(&atomic.type))
+      footprint += memory_footprint(functor->type);
+  }
+  return footprint;
+}
+
+std::size_t memory_footprint(std::vector<std::string> const &symbols) {
+  auto footprint = symbols.capacity() * sizeof(std::string);
+  for (auto &&symbol : symbols)
+    footprint += symbol.capacity();
+  return footprint;
+}
+
+std::size_t memory_footprint(CompositionKey const &key) {
+  return sizeof(CompositionKey) + memory_footprint(key.left) +
+         memory_footprint(key.left_cospan) + memory_footprint(key.right) +
+         memory_footprint(key.right_cospan);
+}
+
+std::size_t memory_footprint(CachedComposition const &composition) {
+  return sizeof(CachedComposition) +
+         memory_footprint(composition.transformation) +
+         memory_footprint(composition.result.cospan) +
+         composition.result.value_count.capacity() * sizeof(std::size_t);
+}
+
+} // namespace
+
+namespace Project {
+namespace Naturality {
+
+std::size_t memory_footprint(NaturalTransformation const &transformation) {
+  auto footprint =
+      sizeof(NaturalTransformation) +
+      transformation.domains.capacity() * sizeof(Types::TypeConstructor) +
+      ::memory_footprint(transformation.symbols) +
+      ::memory_footprint(transformation.functor_symbols);
+  for (auto &&domain : transformation.domains)
+    footprint += ::memory_footprint(domain.type);
+  return footprint;
+}
+
+std::size_t memory_footprint(CospanStructure const &cospan) {
+  auto footprint =
+      sizeof(CospanStructure) +
+      cospan.shared_counts.capacity() *
+          sizeof(std::pair<std::size_t, std::size_t>) +
+      (cospan.domains.capacity() - cospan.domains.size()) *
+          sizeof(CospanMorphism);
+  for (auto &&domain : cospan.domains)
+    footprint += ::memory_footprint(domain);
+  return footprint;
+}
+
+std::size_t CompositionKeyHash::operator()(CompositionKey const &key) const {
+  return key.hash;
+}
+
+std::size_t CompositionKeyHash::operator()(CompositionKey const *key) const {
+  return key->hash;
+}
+
+bool CompositionKeyEqual::operator()(CompositionKey const &left,
+                                     CompositionKey const &right) const {
+  return left.hash == right.hash &&
+         is_equal_transformations(left.left, right.left) &&
+         is_equal_transformations(left.right, right.right) &&
+         is_equal(left.left_cospan, right.left_cospan) &&
+         is_equal(left.right_cospan, right.right_cospan);
+}
+
+bool CompositionKeyEqual::operator()(CompositionKey const *left,
+                                     CompositionKey const *right) const {
+  return (*this)(*left, *right);
+}
+
+CompositionKey create_composition_key(NaturalTransformation const &left,
+                                      CospanStructure const &left_cospan,
+                                      NaturalTransformation const &right,
+                                      CospanStructure const &right_cospan) {
+  CompositionKey key{left, {}, right, {}, 0};
+  auto canonical_left = left_cospan;
+  auto canonical_right = right_cospan;
+  canonicalize_cospan(key.left, canonical_left);
+  canonicalize_cospan(key.right, canonical_right);
+  key.left_cospan = to_compact(canonical_left);
+  key.right_cospan = to_compact(canonical_right);
+  key.hash = hash_value(key);
+  return std::move(key);
+}
+
+std::size_t hash_value(CompositionKey const &key) {
+  auto hash = hash_combine(0, hash_transformation(key.left));
+  hash = hash_combine(hash, hash_value(key.left_cospan));
+  hash = hash_combine(hash, hash_transformation(key.right));
+  return hash_combine(hash, hash_value(key.right_cospan));
+}
+
+CachedComposition compose(NaturalTransformation const &left,
+                          CospanStructure const &left_cospan,
+                          NaturalTransformation const &right,
+                          CospanStructure const &right_cospan) {
+  auto unification = calculate_unification(
+      left.domains.back(), right.domains.front(), left.symbols.size(),
+      right.symbols.size(), left.functor_symbols.size(),
+      right.functor_symbols.size());
+
+  if (!unification)
+    throw std::runtime_error("Failed to compose types");
+
+  auto transformation = compose_transformations(left, right, *unification);
+  auto result =
+      compose_cospans(left_cospan, right_cospan, left, right, *unification,
+                      transformation.symbols.size());
+  return {std::move(transformation), std::move(result)};
+}
+
+CompositionCache::CompositionCache(std::size_t memory_limit)
+    : m_memory_limit(memory_limit), m_memory_footprint(0), m_hits(0),
+      m_misses(0), m_evictions(0), m_store_hits(0) {}
+
+CompositionCache::Entry
+CompositionCache::find(NaturalTransformation const &left,
+                       CospanStructure const &left_cospan,
+                       NaturalTransformation const &right,
+                       CospanStructure const &right_cospan) {
+  auto const key =
+      create_composition_key(left, left_cospan, right, right_cospan);
+  if (auto entry = find_cached(key))
+    return entry;
+  return find_stored(key);
+}
+
+CompositionCache::Entry
+CompositionCache::insert(NaturalTransformation const &left,
+                         CospanStructure const &left_cospan,
+                         NaturalTransformation const &right,
+                         CospanStructure const &right_cospan,
+                         CachedComposition &&composition) {
+  auto key = create_composition_key(left, left_cospan, right, right_cospan);
+  return insert(std::move(key), std::move(composition));
+}
+
+CompositionCache::Entry
+CompositionCache::compose(NaturalTransformation const &left,
+                          CospanStructure const &left_cospan,
+                          NaturalTransformation const &right,
+                          CospanStructure const &right_cospan) {
+  auto key = create_composition_key(left, left_cospan, right, right_cospan);
+  if (auto entry = find_cached(key))
+    return entry;
+  if (auto entry = find_stored(key))
+    return entry;
+
+  auto composition =
+      Naturality::compose(key.left, from_compact(key.left_cospan), key.right,
+                          from_compact(key.right_cospan));
+  return insert(std::move(key), std::move(composition));
+}
+
+void CompositionCache::set_store(std::shared_ptr<CompositionStore> store) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_store = std::move(store);
+}
+
+void CompositionCache::set_memory_limit(std::size_t memory_limit) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_memory_limit = memory_limit;
+  evict();
+}
+
+void CompositionCache::clear() {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_evictions += m_nodes.size();
+  m_index.clear();
+  m_nodes.clear();
+  m_memory_footprint = 0;
+}
+
+CompositionCacheStatistics CompositionCache::statistics() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return {m_hits,       m_misses,       m_evictions,
+          m_store_hits, m_nodes.size(), m_memory_footprint};
+}
+
+CompositionCache::Entry
+CompositionCache::find_cached(CompositionKey const &key) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  auto const found = m_index.find(&key);
+  if (m_index.end() == found)
+    return nullptr;
+
+  ++m_hits;
+  m_nodes.splice(m_nodes.begin(), m_nodes, found->second);
+  return found->second->entry;
+}
+
+CompositionCache::Entry
+CompositionCache::find_stored(CompositionKey const &key) {
+  std::shared_ptr<CompositionStore> store;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    store = m_store;
+  }
+
+  auto stored = store ? store->find(key) : std::nullopt;
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if (!stored) {
+    ++m_misses;
+    return nullptr;
+  }
+
+  ++m_store_hits;
+  return remember(CompositionKey(key), std::move(*stored));
+}
+
+CompositionCache::Entry
+CompositionCache::insert(CompositionKey &&key,
+                         CachedComposition &&composition) {
+  std::shared_ptr<CompositionStore> store;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto const found = m_index.find(&key);
+    if (m_index.end() != found) {
+      m_nodes.splice(m_nodes.begin(), m_nodes, found->second);
+      return found->second->entry;
+    }
+    store = m_store;
+  }
+
+  if (store)
+    store->append(key, composition);
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return remember(std::move(key), std::move(composition));
+}
+
+CompositionCache::Entry
+CompositionCache::remember(CompositionKey &&key,
+                           CachedComposition &&composition) {
+  auto const found = m_index.find(&key);
+  if (m_index.end() != found) {
+    m_nodes.splice(m_nodes.begin(), m_nodes, found->second);
+    return found->second->entry;
+  }
+
+  auto const footprint =
+      ::memory_footprint(key) + ::memory_footprint(composition);
+  auto entry =
+      std::make_shared<CachedComposition const>(std::move(composition));
+  if (footprint > m_memory_limit)
+    return entry;
+
+  m_nodes.push_front({std::move(key), entry, footprint});
+  m_index.emplace(&m_nodes.front().key, m_nodes.begin());
+  m_memory_footprint += footprint;
+  evict();
+  return entry;
+}
+
+void CompositionCache::evict() {
+  while (m_memory_footprint > m_memory_limit && !m_nodes.empty()) {
+    auto &last = m_nodes.back();
+    m_index.erase(&last.key);
+    m_memory_footprint -= last.footprint;
+    m_nodes.pop_back();
+    ++m_evictions;
+  }
+}
+
+} // namespace Naturality
+} // namespace Project
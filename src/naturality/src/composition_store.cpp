@@ -0,0 +1,488 @@
+#include "naturality/composition_store.hpp"
+
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+
+namespace {
+
+using namespace Project::Naturality;
+using namespace Project::Types;
+
+constexpr char store_magic[] = {'N', 'A', 'T', 'C', 'O', 'M', 'P', '\n'};
+constexpr std::size_t header_size = sizeof(store_magic) + 8;
+constexpr std::size_t record_header_size = 24;
+
+std::uint64_t checksum(char const *data, std::size_t size) {
+  std::uint64_t hash = 0xCBF29CE484222325ull;
+  for (auto i = 0u; i < size; ++i) {
+    hash ^= static_cast<unsigned char>(data[i]);
+    hash *= 0x100000001B3ull;
+  }
+  return hash;
+}
+
+void write_integer(std::string &output, std::uint64_t value,
+                   std::size_t bytes = 8) {
+  for (auto i = 0u; i < bytes; ++i)
+    output.push_back(static_cast<char>((value >> (8 * i)) & 0xFF));
+}
+
+void write_string(std::string &output, std::string const &value) {
+  write_integer(output, value.size());
+  output += value;
+}
+
+void write_strings(std::string &output,
+                   std::vector<std::string> const &values) {
+  write_integer(output, values.size());
+  for (auto &&value : values)
+    write_string(output, value);
+}
+
+void write_sizes(std::string &output, std::vector<std::size_t> const &values) {
+  write_integer(output, values.size());
+  for (auto &&value : values)
+    write_integer(output, value);
+}
+
+void write_constructor(std::string &, TypeConstructor::ConstructorType const &);
+
+struct WriteType {
+  std::string &output;
+
+  void operator()(FreeType) const {}
+
+  void operator()(MonoType type) const {
+    write_integer(output, static_cast<std::uint64_t>(type), 1);
+  }
+
+  void operator()(std::size_t identifier) const {
+    write_integer(output, identifier);
+  }
+
+  void operator()(FunctorTypeConstructor const &functor) const {
+    write_integer(output, functor.identifier);
+    write_constructor(output, functor.type);
+  }
+
+  void operator()(TypeConstructor const &constructor) const {
+    write_constructor(output, constructor.type);
+  }
+};
+
+void write_constructor(std::string &output,
+                       TypeConstructor::ConstructorType const &types) {
+  write_integer(output, types.size());
+  for (auto &&type : types) {
+    write_integer(output, static_cast<std::uint64_t>(type.variance), 1);
+    write_integer(output, type.type.index(), 1);
+    std::visit(WriteType{output}, type.type);
+  }
+}
+
+void write_transformation(std::string &output,
+                          NaturalTransformation const &transformation) {
+  write_integer(output, transformation.domains.size());
+  for (auto &&domain : transformation.domains)
+    write_constructor(output, domain.type);
+  write_strings(output, transformation.symbols);
+  write_strings(output, transformation.functor_symbols);
+}
+
+void write_morphism(std::string &, CospanMorphism const &);
+
+struct WriteMappedType {
+  std::string &output;
+
+  void operator()(std::size_t value) const { write_integer(output, value); }
+
+  void operator()(CospanMorphism::PairType const &pair) const {
+    write_integer(output, pair.first);
+    write_integer(output, pair.second);
+  }
+
+  void operator()(EmptyType) const {}
+
+  void operator()(CospanMorphism const &morphism) const {
+    write_morphism(output, morphism);
+  }
+};
+
+void write_morphism(std::string &output, CospanMorphism const &morphism) {
+  write_integer(output, morphism.map.size());
+  for (auto &&mapped : morphism.map) {
+    write_integer(output, static_cast<std::uint64_t>(mapped.variance), 1);
+    write_integer(output, mapped.type.index(), 1);
+    std::visit(WriteMappedType{output}, mapped.type);
+  }
+}
+
+void write_cospan(std::string &output, CospanStructure const &cospan) {
+  write_integer(output, cospan.domains.size());
+  for (auto &&domain : cospan.domains)
+    write_morphism(output, domain);
+  write_integer(output, cospan.shared_counts.size());
+  for (auto &&count : cospan.shared_counts) {
+    write_integer(output, count.first);
+    write_integer(output, count.second);
+  }
+  write_integer(output, cospan.start_identifier);
+  write_integer(output, cospan.total_number_of_identifiers);
+}
+
+struct Reader {
+  std::string const &input;
+  std::size_t position;
+
+  std::uint64_t integer(std::size_t bytes = 8) {
+    if (input.size() - position < bytes)
+      throw std::runtime_error("truncated composition record");
+
+    std::uint64_t value = 0;
+    for (auto i = 0u; i < bytes; ++i)
+      value |= static_cast<std::uint64_t>(
+                   static_cast<unsigned char>(input[position++]))
+               << (8 * i);
+    return value;
+  }
+
+  std::size_t length() {
+    auto const value = integer();
+    if (value > input.size() - position)
+      throw std::runtime_error("invalid length in composition record");
+    return static_cast<std::size_t>(value);
+  }
+
+  std::size_t tag(std::size_t limit) {
+    auto const value = integer(1);
+    if (value >= limit)
+      throw std::runtime_error("invalid tag in composition record");
+    return static_cast<std::size_t>(value);
+  }
+
+  Variance variance() { return static_cast<Variance>(tag(4)); }
+};
+
+std::string read_string(Reader &reader) {
+  auto const size = reader.length();
+  auto value = reader.input.substr(reader.position, size);
+  reader.position += size;
+  return std::move(value);
+}
+
+std::vector<std::string> read_strings(Reader &reader) {
+  std::vector<std::string> values(reader.length());
+  for (auto &&value : values)
+    value = read_string(reader);
+  return std::move(values);
+}
+
+std::vector<std::size_t> read_sizes(Reader &reader) {
+  std::vector<std::size_t> values(reader.length());
+  for (auto &&value : values)
+    value = reader.integer();
+  return std::move(values);
+}
+
+TypeConstructor::ConstructorType read_constructor(Reader &);
+
+TypeConstructor::Type read_type(Reader &reader, std::size_t index) {
+  switch (index) {
+  case 0:
+    return FreeType();
+  case 1:
+    return static_cast<MonoType>(reader.tag(3));
+  case 2:
+    return static_cast<std::size_t>(reader.integer());
+  case 3: {
+    auto const identifier = reader.integer();
+    return FunctorTypeConstructor{read_constructor(reader), identifier};
+  }
+  default:
+    return TypeConstructor{read_constructor(reader)};
+  }
+}
+
+TypeConstructor::ConstructorType read_constructor(Reader &reader) {
+  TypeConstructor::ConstructorType types(reader.length());
+  for (auto &&type : types) {
+    type.variance = reader.variance();
+    type.type = read_type(reader, reader.tag(5));
+  }
+  return std::move(types);
+}
+
+NaturalTransformation read_transformation(Reader &reader) {
+  NaturalTransformation transformation;
+  transformation.domains.resize(reader.length());
+  for (auto &&domain : transformation.domains)
+    domain.type = read_constructor(reader);
+  transformation.symbols = read_strings(reader);
+  transformation.functor_symbols = read_strings(reader);
+  return std::move(transformation);
+}
+
+CospanMorphism read_morphism(Reader &);
+
+CospanMorphism::Type read_mapped_type(Reader &reader, std::size_t index) {
+  switch (index) {
+  case 0:
+    return static_cast<std::size_t>(reader.integer());
+  case 1: {
+    auto const first = reader.integer();
+    return CospanMorphism::PairType(first, reader.integer());
+  }
+  case 2:
+    return EmptyType();
+  default:
+    return read_morphism(reader);
+  }
+}
+
+CospanMorphism read_morphism(Reader &reader) {
+  CospanMorphism morphism;
+  morphism.map.resize(reader.length());
+  for (auto &&mapped : morphism.map) {
+    mapped.variance = reader.variance();
+    mapped.type = read_mapped_type(reader, reader.tag(4));
+  }
+  return std::move(morphism);
+}
+
+CospanStructure read_cospan(Reader &reader) {
+  CospanStructure cospan;
+  cospan.domains.resize(reader.length());
+  for (auto &&domain : cospan.domains)
+    domain = read_morphism(reader);
+  cospan.shared_counts.resize(reader.length());
+  for (auto &&count : cospan.shared_counts) {
+    count.first = reader.integer();
+    count.second = reader.integer();
+  }
+  cospan.start_identifier = reader.integer();
+  cospan.total_number_of_identifiers = reader.integer();
+  return std::move(cospan);
+}
+
+std::string store_header() {
+  std::string header(store_magic, sizeof(store_magic));
+  write_integer(header, composition_store_version, 4);
+  write_integer(header, sizeof(std::size_t), 4);
+  return std::move(header);
+}
+
+std::string record_frame(std::size_t hash, std::string const &payload) {
+  std::string frame;
+  write_integer(frame, payload.size());
+  write_integer(frame, checksum(payload.data(), payload.size()));
+  write_integer(frame, hash);
+  return frame + payload;
+}
+
+bool read_frame(std::istream &input, std::uint64_t offset, std::uint64_t size,
+                std::string &frame) {
+  frame.assign(size, '\0');
+  input.clear();
+  input.seekg(offset);
+  if (size < record_header_size || !input.read(&frame[0], size))
+    return false;
+
+  Reader reader{frame, 0};
+  auto const payload_size = reader.integer();
+  auto const expected = reader.integer();
+  return payload_size == size - record_header_size &&
+         checksum(frame.data() + record_header_size, payload_size) ==
+             expected;
+}
+
+std::uint64_t stream_size(std::istream &input) {
+  input.seekg(0, std::ios::end);
+  auto const size = static_cast<std::uint64_t>(input.tellg());
+  input.seekg(0, std::ios::beg);
+  return size;
+}
+
+} // namespace
+
+namespace Project {
+namespace Naturality {
+
+std::string serialize(CompositionKey const &key,
+                      CachedComposition const &composition) {
+  std::string output;
+  write_transformation(output, key.left);
+  write_cospan(output, from_compact(key.left_cospan));
+  write_transformation(output, key.right);
+  write_cospan(output, from_compact(key.right_cospan));
+  write_transformation(output, composition.transformation);
+  write_cospan(output, composition.result.cospan);
+  write_sizes(output, composition.result.value_count);
+  return std::move(output);
+}
+
+bool deserialize(std::string const &input, CompositionKey &key,
+                 CachedComposition &composition) {
+  Reader reader{input, 0};
+  try {
+    key.left = read_transformation(reader);
+    key.left_cospan = to_compact(read_cospan(reader));
+    key.right = read_transformation(reader);
+    key.right_cospan = to_compact(read_cospan(reader));
+    composition.transformation = read_transformation(reader);
+    composition.result.cospan = read_cospan(reader);
+    composition.result.value_count = read_sizes(reader);
+  } catch (std::runtime_error &) {
+    return false;
+  }
+
+  key.hash = hash_value(key);
+  return reader.position == input.size();
+}
+
+CompositionStore::CompositionStore(std::string path, std::size_t size_limit)
+    : m_path(std::move(path)), m_size_limit(size_limit), m_end(0),
+      m_loaded(false), m_consistent(false) {}
+
+std::optional<CachedComposition>
+CompositionStore::find(CompositionKey const &key) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  load();
+  return read(key);
+}
+
+void CompositionStore::append(CompositionKey const &key,
+                              CachedComposition const &composition) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  load();
+
+  auto const frame = record_frame(key.hash, serialize(key, composition));
+  if (header_size + frame.size() > m_size_limit || read(key))
+    return;
+
+  if (!m_consistent || m_end + frame.size() > m_size_limit)
+    return compact(frame, key.hash);
+
+  std::ofstream output(m_path, std::ios::binary | std::ios::app);
+  output << frame;
+  m_consistent = output.good();
+  if (m_consistent) {
+    add_location({key.hash, m_end, frame.size()});
+    m_end += frame.size();
+  }
+}
+
+std::size_t CompositionStore::size() {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  load();
+  return m_locations.size();
+}
+
+std::string const &CompositionStore::path() const { return m_path; }
+
+void CompositionStore::load() {
+  if (m_loaded)
+    return;
+  m_loaded = true;
+
+  std::ifstream input(m_path, std::ios::binary);
+  if (input)
+    m_consistent = read_locations(input);
+}
+
+bool CompositionStore::read_locations(std::istream &input) {
+  auto const size = stream_size(input);
+  std::string header(header_size, '\0');
+  if (!input.read(&header[0], header_size) || header != store_header())
+    return false;
+
+  std::string frame(record_header_size, '\0');
+  std::string payload;
+  m_end = header_size;
+  while (input.read(&frame[0], record_header_size)) {
+    Reader reader{frame, 0};
+    auto const payload_size = reader.integer();
+    auto const expected = reader.integer();
+    auto const hash = reader.integer();
+    if (payload_size > size - m_end - record_header_size)
+      return false;
+
+    payload.resize(payload_size);
+    if (!input.read(&payload[0], payload_size) ||
+        checksum(payload.data(), payload_size) != expected)
+      return false;
+
+    add_location({hash, m_end, record_header_size + payload_size});
+    m_end += record_header_size + payload_size;
+  }
+  return 0 == input.gcount();
+}
+
+std::optional<CachedComposition>
+CompositionStore::read(CompositionKey const &key) {
+  auto const range = m_index.equal_range(key.hash);
+  if (range.first == range.second)
+    return std::nullopt;
+
+  std::ifstream input(m_path, std::ios::binary);
+  std::string frame;
+  for (auto it = range.first; it != range.second; ++it) {
+    auto const &location = m_locations[it->second];
+    CompositionKey stored;
+    CachedComposition composition;
+    if (read_frame(input, location.offset, location.size, frame) &&
+        deserialize(frame.substr(record_header_size), stored, composition) &&
+        CompositionKeyEqual()(key, stored))
+      return std::move(composition);
+  }
+  return std::nullopt;
+}
+
+void CompositionStore::compact(std::string const &frame, std::size_t hash) {
+  auto kept = m_locations.size();
+  auto total = header_size + frame.size();
+  while (kept > 0 && total + m_locations[kept - 1].size <= m_size_limit / 2)
+    total += m_locations[--kept].size;
+
+  auto const temporary = m_path + ".compact";
+  std::ifstream input(m_path, std::ios::binary);
+  std::ofstream output(temporary, std::ios::binary | std::ios::trunc);
+  output << store_header();
+
+  std::vector<Location> locations;
+  std::uint64_t end = header_size;
+  std::string record;
+  for (auto i = kept; i < m_locations.size(); ++i) {
+    auto const &location = m_locations[i];
+    if (!read_frame(input, location.offset, location.size, record))
+      continue;
+    output << record;
+    locations.push_back({location.hash, end, record.size()});
+    end += record.size();
+  }
+  output << frame;
+  locations.push_back({hash, end, frame.size()});
+  output.close();
+  input.close();
+
+  if (!output || 0 != std::rename(temporary.c_str(), m_path.c_str())) {
+    std::remove(temporary.c_str());
+    m_consistent = false;
+    return;
+  }
+
+  m_locations.clear();
+  m_index.clear();
+  for (auto &&location : locations)
+    add_location(location);
+  m_end = end + frame.size();
+  m_consistent = true;
+}
+
+void CompositionStore::add_location(Location const &location) {
+  m_index.emplace(location.hash, m_locations.size());
+  m_locations.emplace_back(location);
+}
+
+} // namespace Naturality
+} // namespace Project
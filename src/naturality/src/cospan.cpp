@@ -1,4 +1,5 @@
 #include "naturality/cospan.hpp"
+#include "naturality/cospan_shared_count.hpp"
 #include "naturality/natural_transformation.hpp"
 
 #include <algorithm>
@@ -17,7 +18,7 @@ struct CreateDefaultMappedType {
 
   CospanMorphism::MappedType operator()(Variance variance,
                                         std::size_t identifier) const {
-    return CospanMorphism::MappedType{0, variance};
+    return CospanMorphism::MappedType{std::size_t{0}, variance};
   }
 
   CospanMorphism::MappedType
@@ -63,6 +64,13 @@ CospanMorphism create_default_from(TypeConstructor const &constructor) {
 namespace Project {
 namespace Naturality {
 
+std::string to_string(CospanMismatch const &mismatch) {
+  auto location = "domain " + std::to_string(mismatch.domain);
+  for (auto &&index : mismatch.path)
+    location += "." + std::to_string(index);
+  return mismatch.reason + " at " + location;
+}
+
 CospanStructure create_default_cospan(Types::TypeConstructor const &domain,
                                       Types::TypeConstructor const &codomain) {
   std::vector<CospanMorphism> domains = {create_default_from(domain),
@@ -70,5 +78,15 @@ CospanStructure create_default_cospan(Types::TypeConstructor const &domain,
   return CospanStructure{std::move(domains), {{0, 1}, {1, 0}}, 0, 1};
 }
 
+CospanStructure
+create_default_cospan(std::vector<Types::TypeConstructor> const &types) {
+  std::vector<CospanMorphism> domains;
+  domains.reserve(types.size());
+  std::transform(types.begin(), types.end(), std::back_inserter(domains),
+                 create_default_from);
+  auto shared_counts = shared_count(domains);
+  return CospanStructure{std::move(domains), std::move(shared_counts), 0, 1};
+}
+
 } // namespace Naturality
 } // namespace Project
\ No newline at end of file
@@ -3,65 +3,271 @@
 #include "naturality/cospan_shared_count.hpp"
 #include "naturality/cospan_substitution.hpp"
 #include "naturality/cospan_zip.hpp"
+#include "naturality/parallel_for.hpp"
 #include "polymorphic_types/type_equality.hpp"
 
+#include <algorithm>
+#include <optional>
+#include <thread>
+
 namespace {
 
 using namespace Project::Naturality;
 using namespace Project::Types;
 
+std::optional<CospanMismatch>
+add_checked_domain(std::vector<CospanMorphism> &domains, std::size_t domain,
+                   Checked<CospanMorphism> &&morphism) {
+  if (auto mismatch = std::get_if<CospanMismatch>(&morphism)) {
+    mismatch->domain = domain;
+    return std::move(*mismatch);
+  }
+  domains[domain] = std::move(std::get<CospanMorphism>(morphism));
+  return std::nullopt;
+}
+
 template <typename StartCospanIt, typename StartTransformIt>
-void add_substituted_domains(
+std::optional<CospanMismatch> add_substituted_domains(
     std::vector<CospanMorphism> &domains, StartCospanIt start_cospan,
     StartTransformIt start_transform, std::size_t number_of_domains,
-    std::vector<std::optional<TypeConstructor::Type>> const &unification,
+    SubstitutionTemplates const &templates,
     VariableSubstitution &substitutions) {
+  for (auto i = 0u; i < number_of_domains; ++i) {
+    domains.emplace_back();
+    if (auto mismatch = add_checked_domain(
+            domains, domains.size() - 1,
+            try_cospan_substitution(substitutions, templates,
+                                    *(start_cospan + i),
+                                    *(start_transform + i))))
+      return mismatch;
+  }
+  return std::nullopt;
+}
+
+Checked<CospanMorphism> get_zipped_substitution(
+    CospanMorphism const &left_morphism, CospanMorphism const &right_morphism,
+    TypeConstructor const &left_type, TypeConstructor const &right_type,
+    CompositionTemplates const &templates,
+    VariableSubstitution &left_substitution,
+    VariableSubstitution &right_substitution) {
+  auto const left = try_cospan_substitution(left_substitution, templates.left,
+                                            left_morphism, left_type);
+  if (std::holds_alternative<CospanMismatch>(left))
+    return left;
+
+  auto const right = try_cospan_substitution(
+      right_substitution, templates.right, right_morphism, right_type);
+  if (std::holds_alternative<CospanMismatch>(right))
+    return right;
+  return try_zip_cospan_morphisms(std::get<CospanMorphism>(left),
+                                  std::get<CospanMorphism>(right));
+}
+
+std::size_t get_max(std::vector<std::size_t> const &vec) {
+  return *std::max_element(vec.begin(), vec.end());
+}
+
+template <typename Substitute>
+void substitute_in_partitions(std::size_t identifiers,
+                              Substitute const &substitute) {
+  auto const hardware = std::max(1u, std::thread::hardware_concurrency());
+  auto const partitions =
+      std::max<std::size_t>(1, std::min<std::size_t>(identifiers, hardware));
+  parallel_for(partitions, [&](std::size_t index) {
+    substitute(SubstitutionPartition{index, partitions});
+  });
+}
+
+template <typename StartCospanIt, typename StartTransformIt>
+void add_partitioned_domains(StartCospanIt start_cospan,
+                             StartTransformIt start_transform,
+                             std::size_t number_of_domains,
+                             SubstitutionTemplates const &templates,
+                             SubstitutionPartition partition,
+                             VariableSubstitution &substitutions,
+                             SubstitutedValues &values) {
   for (auto i = 0u; i < number_of_domains; ++i)
-    domains.emplace_back(cospan_substitution(substitutions, unification,
-                                             *(start_cospan + i),
-                                             *(start_transform + i)));
+    partitioned_cospan_substitution(substitutions, templates, partition,
+                                    *(start_cospan + i),
+                                    *(start_transform + i), values);
 }
 
 template <typename StartCospanIt, typename StartTransformIt>
-std::vector<CospanMorphism> get_substituted_domains(
-    StartCospanIt start_cospan, StartTransformIt start_transform,
-    std::size_t number_of_domains,
-    std::vector<std::optional<TypeConstructor::Type>> const &unification,
-    VariableSubstitution &substitutions) {
+void add_merged_domains(std::vector<CospanMorphism> &domains,
+                        StartCospanIt start_cospan,
+                        StartTransformIt start_transform,
+                        std::size_t number_of_domains,
+                        SubstitutedValues const &values,
+                        std::vector<std::size_t> &positions) {
+  for (auto i = 0u; i < number_of_domains; ++i)
+    domains.emplace_back(merge_cospan_substitution(
+        values, positions, *(start_cospan + i), *(start_transform + i)));
+}
+
+LeftComposition
+compose_left_in_parallel(CospanStructure const &left_cospan,
+                         NaturalTransformation const &left_transform,
+                         SubstitutionTemplates const &templates,
+                         std::size_t identifiers) {
+  auto substitution = create_empty_substitution(left_transform, identifiers);
+  auto const number_of_domains = left_cospan.domains.size() - 1;
+  SubstitutedValues values(substitution.variables.size());
+
+  substitute_in_partitions(
+      substitution.variables.size(), [&](SubstitutionPartition partition) {
+        add_partitioned_domains(left_cospan.domains.begin(),
+                                left_transform.domains.begin(),
+                                number_of_domains, templates, partition,
+                                substitution, values);
+      });
+
   std::vector<CospanMorphism> domains;
+  std::vector<std::size_t> positions(values.size(), 0);
   domains.reserve(number_of_domains);
-  add_substituted_domains(domains, start_cospan, start_transform,
-                          number_of_domains, unification, substitutions);
-  return std::move(domains);
+  add_merged_domains(domains, left_cospan.domains.begin(),
+                     left_transform.domains.begin(), number_of_domains, values,
+                     positions);
+  auto bounds = morphism_bounds(domains);
+  auto counts = shared_count(bounds);
+  return {std::move(domains), std::move(substitution), std::move(bounds),
+          std::move(counts)};
 }
 
-CospanMorphism get_zipped_substitution(
-    CospanMorphism const &left_morphism, CospanMorphism const &right_morphism,
-    TypeConstructor const &left_type, TypeConstructor const &right_type,
-    Unification const &unification, VariableSubstitution &left_substitution,
-    VariableSubstitution &right_substitution) {
-  auto const left = cospan_substitution(left_substitution, unification.left,
-                                        left_morphism, left_type);
-  auto const right = cospan_substitution(right_substitution, unification.right,
-                                         right_morphism, right_type);
-  return zip_cospan_morphisms(left, right);
-}
-
-std::vector<std::size_t>
-maximum_counts(VariableSubstitution const &substitution) {
-  std::vector<std::size_t> count(substitution[0].maximum.size(), 0);
-  for (auto &&cospan_substitution : substitution) {
-    auto &maximums = cospan_substitution.maximum;
-    for (auto i = 0u; i < maximums.size(); ++i) {
-      auto &current = count[i];
-      current = std::max(current, maximums[i]);
-    }
-  }
-  return std::move(count);
+void compose_right_in_parallel(std::vector<CospanMorphism> &domains,
+                               CospanStructure const &left_cospan,
+                               CospanStructure const &right_cospan,
+                               NaturalTransformation const &left_transform,
+                               NaturalTransformation const &right_transform,
+                               CompositionTemplates const &templates,
+                               VariableSubstitution &left_substitution,
+                               VariableSubstitution &right_substitution) {
+  auto const number_of_domains = right_transform.domains.size() - 1;
+  SubstitutedValues left_values(left_substitution.variables.size());
+  SubstitutedValues right_values(right_substitution.variables.size());
+
+  substitute_in_partitions(
+      std::max(left_values.size(), right_values.size()),
+      [&](SubstitutionPartition partition) {
+        add_partitioned_domains(right_cospan.domains.begin() + 1,
+                                right_transform.domains.begin() + 1,
+                                number_of_domains, templates.right, partition,
+                                right_substitution, right_values);
+        partitioned_cospan_substitution(
+            left_substitution, templates.left, partition,
+            left_cospan.domains.back(), left_transform.domains.back(),
+            left_values);
+        partitioned_cospan_substitution(
+            right_substitution, templates.right, partition,
+            right_cospan.domains.front(), right_transform.domains.front(),
+            right_values);
+      });
+
+  std::vector<std::size_t> left_positions(left_values.size(), 0);
+  std::vector<std::size_t> right_positions(right_values.size(), 0);
+  auto const middle = domains.size();
+  domains.emplace_back(CospanMorphism{});
+  add_merged_domains(domains, right_cospan.domains.begin() + 1,
+                     right_transform.domains.begin() + 1, number_of_domains,
+                     right_values, right_positions);
+
+  domains[middle] = zip_cospan_morphisms(
+      merge_cospan_substitution(left_values, left_positions,
+                                left_cospan.domains.back(),
+                                left_transform.domains.back()),
+      merge_cospan_substitution(right_values, right_positions,
+                                right_cospan.domains.front(),
+                                right_transform.domains.front()));
 }
 
-std::size_t get_max(std::vector<std::size_t> const &vec) {
-  return *std::max_element(vec.begin(), vec.end());
+std::optional<CospanMismatch>
+compose_right(std::vector<CospanMorphism> &domains,
+              CospanStructure const &left_cospan,
+              CospanStructure const &right_cospan,
+              NaturalTransformation const &left_transform,
+              NaturalTransformation const &right_transform,
+              CompositionTemplates const &templates,
+              VariableSubstitution &left_substitution,
+              VariableSubstitution &right_substitution) {
+  domains.emplace_back(CospanMorphism{});
+
+  if (auto mismatch = add_substituted_domains(
+          domains, right_cospan.domains.begin() + 1,
+          right_transform.domains.begin() + 1,
+          right_transform.domains.size() - 1, templates.right,
+          right_substitution))
+    return mismatch;
+
+  return add_checked_domain(
+      domains, left_cospan.domains.size() - 1,
+      get_zipped_substitution(
+          left_cospan.domains.back(), right_cospan.domains.front(),
+          left_transform.domains.back(), right_transform.domains.front(),
+          templates, left_substitution, right_substitution));
+}
+
+Checked<LeftComposition>
+try_compose_left_cospan(CospanStructure const &left_cospan,
+                        NaturalTransformation const &left_transform,
+                        SubstitutionTemplates const &templates,
+                        std::size_t identifiers) {
+  auto substitution = create_empty_substitution(left_transform, identifiers);
+  std::vector<CospanMorphism> domains;
+  domains.reserve(left_cospan.domains.size() - 1);
+
+  if (auto mismatch = add_substituted_domains(
+          domains, left_cospan.domains.begin(),
+          left_transform.domains.begin(), left_cospan.domains.size() - 1,
+          templates, substitution))
+    return std::move(*mismatch);
+
+  auto bounds = morphism_bounds(domains);
+  auto counts = shared_count(bounds);
+  return LeftComposition{std::move(domains), std::move(substitution),
+                         std::move(bounds), std::move(counts)};
+}
+
+CompositionResult
+finish_composition(LeftComposition const &left_composition,
+                   std::vector<CospanMorphism> &&domains,
+                   VariableSubstitution const &right_substitution) {
+  auto bounds = left_composition.bounds;
+  bounds.reserve(domains.size());
+  for (auto i = bounds.size(); i < domains.size(); ++i)
+    bounds.emplace_back(morphism_bounds(domains[i]));
+
+  // Only the zipped middle domain and the right domains are new, so the
+  // counts between the reused left domains are kept as they are.
+  auto min_max_identifiers = left_composition.shared_counts;
+  min_max_identifiers.resize(bounds.size(), {0, 0});
+  for (auto i = left_composition.bounds.size(); i < bounds.size(); ++i)
+    update_shared_count(min_max_identifiers, bounds, i);
+
+  auto max_counts = maximum_counts(right_substitution);
+  auto max_count = get_max(max_counts);
+  return {{std::move(domains), std::move(min_max_identifiers), 0, max_count},
+          std::move(max_counts)};
+}
+
+Checked<CompositionResult>
+try_compose_right_cospan(LeftComposition const &left_composition,
+                         CospanStructure const &left_cospan,
+                         CospanStructure const &right_cospan,
+                         NaturalTransformation const &left_transform,
+                         NaturalTransformation const &right_transform,
+                         CompositionTemplates const &templates) {
+  auto left_substitution = left_composition.substitution;
+  auto domains = left_composition.domains;
+
+  auto right_substitution = create_empty_substitution(
+      right_transform, maximum_counts(left_substitution));
+
+  domains.reserve(domains.size() + right_transform.domains.size());
+  if (auto mismatch = compose_right(domains, left_cospan, right_cospan,
+                                    left_transform, right_transform, templates,
+                                    left_substitution, right_substitution))
+    return std::move(*mismatch);
+  return finish_composition(left_composition, std::move(domains),
+                            right_substitution);
 }
 
 } // namespace
@@ -69,40 +275,110 @@ std::size_t get_max(std::vector<std::size_t> const &vec) {
 namespace Project {
 namespace Naturality {
 
-CompositionResult compose_cospans(CospanStructure const &left_cospan,
+CompositionTemplates
+create_composition_templates(Types::Unification const &unification) {
+  return {create_substitution_templates(unification.left),
+          create_substitution_templates(unification.right)};
+}
+
+LeftComposition compose_left_cospan(CospanStructure const &left_cospan,
+                                    NaturalTransformation const &left_transform,
+                                    CompositionTemplates const &templates,
+                                    std::size_t identifiers, bool parallel) {
+  if (parallel)
+    return compose_left_in_parallel(left_cospan, left_transform,
+                                    templates.left, identifiers);
+  return get_checked(try_compose_left_cospan(left_cospan, left_transform,
+                                             templates.left, identifiers));
+}
+
+CompositionResult compose_cospans(LeftComposition const &left_composition,
+                                  CospanStructure const &left_cospan,
                                   CospanStructure const &right_cospan,
                                   NaturalTransformation const &left_transform,
                                   NaturalTransformation const &right_transform,
-                                  Types::Unification const &unification,
-                                  std::size_t identifiers) {
-  auto left_substitution =
-      create_empty_substitution(left_cospan, left_transform, identifiers);
+                                  CompositionTemplates const &templates,
+                                  bool parallel) {
+  if (!parallel)
+    return get_checked(try_compose_right_cospan(
+        left_composition, left_cospan, right_cospan, left_transform,
+        right_transform, templates));
 
-  auto domains = get_substituted_domains(
-      left_cospan.domains.begin(), left_transform.domains.begin(),
-      left_cospan.domains.size() - 1, unification.left, left_substitution);
+  auto left_substitution = left_composition.substitution;
+  auto domains = left_composition.domains;
 
   auto right_substitution = create_empty_substitution(
-      right_cospan, right_transform, maximum_counts(left_substitution));
+      right_transform, maximum_counts(left_substitution));
 
-  domains.reserve(right_transform.domains.size());
-  domains.emplace_back(CospanMorphism{});
+  domains.reserve(domains.size() + right_transform.domains.size());
+  compose_right_in_parallel(domains, left_cospan, right_cospan, left_transform,
+                            right_transform, templates, left_substitution,
+                            right_substitution);
+  return finish_composition(left_composition, std::move(domains),
+                            right_substitution);
+}
 
-  add_substituted_domains(domains, right_cospan.domains.begin() + 1,
-                          right_transform.domains.begin() + 1,
-                          right_transform.domains.size() - 1, unification.right,
-                          right_substitution);
+CompositionResult compose_cospans(CospanStructure const &left_cospan,
+                                  CospanStructure const &right_cospan,
+                                  NaturalTransformation const &left_transform,
+                                  NaturalTransformation const &right_transform,
+                                  CompositionTemplates const &templates,
+                                  std::size_t identifiers, bool parallel) {
+  return compose_cospans(compose_left_cospan(left_cospan, left_transform,
+                                             templates, identifiers, parallel),
+                         left_cospan, right_cospan, left_transform,
+                         right_transform, templates, parallel);
+}
 
-  domains[left_cospan.domains.size() - 1] = get_zipped_substitution(
-      left_cospan.domains.back(), right_cospan.domains.front(),
-      left_transform.domains.back(), right_transform.domains.front(),
-      unification, left_substitution, right_substitution);
+Checked<CompositionResult>
+try_compose_cospans(CospanStructure const &left_cospan,
+                    CospanStructure const &right_cospan,
+                    NaturalTransformation const &left_transform,
+                    NaturalTransformation const &right_transform,
+                    CompositionTemplates const &templates,
+                    std::size_t identifiers) {
+  auto left_composition = try_compose_left_cospan(left_cospan, left_transform,
+                                                  templates.left, identifiers);
+  if (auto mismatch = std::get_if<CospanMismatch>(&left_composition))
+    return std::move(*mismatch);
+  return try_compose_right_cospan(std::get<LeftComposition>(left_composition),
+                                  left_cospan, right_cospan, left_transform,
+                                  right_transform, templates);
+}
 
-  auto min_max_identifiers = shared_count(domains);
-  auto max_counts = maximum_counts(right_substitution);
-  auto max_count = get_max(max_counts);
-  return {{std::move(domains), std::move(min_max_identifiers), 0, max_count},
-          std::move(max_counts)};
+CompositionResult compose_cospans(CospanStructure const &left_cospan,
+                                  CospanStructure const &right_cospan,
+                                  NaturalTransformation const &left_transform,
+                                  NaturalTransformation const &right_transform,
+                                  Types::Unification const &unification,
+                                  std::size_t identifiers) {
+  return compose_cospans(left_cospan, right_cospan, left_transform,
+                         right_transform,
+                         create_composition_templates(unification),
+                         identifiers);
+}
+
+std::vector<Checked<CompositionResult>>
+compose_cospans(CospanPairs const &cospans,
+                NaturalTransformation const &left_transform,
+                NaturalTransformation const &right_transform,
+                Types::Unification const &unification, std::size_t identifiers,
+                bool parallel) {
+  auto const templates = create_composition_templates(unification);
+  std::vector<Checked<CompositionResult>> results(cospans.size());
+  auto const compose = [&](std::size_t i) {
+    results[i] =
+        try_compose_cospans(cospans[i].first, cospans[i].second,
+                            left_transform, right_transform, templates,
+                            identifiers);
+  };
+
+  if (parallel)
+    parallel_for(cospans.size(), compose);
+  else
+    for (auto i = 0u; i < cospans.size(); ++i)
+      compose(i);
+  return std::move(results);
 }
 
 } // namespace Naturality
@@ -0,0 +1,159 @@
+#include "naturality/cospan_enumeration.hpp"
+#include "naturality/cospan_shared_count.hpp"
+#include "naturality/parallel_for.hpp"
+#include "naturality/unify_cospan_with_type.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <thread>
+
+namespace {
+
+using namespace Project::Naturality;
+using namespace Project::Types;
+
+constexpr std::size_t tasks_per_worker = 8;
+
+std::vector<std::size_t>
+next_fresh_values(std::vector<std::size_t> const &identifiers,
+                  std::vector<std::size_t> const &values,
+                  std::size_t number_of_identifiers) {
+  std::vector<std::size_t> counts(number_of_identifiers, 0);
+  std::vector<std::size_t> fresh;
+  fresh.reserve(values.size());
+
+  for (auto i = 0u; i < values.size(); ++i) {
+    auto &count = counts[identifiers[i]];
+    fresh.emplace_back(count);
+    count = std::max(count, values[i] + 1);
+  }
+  return std::move(fresh);
+}
+
+bool next_values(std::vector<std::size_t> const &identifiers,
+                 std::vector<std::size_t> &values, std::size_t fixed,
+                 std::size_t maximum_values,
+                 std::size_t number_of_identifiers) {
+  auto const fresh =
+      next_fresh_values(identifiers, values, number_of_identifiers);
+
+  for (auto i = values.size(); i > fixed; --i) {
+    auto &value = values[i - 1];
+    if (value < std::min(fresh[i - 1], maximum_values - 1)) {
+      ++value;
+      std::fill(values.begin() + i, values.end(), 0);
+      return true;
+    }
+  }
+  return false;
+}
+
+std::size_t
+total_number_of_identifiers(std::vector<std::size_t> const &values) {
+  auto const maximum = std::max_element(values.begin(), values.end());
+  return maximum == values.end() ? 1 : *maximum + 1;
+}
+
+std::vector<std::size_t>
+value_identifiers(NaturalTransformation const &transformation) {
+  auto cospan = create_default_cospan(transformation.domains);
+  return cospan_value_identifiers(transformation, cospan);
+}
+
+std::vector<std::vector<std::size_t>>
+enumerate_prefixes(NaturalTransformation const &transformation,
+                   std::size_t maximum_values) {
+  auto const identifiers = value_identifiers(transformation);
+  auto const hardware = std::max(1u, std::thread::hardware_concurrency());
+  auto const number_of_identifiers = transformation.symbols.size();
+  std::vector<std::vector<std::size_t>> prefixes{{}};
+
+  if (maximum_values == 0)
+    return std::move(prefixes);
+
+  for (auto length = 1u; length <= identifiers.size() &&
+                         prefixes.size() < tasks_per_worker * hardware;
+       ++length) {
+    prefixes.clear();
+    std::vector<std::size_t> values(length, 0);
+    do
+      prefixes.emplace_back(values);
+    while (next_values(identifiers, values, 0, maximum_values,
+                       number_of_identifiers));
+  }
+  return std::move(prefixes);
+}
+
+} // namespace
+
+namespace Project {
+namespace Naturality {
+
+CospanEnumerator::CospanEnumerator(NaturalTransformation const &transformation,
+                                   std::size_t maximum_values)
+    : CospanEnumerator(transformation, maximum_values, {}) {}
+
+CospanEnumerator::CospanEnumerator(NaturalTransformation const &transformation,
+                                   std::size_t maximum_values,
+                                   std::vector<std::size_t> const &prefix)
+    : m_transformation(transformation),
+      m_cospan(create_default_cospan(transformation.domains)),
+      m_identifiers(cospan_value_identifiers(m_transformation, m_cospan)),
+      m_values(prefix), m_fixed(prefix.size()),
+      m_maximum_values(maximum_values), m_started(false),
+      m_finished(maximum_values == 0 && !m_identifiers.empty()) {
+  if (m_fixed > m_identifiers.size())
+    throw std::runtime_error("enumeration prefix exceeds cospan values");
+  m_values.resize(m_identifiers.size(), 0);
+}
+
+std::optional<CospanStructure> CospanEnumerator::next() {
+  if (m_finished)
+    return std::nullopt;
+
+  if (m_started && !next_values(m_identifiers, m_values, m_fixed,
+                                m_maximum_values,
+                                m_transformation.symbols.size())) {
+    m_finished = true;
+    return std::nullopt;
+  }
+  m_started = true;
+
+  auto cospan = m_cospan;
+  assign_cospan_values(m_transformation, cospan, m_values);
+  cospan.shared_counts = shared_count(cospan.domains);
+  cospan.total_number_of_identifiers = total_number_of_identifiers(m_values);
+  return std::move(cospan);
+}
+
+std::vector<CospanStructure>
+enumerate_cospans(NaturalTransformation const &transformation,
+                  std::size_t maximum_values, CospanPredicate const &predicate,
+                  bool parallel) {
+  auto const prefixes =
+      parallel ? enumerate_prefixes(transformation, maximum_values)
+               : std::vector<std::vector<std::size_t>>{{}};
+  std::vector<std::vector<CospanStructure>> found(prefixes.size());
+
+  auto const search = [&](std::size_t index) {
+    CospanEnumerator enumerator(transformation, maximum_values,
+                                prefixes[index]);
+    while (auto cospan = enumerator.next()) {
+      if (predicate(*cospan))
+        found[index].emplace_back(std::move(*cospan));
+    }
+  };
+
+  if (parallel)
+    parallel_for(prefixes.size(), search);
+  else
+    search(0);
+
+  std::vector<CospanStructure> cospans;
+  for (auto &&partition : found)
+    std::move(partition.begin(), partition.end(), std::back_inserter(cospans));
+  return std::move(cospans);
+}
+
+} // namespace Naturality
+} // namespace Project
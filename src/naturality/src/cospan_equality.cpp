@@ -134,6 +134,47 @@ bool is_equal_types(CospanMorphism::Type const &left,
   return std::visit(_is_equal_types, left, right);
 }
 
+std::size_t hash_combine(std::size_t seed, std::size_t value) {
+  return seed ^ (value + 0x9E3779B97F4A7C15ull + (seed << 6) + (seed >> 2));
+}
+
+std::size_t hash_type(CospanMorphism::Type const &);
+
+std::size_t hash_morphism(CospanMorphism const &morphism) {
+  auto const &nested = extract_nested(morphism);
+  if (nested.map.size() == 1)
+    return hash_type(nested.map[0].type);
+
+  auto hash = hash_combine(3, nested.map.size());
+  for (auto &&mapped : nested.map) {
+    hash = hash_combine(hash, static_cast<std::size_t>(mapped.variance));
+    hash = hash_combine(hash, hash_type(mapped.type));
+  }
+  return hash;
+}
+
+struct HashType {
+
+  std::size_t operator()(std::size_t value) const {
+    return hash_combine(0, value);
+  }
+
+  std::size_t operator()(CospanMorphism::PairType const &pair) const {
+    return hash_combine(hash_combine(1, pair.first), pair.second);
+  }
+
+  std::size_t operator()(EmptyType) const { return 2; }
+
+  std::size_t operator()(CospanMorphism const &morphism) const {
+    return hash_morphism(morphism);
+  }
+
+} _hash_type;
+
+std::size_t hash_type(CospanMorphism::Type const &type) {
+  return std::visit(_hash_type, type);
+}
+
 } // namespace
 
 namespace Project {
@@ -155,6 +196,17 @@ CospanMorphism::PairType const *get_pair(CospanMorphism const &morphism) {
   return extract_type<CospanMorphism::PairType>(extract_nested(morphism));
 }
 
+std::size_t hash_value(CospanMorphism const &morphism) {
+  return hash_morphism(morphism);
+}
+
+std::size_t hash_value(CospanStructure const &cospan) {
+  auto hash = hash_combine(4, cospan.domains.size());
+  for (auto &&domain : cospan.domains)
+    hash = hash_combine(hash, hash_morphism(domain));
+  return hash;
+}
+
 bool is_equal(CospanMorphism const &left, CospanMorphism const &right) {
   return is_equal_types(left, right);
 }
@@ -1,116 +1,53 @@
 #include "naturality/cospan_shared_count.hpp"
 
+#include <algorithm>
+#include <functional>
 #include <limits>
-#include <numeric>
-
-#include "naturality/cospan_to_string.hpp"
 
 namespace {
 
 using namespace Project::Naturality;
 
-std::pair<std::size_t, std::size_t>
-right_min_max_in_cospan(CospanMorphism::Type const &);
-
-std::pair<std::size_t, std::size_t>
-right_min_max_in_morphism(CospanMorphism const &morphism) {
-  auto const &types = morphism.map;
-  auto min_max = right_min_max_in_cospan(types.front().type);
-
-  for (auto type = types.begin() + 1; type < types.end(); ++type) {
-    auto const [min, max] = right_min_max_in_cospan(type->type);
-    min_max.first = std::min(min_max.first, min);
-    min_max.second = std::max(min_max.second, max);
-  }
-  return min_max;
+void include_value(std::pair<std::size_t, std::size_t> &bounds,
+                   std::size_t value) {
+  bounds.first = std::min(bounds.first, value);
+  bounds.second = std::max(bounds.second, value);
 }
 
-struct RightMinMaxInCospan {
+void add_bounds(MorphismBounds &, CospanMorphism::Type const &);
 
-  std::pair<std::size_t, std::size_t> operator()(std::size_t minimum,
-                                                 std::size_t maximum,
-                                                 std::size_t identifier) const {
-    return {std::min(minimum, identifier), std::max(maximum, identifier)};
-  }
+struct AddBounds {
 
-  std::pair<std::size_t, std::size_t>
-  operator()(std::size_t minimum, std::size_t maximum,
-             CospanMorphism::PairType const &pair) const {
-    return {std::min(minimum, pair.second), std::max(maximum, pair.second)};
+  void operator()(MorphismBounds &bounds, std::size_t identifier) const {
+    include_value(bounds.left, identifier);
+    include_value(bounds.right, identifier);
   }
 
-  std::pair<std::size_t, std::size_t>
-  operator()(std::size_t minimum, std::size_t maximum,
-             CospanMorphism const &morphism) const {
-    auto [min, max] = right_min_max_in_morphism(morphism);
-    return {std::min(minimum, min), std::max(maximum, max)};
+  void operator()(MorphismBounds &bounds,
+                  CospanMorphism::PairType const &pair) const {
+    include_value(bounds.left, pair.first);
+    include_value(bounds.right, pair.second);
   }
 
-  std::pair<std::size_t, std::size_t>
-  operator()(std::size_t minimum, std::size_t maximum, EmptyType) const {
-    return {minimum, maximum};
+  void operator()(MorphismBounds &bounds,
+                  CospanMorphism const &morphism) const {
+    for (auto &&type : morphism.map)
+      add_bounds(bounds, type.type);
   }
 
-} _right_min_max_in_cospan;
+  void operator()(MorphismBounds &, EmptyType) const {}
 
-std::pair<std::size_t, std::size_t>
-right_min_max_in_cospan(CospanMorphism::Type const &type) {
-  return std::visit(std::bind(_right_min_max_in_cospan,
-                              std::numeric_limits<std::size_t>::max(), 0,
-                              std::placeholders::_1),
-                    type);
-}
-
-std::pair<std::size_t, std::size_t>
-left_min_max_in_cospan(CospanMorphism::Type const &);
+} _add_bounds;
 
-std::pair<std::size_t, std::size_t>
-left_min_max_in_morphism(CospanMorphism const &morphism) {
-  auto const &types = morphism.map;
-  auto min_max = left_min_max_in_cospan(types.front().type);
-
-  for (auto type = types.begin() + 1; type < types.end(); ++type) {
-    auto const [min, max] = left_min_max_in_cospan(type->type);
-    min_max.first = std::min(min_max.first, min);
-    min_max.second = std::max(min_max.second, max);
-  }
-  return min_max;
+void add_bounds(MorphismBounds &bounds, CospanMorphism::Type const &type) {
+  std::visit(std::bind(_add_bounds, std::ref(bounds), std::placeholders::_1),
+             type);
 }
 
-struct LeftMinMaxInCospan {
-
-  std::pair<std::size_t, std::size_t> operator()(std::size_t minimum,
-                                                 std::size_t maximum,
-                                                 std::size_t identifier) const {
-    return {std::min(minimum, identifier), std::max(maximum, identifier)};
-  }
-
-  std::pair<std::size_t, std::size_t>
-  operator()(std::size_t minimum, std::size_t maximum,
-             CospanMorphism::PairType const &pair) const {
-    return {std::min(minimum, pair.first), std::max(maximum, pair.first)};
-  }
-
-  std::pair<std::size_t, std::size_t>
-  operator()(std::size_t minimum, std::size_t maximum,
-             CospanMorphism const &morphism) const {
-    auto [min, max] = left_min_max_in_morphism(morphism);
-    return {std::min(minimum, min), std::max(maximum, max)};
-  }
-
-  std::pair<std::size_t, std::size_t>
-  operator()(std::size_t minimum, std::size_t maximum, EmptyType) const {
-    return {minimum, maximum};
-  }
-
-} _left_min_max_in_cospan;
-
-std::pair<std::size_t, std::size_t>
-left_min_max_in_cospan(CospanMorphism::Type const &type) {
-  return std::visit(std::bind(_left_min_max_in_cospan,
-                              std::numeric_limits<std::size_t>::max(), 0,
-                              std::placeholders::_1),
-                    type);
+std::size_t shared_between(MorphismBounds const &first,
+                           MorphismBounds const &second) {
+  return 1 + (std::max(first.right.second, second.left.second) -
+              std::min(first.right.first, second.left.first));
 }
 
 } // namespace
@@ -118,26 +55,63 @@ left_min_max_in_cospan(CospanMorphism::Type const &type) {
 namespace Project {
 namespace Naturality {
 
+MorphismBounds create_empty_bounds() {
+  auto const maximum = std::numeric_limits<std::size_t>::max();
+  return {{maximum, 0}, {maximum, 0}};
+}
+
+MorphismBounds morphism_bounds(CospanMorphism const &morphism) {
+  auto bounds = create_empty_bounds();
+  _add_bounds(bounds, morphism);
+  return bounds;
+}
+
+std::vector<MorphismBounds>
+morphism_bounds(std::vector<CospanMorphism> const &morphisms) {
+  std::vector<MorphismBounds> bounds;
+  bounds.reserve(morphisms.size());
+  for (auto &&morphism : morphisms)
+    bounds.emplace_back(morphism_bounds(morphism));
+  return std::move(bounds);
+}
+
 std::vector<std::pair<std::size_t, std::size_t>>
-shared_count(std::vector<CospanMorphism> const &morphisms) {
-  if (morphisms.size() <= 1)
+shared_count(std::vector<MorphismBounds> const &bounds) {
+  if (bounds.size() <= 1)
     return {};
 
   std::vector<std::pair<std::size_t, std::size_t>> count_pairs;
-  count_pairs.reserve(morphisms.size() - 1);
+  count_pairs.reserve(bounds.size());
   count_pairs.emplace_back(0, 0);
 
-  for (auto i = 0u; i < morphisms.size() - 1; ++i) {
-    auto const [first_min, first_max] = right_min_max_in_morphism(morphisms[i]);
-    auto const [second_min, second_max] =
-        left_min_max_in_morphism(morphisms[i + 1]);
-    auto const shared =
-        1 + (std::max(first_max, second_max) - std::min(first_min, second_min));
+  for (auto i = 0u; i < bounds.size() - 1; ++i) {
+    auto const shared = shared_between(bounds[i], bounds[i + 1]);
     count_pairs[i].second = shared;
     count_pairs.emplace_back(shared, 0);
   }
   return std::move(count_pairs);
 }
 
+std::vector<std::pair<std::size_t, std::size_t>>
+shared_count(std::vector<CospanMorphism> const &morphisms) {
+  return shared_count(morphism_bounds(morphisms));
+}
+
+void update_shared_count(
+    std::vector<std::pair<std::size_t, std::size_t>> &count_pairs,
+    std::vector<MorphismBounds> const &bounds, std::size_t index) {
+  if (index > 0) {
+    auto const shared = shared_between(bounds[index - 1], bounds[index]);
+    count_pairs[index - 1].second = shared;
+    count_pairs[index].first = shared;
+  }
+
+  if (index + 1 < bounds.size()) {
+    auto const shared = shared_between(bounds[index], bounds[index + 1]);
+    count_pairs[index].second = shared;
+    count_pairs[index + 1].first = shared;
+  }
+}
+
 } // namespace Naturality
 } // namespace Project
@@ -3,278 +3,410 @@
 #include "naturality/cospan_zip.hpp"
 #include "polymorphic_types/type_equality.hpp"
 
+#include <algorithm>
+#include <functional>
+#include <string>
+
 namespace {
 
 using namespace Project::Naturality;
 using namespace Project::Types;
 
-CospanMorphism::Type create_new_cospan_type(std::vector<std::size_t> &,
-                                            TypeConstructor::Type const &);
+CospanMorphism::Type
+create_substitution_template(std::vector<std::optional<std::size_t>> &,
+                             TypeConstructor::Type const &);
 
-std::vector<CospanMorphism::MappedType>
-create_new_cospan_type(std::vector<std::size_t> &index,
-                       TypeConstructor::ConstructorType const &constructor) {
+std::vector<CospanMorphism::MappedType> create_substitution_template(
+    std::vector<std::optional<std::size_t>> &identifiers,
+    TypeConstructor::ConstructorType const &constructor) {
   std::vector<CospanMorphism::MappedType> morphism;
   morphism.reserve(constructor.size());
   for (auto &&type : constructor)
     morphism.emplace_back(CospanMorphism::MappedType{
-        create_new_cospan_type(index, type.type), type.variance});
+        create_substitution_template(identifiers, type.type), type.variance});
   return std::move(morphism);
 }
 
-CospanMorphism create_new_cospan_type(std::vector<std::size_t> &index,
-                                      FunctorTypeConstructor const &functor) {
-  return {create_new_cospan_type(index, functor.type)};
+CospanMorphism create_substitution_template(
+    std::vector<std::optional<std::size_t>> &identifiers,
+    FunctorTypeConstructor const &functor) {
+  return {create_substitution_template(identifiers, functor.type)};
 }
 
-CospanMorphism create_new_cospan_type(std::vector<std::size_t> &index,
-                                      TypeConstructor const &constructor) {
-  return {create_new_cospan_type(index, constructor.type)};
+CospanMorphism create_substitution_template(
+    std::vector<std::optional<std::size_t>> &identifiers,
+    TypeConstructor const &constructor) {
+  return {create_substitution_template(identifiers, constructor.type)};
 }
 
-struct CreateNewCospanType {
-  CospanMorphism::Type operator()(std::vector<std::size_t> &index,
-                                  std::size_t identifier) const {
-    return index[identifier]++;
+struct CreateSubstitutionTemplate {
+  CospanMorphism::Type
+  operator()(std::vector<std::optional<std::size_t>> &identifiers,
+             std::size_t identifier) const {
+    identifiers.emplace_back(identifier);
+    return identifiers.size() - 1;
   }
 
-  CospanMorphism::Type operator()(std::vector<std::size_t> &, FreeType) const {
-    return 0;
+  CospanMorphism::Type
+  operator()(std::vector<std::optional<std::size_t>> &identifiers,
+             FreeType) const {
+    identifiers.emplace_back(std::nullopt);
+    return identifiers.size() - 1;
   }
 
-  CospanMorphism::Type operator()(std::vector<std::size_t> &, MonoType) const {
-    return 0;
+  CospanMorphism::Type
+  operator()(std::vector<std::optional<std::size_t>> &identifiers,
+             MonoType) const {
+    identifiers.emplace_back(std::nullopt);
+    return identifiers.size() - 1;
   }
 
-  CospanMorphism::Type operator()(std::vector<std::size_t> &index,
-                                  FunctorTypeConstructor const &functor) const {
-    return create_new_cospan_type(index, functor);
+  CospanMorphism::Type
+  operator()(std::vector<std::optional<std::size_t>> &identifiers,
+             FunctorTypeConstructor const &functor) const {
+    return create_substitution_template(identifiers, functor);
   }
 
-  CospanMorphism::Type operator()(std::vector<std::size_t> &index,
-                                  TypeConstructor const &constructor) const {
-    return create_new_cospan_type(index, constructor);
+  CospanMorphism::Type
+  operator()(std::vector<std::optional<std::size_t>> &identifiers,
+             TypeConstructor const &constructor) const {
+    return create_substitution_template(identifiers, constructor);
   }
 
-} _create_new_cospan_type;
+} _create_substitution_template;
 
-CospanMorphism::Type create_new_cospan_type(std::vector<std::size_t> &index,
-                                            TypeConstructor::Type const &type) {
-  return std::visit(std::bind(_create_new_cospan_type, std::ref(index),
-                              std::placeholders::_1),
+CospanMorphism::Type create_substitution_template(
+    std::vector<std::optional<std::size_t>> &identifiers,
+    TypeConstructor::Type const &type) {
+  return std::visit(std::bind(_create_substitution_template,
+                              std::ref(identifiers), std::placeholders::_1),
                     type);
 }
 
-CospanMorphism::Type apply_unification_to_type(
-    VariableSubstitution &,
-    std::vector<std::optional<TypeConstructor::Type>> const &,
-    CospanMorphism::Type const &, TypeConstructor::Type const &);
+SubstitutionTemplate
+create_substitution_template(TypeConstructor::Type const &type) {
+  SubstitutionTemplate substitution;
+  substitution.type =
+      create_substitution_template(substitution.identifiers, type);
+  return std::move(substitution);
+}
+
+std::size_t hash_key(std::size_t key) {
+  auto const hash = key * 0x9E3779B97F4A7C15ull;
+  return hash ^ (hash >> 32);
+}
 
-template <typename T>
-CospanMorphism::Type apply_unification_to_type_with(
-    VariableSubstitution &,
-    std::vector<std::optional<TypeConstructor::Type>> const &, T const &,
-    TypeConstructor::Type const &);
+std::size_t next_count(CospanSubstitutions &substitution,
+                       std::vector<std::size_t> const &counts,
+                       std::size_t identifier) {
+  for (auto &&count : substitution.maximum) {
+    if (count.first == identifier)
+      return count.second++;
+  }
+  substitution.maximum.emplace_back(identifier, counts[identifier] + 1);
+  return counts[identifier];
+}
 
-template <typename T>
-CospanMorphism::Type apply_unification_to_type_with(
-    VariableSubstitution &,
-    std::vector<std::optional<TypeConstructor::Type>> const &,
-    CospanMorphism::Type const &, T const &);
+CospanMorphism::Type
+instantiate_template(CospanSubstitutions &, std::vector<std::size_t> const &,
+                     std::vector<std::optional<std::size_t>> const &,
+                     CospanMorphism::Type const &);
 
-CospanMorphism::Type add_cospan_substitution(
-    VariableSubstitution &substitutions,
-    std::vector<std::optional<TypeConstructor::Type>> const &unification,
-    std::size_t cospan_value, std::size_t identifier) {
-  auto &cospan_substitution = substitutions[identifier];
+struct InstantiateTemplate {
+  CospanMorphism::Type
+  operator()(CospanSubstitutions &substitution,
+             std::vector<std::size_t> const &counts,
+             std::vector<std::optional<std::size_t>> const &identifiers,
+             std::size_t position) const {
+    if (auto const &identifier = identifiers[position])
+      return next_count(substitution, counts, *identifier);
+    return std::size_t{0};
+  }
 
-  if (auto substitution = cospan_substitution.values[cospan_value])
-    return std::move(*substitution);
-  else if (auto type_substitution = unification[identifier])
-    return *(cospan_substitution.values[cospan_value] = create_new_cospan_type(
-                 cospan_substitution.maximum, *type_substitution));
+  CospanMorphism::Type
+  operator()(CospanSubstitutions &substitution,
+             std::vector<std::size_t> const &counts,
+             std::vector<std::optional<std::size_t>> const &identifiers,
+             CospanMorphism const &morphism) const {
+    CospanMorphism instantiated;
+    instantiated.map.reserve(morphism.map.size());
+    for (auto &&type : morphism.map)
+      instantiated.map.emplace_back(CospanMorphism::MappedType{
+          instantiate_template(substitution, counts, identifiers, type.type),
+          type.variance});
+    return std::move(instantiated);
+  }
 
-  return *(cospan_substitution.values[cospan_value] =
-               cospan_substitution.maximum[identifier]++);
+  template <typename T>
+  CospanMorphism::Type
+  operator()(CospanSubstitutions &, std::vector<std::size_t> const &,
+             std::vector<std::optional<std::size_t>> const &,
+             T const &type) const {
+    return type;
+  }
+
+} _instantiate_template;
+
+CospanMorphism::Type
+instantiate_template(CospanSubstitutions &substitution,
+                     std::vector<std::size_t> const &counts,
+                     std::vector<std::optional<std::size_t>> const &identifiers,
+                     CospanMorphism::Type const &type) {
+  return std::visit(std::bind(_instantiate_template, std::ref(substitution),
+                              std::cref(counts), std::cref(identifiers),
+                              std::placeholders::_1),
+                    type);
 }
 
-CospanMorphism add_cospan_substitution(
-    VariableSubstitution &substitutions,
-    std::vector<std::optional<TypeConstructor::Type>> const &unification,
-    std::vector<CospanMorphism::MappedType> const &morphism,
-    TypeConstructor::ConstructorType const &constructor) {
+CospanMorphism::Type
+add_cospan_substitution(VariableSubstitution &substitutions,
+                        SubstitutionTemplates const &templates,
+                        std::size_t cospan_value, std::size_t identifier) {
+  auto &cospan_substitution = substitutions.variables[identifier];
+  auto &values = cospan_substitution.values;
+
+  if (auto const substitution = values.find(cospan_value))
+    return *substitution;
+  else if (auto const &type_template = templates[identifier])
+    return values.insert(
+        cospan_value,
+        instantiate_template(cospan_substitution, substitutions.counts,
+                             type_template->identifiers, type_template->type));
+
+  return values.insert(cospan_value, next_count(cospan_substitution,
+                                                substitutions.counts,
+                                                identifier));
+}
+
+struct TableSubstitution {
+  VariableSubstitution &substitutions;
+  SubstitutionTemplates const &templates;
+
+  CospanMorphism::Type operator()(std::size_t cospan_value,
+                                  std::size_t identifier) const {
+    return add_cospan_substitution(substitutions, templates, cospan_value,
+                                   identifier);
+  }
+};
+
+struct PartitionedSubstitution {
+  TableSubstitution table;
+  SubstitutionPartition partition;
+  SubstitutedValues &values;
+
+  CospanMorphism::Type operator()(std::size_t cospan_value,
+                                  std::size_t identifier) const {
+    if (identifier % partition.count == partition.index)
+      values[identifier].emplace_back(table(cospan_value, identifier));
+    return EmptyType{};
+  }
+};
+
+struct MergedSubstitution {
+  SubstitutedValues const &values;
+  std::vector<std::size_t> &positions;
+
+  CospanMorphism::Type operator()(std::size_t, std::size_t identifier) const {
+    return values[identifier][positions[identifier]++];
+  }
+};
+
+template <typename Substitute> struct SubstitutionWalk {
+  Substitute const &substitute;
+  std::vector<std::size_t> path;
+  std::string reason;
+
+  bool failed() const { return !reason.empty(); }
+
+  CospanMorphism::Type mismatch(std::string mismatch_reason) {
+    reason = std::move(mismatch_reason);
+    return EmptyType{};
+  }
+};
+
+template <typename Substitute>
+CospanMorphism::Type apply_unification_to_type(SubstitutionWalk<Substitute> &,
+                                               CospanMorphism::Type const &,
+                                               TypeConstructor::Type const &);
+
+template <typename Substitute, typename T>
+CospanMorphism::Type
+apply_unification_to_type_with(SubstitutionWalk<Substitute> &, T const &,
+                               TypeConstructor::Type const &);
+
+template <typename Substitute, typename T>
+CospanMorphism::Type
+apply_unification_to_type_with(SubstitutionWalk<Substitute> &,
+                               CospanMorphism::Type const &, T const &);
+
+template <typename Substitute>
+CospanMorphism
+add_cospan_substitution(SubstitutionWalk<Substitute> &walk,
+                        std::vector<CospanMorphism::MappedType> const &morphism,
+                        TypeConstructor::ConstructorType const &constructor) {
   CospanMorphism substituted;
   substituted.map.reserve(morphism.size());
   for (auto i = 0u; i < morphism.size(); ++i) {
     auto const &cospan_type = morphism[i];
-    auto const &substituted_type = apply_unification_to_type(
-        substitutions, unification, cospan_type.type, constructor[i].type);
-
-    substituted.map.emplace_back(
-        CospanMorphism::MappedType{substituted_type, cospan_type.variance});
+    walk.path.emplace_back(i);
+    auto substituted_type =
+        apply_unification_to_type(walk, cospan_type.type, constructor[i].type);
+    if (walk.failed())
+      return {};
+    walk.path.pop_back();
+
+    substituted.map.emplace_back(CospanMorphism::MappedType{
+        std::move(substituted_type), cospan_type.variance});
   }
   return std::move(substituted);
 }
 
-CospanMorphism::Type add_cospan_substitution(
-    VariableSubstitution &substitutions,
-    std::vector<std::optional<TypeConstructor::Type>> const &unification,
-    CospanMorphism const &morphism, TypeConstructor const &constructor) {
+template <typename Substitute>
+CospanMorphism::Type
+add_cospan_substitution(SubstitutionWalk<Substitute> &walk,
+                        CospanMorphism const &morphism,
+                        TypeConstructor const &constructor) {
   auto const &nested_morphism = get_nested(morphism);
   auto const &nested_constructor = get_nested(constructor);
   auto const constructor_size = nested_constructor.type.size();
   auto const morphism_size = nested_morphism.map.size();
 
   if (constructor_size == morphism_size)
-    return add_cospan_substitution(substitutions, unification,
-                                   nested_morphism.map,
+    return add_cospan_substitution(walk, nested_morphism.map,
                                    nested_constructor.type);
   else if (morphism_size == 1)
-    return apply_unification_to_type_with(
-        substitutions, unification, nested_morphism.map[0], nested_constructor);
+    return apply_unification_to_type_with(walk, nested_morphism.map[0],
+                                          nested_constructor);
   else if (constructor_size == 1)
-    return apply_unification_to_type_with(substitutions, unification,
-                                          nested_morphism,
+    return apply_unification_to_type_with(walk, nested_morphism,
                                           nested_constructor.type[0].type);
-  throw std::runtime_error(
+  return walk.mismatch(
       "cospan and type constructor do not match (constructor size)");
 }
 
-CospanMorphism::Type add_cospan_substitution(
-    VariableSubstitution &substitutions,
-    std::vector<std::optional<TypeConstructor::Type>> const &unification,
-    CospanMorphism const &morphism, FunctorTypeConstructor const &functor) {
+template <typename Substitute>
+CospanMorphism::Type
+add_cospan_substitution(SubstitutionWalk<Substitute> &walk,
+                        CospanMorphism const &morphism,
+                        FunctorTypeConstructor const &functor) {
   auto const &nested_morphism = get_nested(morphism);
   auto const functor_size = functor.type.size();
   auto const morphism_size = nested_morphism.map.size();
 
   if (functor_size == morphism_size)
-    return add_cospan_substitution(substitutions, unification,
-                                   nested_morphism.map, functor.type);
+    return add_cospan_substitution(walk, nested_morphism.map,
+                                   functor.type);
   else if (morphism_size == 1)
-    return apply_unification_to_type_with(substitutions, unification,
-                                          nested_morphism.map[0], functor);
+    return apply_unification_to_type_with(walk, nested_morphism.map[0],
+                                          functor);
   else if (functor_size == 1)
-    return apply_unification_to_type_with(
-        substitutions, unification, nested_morphism, functor.type[0].type);
-  throw std::runtime_error(
+    return apply_unification_to_type_with(walk, nested_morphism,
+                                          functor.type[0].type);
+  return walk.mismatch(
       "cospan and type constructor do not match (functor size)");
 }
 
 struct ApplyUnificationToType {
-  CospanMorphism::Type operator()(
-      VariableSubstitution &substitutions,
-      std::vector<std::optional<TypeConstructor::Type>> const &unification,
-      std::size_t cospan_value, std::size_t identifier) const {
-    return add_cospan_substitution(substitutions, unification, cospan_value,
-                                   identifier);
+  template <typename Substitute>
+  CospanMorphism::Type operator()(SubstitutionWalk<Substitute> &walk,
+                                  std::size_t cospan_value,
+                                  std::size_t identifier) const {
+    return walk.substitute(cospan_value, identifier);
   }
 
-  CospanMorphism::Type operator()(
-      VariableSubstitution &substitutions,
-      std::vector<std::optional<TypeConstructor::Type>> const &unification,
-      CospanMorphism::PairType const &cospan_value,
-      std::size_t identifier) const {
-    return zip_cospan_types(
-        add_cospan_substitution(substitutions, unification, cospan_value.first,
-                                identifier),
-        add_cospan_substitution(substitutions, unification, cospan_value.second,
-                                identifier));
+  template <typename Substitute>
+  CospanMorphism::Type operator()(SubstitutionWalk<Substitute> &walk,
+                                  CospanMorphism::PairType const &cospan_value,
+                                  std::size_t identifier) const {
+    auto const first = walk.substitute(cospan_value.first, identifier);
+    auto const second = walk.substitute(cospan_value.second, identifier);
+    auto zipped = try_zip_cospan_types(first, second);
+    if (auto mismatch = std::get_if<CospanMismatch>(&zipped)) {
+      walk.path.insert(walk.path.end(), mismatch->path.begin(),
+                       mismatch->path.end());
+      return walk.mismatch(std::move(mismatch->reason));
+    }
+    return std::move(std::get<CospanMorphism::Type>(zipped));
   }
 
-  CospanMorphism::Type operator()(
-      VariableSubstitution &substitutions,
-      std::vector<std::optional<TypeConstructor::Type>> const &unification,
-      CospanMorphism const &morphism,
-      TypeConstructor const &constructor) const {
-    return add_cospan_substitution(substitutions, unification, morphism,
-                                   constructor);
+  template <typename Substitute>
+  CospanMorphism::Type operator()(SubstitutionWalk<Substitute> &walk,
+                                  CospanMorphism const &morphism,
+                                  TypeConstructor const &constructor) const {
+    return add_cospan_substitution(walk, morphism, constructor);
   }
 
-  CospanMorphism::Type operator()(
-      VariableSubstitution &substitutions,
-      std::vector<std::optional<TypeConstructor::Type>> const &unification,
-      CospanMorphism const &morphism,
-      FunctorTypeConstructor const &functor) const {
-    return add_cospan_substitution(substitutions, unification, morphism,
-                                   functor);
+  template <typename Substitute>
+  CospanMorphism::Type operator()(SubstitutionWalk<Substitute> &walk,
+                                  CospanMorphism const &morphism,
+                                  FunctorTypeConstructor const &functor) const {
+    return add_cospan_substitution(walk, morphism, functor);
   }
 
-  template <typename T>
-  CospanMorphism::Type operator()(
-      VariableSubstitution &substitutions,
-      std::vector<std::optional<TypeConstructor::Type>> const &unification,
-      T const &type, FunctorTypeConstructor const &functor) const {
+  template <typename Substitute, typename T>
+  CospanMorphism::Type operator()(SubstitutionWalk<Substitute> &walk,
+                                  T const &type,
+                                  FunctorTypeConstructor const &functor) const {
     if (functor.type.size() == 1)
-      return apply_unification_to_type_with(substitutions, unification, type,
-                                            functor.type[0].type);
-    throw std::runtime_error(
-        "cospan and type constructor do not match (functor)");
+      return apply_unification_to_type_with(walk, type, functor.type[0].type);
+    return walk.mismatch("cospan and type constructor do not match (functor)");
   }
 
-  template <typename T>
-  CospanMorphism::Type operator()(
-      VariableSubstitution &substitutions,
-      std::vector<std::optional<TypeConstructor::Type>> const &unification,
-      T const &type, TypeConstructor const &constructor) const {
+  template <typename Substitute, typename T>
+  CospanMorphism::Type operator()(SubstitutionWalk<Substitute> &walk,
+                                  T const &type,
+                                  TypeConstructor const &constructor) const {
     if (constructor.type.size() == 1)
-      return apply_unification_to_type_with(substitutions, unification, type,
+      return apply_unification_to_type_with(walk, type,
                                             constructor.type[0].type);
-    throw std::runtime_error(
+    return walk.mismatch(
         "cospan and type consstructor do not match (constructor)");
   }
 
-  template <typename T>
-  CospanMorphism::Type operator()(
-      VariableSubstitution &substitutions,
-      std::vector<std::optional<TypeConstructor::Type>> const &unification,
-      CospanMorphism const &morphism, T const &type) const {
+  template <typename Substitute, typename T>
+  CospanMorphism::Type operator()(SubstitutionWalk<Substitute> &walk,
+                                  CospanMorphism const &morphism,
+                                  T const &type) const {
     if (morphism.map.size() == 1)
-      return apply_unification_to_type_with(substitutions, unification,
-                                            morphism.map[0], type);
-    throw std::runtime_error(
+      return apply_unification_to_type_with(walk, morphism.map[0], type);
+    return walk.mismatch(
         "cospan and type constructor do not match (morphism)");
   }
 
-  template <typename T, typename U>
-  CospanMorphism::Type
-  operator()(VariableSubstitution &,
-             std::vector<std::optional<TypeConstructor::Type>> const &,
-             T const &, U const &) const {
-    return 0;
+  template <typename Substitute, typename T, typename U>
+  CospanMorphism::Type operator()(SubstitutionWalk<Substitute> &, T const &,
+                                  U const &) const {
+    return std::size_t{0};
   }
 
 } _apply_unification_to_type;
 
-CospanMorphism::Type apply_unification_to_type(
-    VariableSubstitution &substitution,
-    std::vector<std::optional<TypeConstructor::Type>> const &unification,
-    CospanMorphism::Type const &cospan_type,
-    TypeConstructor::Type const &type) {
-  return std::visit(std::bind(_apply_unification_to_type,
-                              std::ref(substitution), std::cref(unification),
+template <typename Substitute>
+CospanMorphism::Type
+apply_unification_to_type(SubstitutionWalk<Substitute> &walk,
+                          CospanMorphism::Type const &cospan_type,
+                          TypeConstructor::Type const &type) {
+  return std::visit(std::bind(_apply_unification_to_type, std::ref(walk),
                               std::placeholders::_1, std::placeholders::_2),
                     cospan_type, type);
 }
 
-template <typename T>
-CospanMorphism::Type apply_unification_to_type_with(
-    VariableSubstitution &substitution,
-    std::vector<std::optional<TypeConstructor::Type>> const &unification,
-    T const &cospan_type, TypeConstructor::Type const &type) {
-  return std::visit(std::bind(_apply_unification_to_type,
-                              std::ref(substitution), std::cref(unification),
+template <typename Substitute, typename T>
+CospanMorphism::Type
+apply_unification_to_type_with(SubstitutionWalk<Substitute> &walk,
+                               T const &cospan_type,
+                               TypeConstructor::Type const &type) {
+  return std::visit(std::bind(_apply_unification_to_type, std::ref(walk),
                               std::cref(cospan_type), std::placeholders::_1),
                     type);
 }
 
-template <typename T>
-CospanMorphism::Type apply_unification_to_type_with(
-    VariableSubstitution &substitution,
-    std::vector<std::optional<TypeConstructor::Type>> const &unification,
-    CospanMorphism::Type const &cospan_type, T const &type) {
-  return std::visit(std::bind(_apply_unification_to_type,
-                              std::ref(substitution), std::cref(unification),
+template <typename Substitute, typename T>
+CospanMorphism::Type
+apply_unification_to_type_with(SubstitutionWalk<Substitute> &walk,
+                               CospanMorphism::Type const &cospan_type,
+                               T const &type) {
+  return std::visit(std::bind(_apply_unification_to_type, std::ref(walk),
                               std::placeholders::_1, std::cref(type)),
                     cospan_type);
 }
@@ -296,43 +428,167 @@ CospanMorphism move_to_cospan_morphism(CospanMorphism::Type &&type) {
   return std::visit(_move_to_cospan_morphism, std::move(type));
 }
 
+template <typename Substitute>
+Checked<CospanMorphism>
+try_add_cospan_substitution(Substitute const &substitute,
+                            CospanMorphism const &morphism,
+                            TypeConstructor const &constructor) {
+  SubstitutionWalk<Substitute> walk{substitute, {}, {}};
+  auto substituted = add_cospan_substitution(walk, morphism, constructor);
+  if (walk.failed())
+    return CospanMismatch{0, std::move(walk.path), std::move(walk.reason)};
+  return move_to_cospan_morphism(std::move(substituted));
+}
+
 } // namespace
 
 namespace Project {
 namespace Naturality {
 
+SubstitutionTemplates create_substitution_templates(
+    std::vector<std::optional<Types::TypeConstructor::Type>> const
+        &unification) {
+  SubstitutionTemplates templates;
+  templates.reserve(unification.size());
+  for (auto &&type : unification) {
+    if (type)
+      templates.emplace_back(create_substitution_template(*type));
+    else
+      templates.emplace_back(std::nullopt);
+  }
+  return std::move(templates);
+}
+
+CospanMorphism::Type
+substitute_cospan_value(VariableSubstitution &substitutions,
+                        SubstitutionTemplates const &templates,
+                        std::size_t cospan_value, std::size_t identifier) {
+  return add_cospan_substitution(substitutions, templates, cospan_value,
+                                 identifier);
+}
+
+Checked<CospanMorphism>
+try_cospan_substitution(VariableSubstitution &substitutions,
+                        SubstitutionTemplates const &templates,
+                        CospanMorphism const &morphism,
+                        Types::TypeConstructor const &constructor) {
+  return try_add_cospan_substitution(
+      TableSubstitution{substitutions, templates}, morphism, constructor);
+}
+
+CospanMorphism cospan_substitution(VariableSubstitution &substitutions,
+                                   SubstitutionTemplates const &templates,
+                                   CospanMorphism const &morphism,
+                                   Types::TypeConstructor const &constructor) {
+  return get_checked(
+      try_cospan_substitution(substitutions, templates, morphism, constructor));
+}
+
+void partitioned_cospan_substitution(VariableSubstitution &substitutions,
+                                     SubstitutionTemplates const &templates,
+                                     SubstitutionPartition partition,
+                                     CospanMorphism const &morphism,
+                                     Types::TypeConstructor const &constructor,
+                                     SubstitutedValues &values) {
+  get_checked(try_add_cospan_substitution(
+      PartitionedSubstitution{{substitutions, templates}, partition, values},
+      morphism, constructor));
+}
+
+CospanMorphism merge_cospan_substitution(
+    SubstitutedValues const &values, std::vector<std::size_t> &positions,
+    CospanMorphism const &morphism, Types::TypeConstructor const &constructor) {
+  return get_checked(try_add_cospan_substitution(
+      MergedSubstitution{values, positions}, morphism, constructor));
+}
+
 CospanMorphism cospan_substitution(
     VariableSubstitution &substitutions,
     std::vector<std::optional<Types::TypeConstructor::Type>> const &unification,
     CospanMorphism const &morphism, Types::TypeConstructor const &constructor) {
-  return move_to_cospan_morphism(add_cospan_substitution(
-      substitutions, unification, morphism, constructor));
+  return cospan_substitution(substitutions,
+                             create_substitution_templates(unification),
+                             morphism, constructor);
+}
+
+CospanMorphism::Type const *SubstitutionTable::find(std::size_t key) const {
+  if (m_slots.empty())
+    return nullptr;
+  else if (auto const index = m_slots[find_slot(key)])
+    return &m_values[index - 1];
+  return nullptr;
+}
+
+CospanMorphism::Type const &
+SubstitutionTable::insert(std::size_t key, CospanMorphism::Type &&value) {
+  if (2 * (m_values.size() + 1) > m_slots.size())
+    grow();
+
+  auto const slot = find_slot(key);
+  m_keys.emplace_back(key);
+  m_values.emplace_back(std::move(value));
+  m_slots[slot] = static_cast<std::uint32_t>(m_values.size());
+  return m_values.back();
+}
+
+std::size_t SubstitutionTable::size() const { return m_values.size(); }
+
+std::size_t SubstitutionTable::memory_footprint() const {
+  return m_slots.capacity() * sizeof(std::uint32_t) +
+         m_keys.capacity() * sizeof(std::size_t) +
+         m_values.capacity() * sizeof(CospanMorphism::Type);
+}
+
+std::size_t SubstitutionTable::find_slot(std::size_t key) const {
+  auto const mask = m_slots.size() - 1;
+  auto slot = hash_key(key) & mask;
+  while (m_slots[slot] && m_keys[m_slots[slot] - 1] != key)
+    slot = (slot + 1) & mask;
+  return slot;
+}
+
+void SubstitutionTable::grow() {
+  m_slots.assign(std::max<std::size_t>(8, 2 * m_slots.size()), 0);
+  for (auto i = 0u; i < m_keys.size(); ++i)
+    m_slots[find_slot(m_keys[i])] = static_cast<std::uint32_t>(i + 1);
 }
 
 VariableSubstitution
-create_empty_substitution(CospanStructure const &cospan,
-                          NaturalTransformation const &transformation,
+create_empty_substitution(NaturalTransformation const &transformation,
                           std::size_t number_of_identifiers) {
   return create_empty_substitution(
-      cospan, transformation,
-      std::vector<std::size_t>(number_of_identifiers, 0));
+      transformation, std::vector<std::size_t>(number_of_identifiers, 0));
 }
 
 VariableSubstitution
-create_empty_substitution(CospanStructure const &cospan,
-                          NaturalTransformation const &transformation,
+create_empty_substitution(NaturalTransformation const &transformation,
                           std::vector<std::size_t> const &identifier_counts) {
-  auto const identifiers = transformation.symbols.size();
-  auto const cospan_values = cospan.total_number_of_identifiers;
-
-  VariableSubstitution substitution;
-  substitution.reserve(identifiers);
-  for (auto i = 0u; i < identifiers; ++i)
-    substitution.emplace_back(
-        CospanSubstitutions{std::vector<std::optional<CospanMorphism::Type>>(
-                                cospan_values, std::nullopt),
-                            identifier_counts});
-  return std::move(substitution);
+  return {std::vector<CospanSubstitutions>(transformation.symbols.size()),
+          identifier_counts};
+}
+
+std::vector<std::size_t>
+maximum_counts(VariableSubstitution const &substitution) {
+  auto counts = substitution.counts;
+  for (auto &&variable : substitution.variables) {
+    for (auto &&count : variable.maximum) {
+      auto &current = counts[count.first];
+      current = std::max(current, count.second);
+    }
+  }
+  return std::move(counts);
+}
+
+std::size_t memory_footprint(VariableSubstitution const &substitution) {
+  auto footprint = sizeof(VariableSubstitution) +
+                   substitution.counts.capacity() * sizeof(std::size_t) +
+                   substitution.variables.capacity() *
+                       sizeof(CospanSubstitutions);
+  for (auto &&variable : substitution.variables)
+    footprint += variable.values.memory_footprint() +
+                 variable.maximum.capacity() *
+                     sizeof(std::pair<std::size_t, std::size_t>);
+  return footprint;
 }
 
 } // namespace Naturality
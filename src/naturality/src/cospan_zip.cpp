@@ -3,106 +3,157 @@
 
 #include "naturality/cospan_to_string.hpp"
 
+#include <functional>
+
 namespace {
 
 using namespace Project::Naturality;
 
+struct ZipWalk {
+  std::vector<std::size_t> path;
+  char const *reason;
+
+  CospanMorphism::Type mismatch(char const *mismatch_reason) {
+    reason = mismatch_reason;
+    return EmptyType{};
+  }
+};
+
+CospanMorphism zip_morphisms(ZipWalk &, CospanMorphism const &,
+                             CospanMorphism const &);
+
 struct ZipCospanTypes {
 
-  CospanMorphism::Type operator()(std::size_t left, std::size_t right) const {
+  CospanMorphism::Type operator()(ZipWalk &, std::size_t left,
+                                  std::size_t right) const {
     return CospanMorphism::PairType{left, right};
   }
 
-  CospanMorphism::Type operator()(CospanMorphism const &left,
+  CospanMorphism::Type operator()(ZipWalk &walk, CospanMorphism const &left,
                                   CospanMorphism const &right) const {
-    return zip_cospan_morphisms(left, right);
+    return zip_morphisms(walk, get_nested(left), get_nested(right));
   }
 
-  CospanMorphism::Type operator()(CospanMorphism const &left,
+  CospanMorphism::Type operator()(ZipWalk &walk, CospanMorphism const &left,
                                   std::size_t right) const {
     if (auto const identifier = get_identifier(left))
       return CospanMorphism::PairType{*identifier, right};
-    throw std::runtime_error(
-        "attempted to zip cospans with differing structures");
+    return walk.mismatch("attempted to zip cospans with differing structures");
   }
 
-  CospanMorphism::Type operator()(std::size_t left,
+  CospanMorphism::Type operator()(ZipWalk &walk, std::size_t left,
                                   CospanMorphism const &right) const {
     if (auto const identifier = get_identifier(right))
       return CospanMorphism::PairType{left, *identifier};
-    throw std::runtime_error(
-        "attempted to zip cospans with differing structures");
+    return walk.mismatch("attempted to zip cospans with differing structures");
   }
 
-  CospanMorphism::Type operator()(EmptyType, EmptyType) const {
+  CospanMorphism::Type operator()(ZipWalk &, EmptyType, EmptyType) const {
     return EmptyType{};
   }
 
-  CospanMorphism::Type operator()(EmptyType, std::size_t right) const {
+  CospanMorphism::Type operator()(ZipWalk &, EmptyType,
+                                  std::size_t right) const {
     return CospanMorphism::PairType{0, right};
   }
 
-  CospanMorphism::Type operator()(std::size_t left, EmptyType) const {
+  CospanMorphism::Type operator()(ZipWalk &, std::size_t left,
+                                  EmptyType) const {
     return CospanMorphism::PairType{left, 0};
   }
 
-  template <typename T>
-  CospanMorphism::Type operator()(CospanMorphism const &,
+  CospanMorphism::Type operator()(ZipWalk &walk, CospanMorphism const &,
                                   CospanMorphism::PairType const &) const {
-    throw std::runtime_error("attempted to zip cospan morphism with pair");
+    return walk.mismatch("attempted to zip cospan morphism with pair");
   }
 
-  template <typename T>
-  CospanMorphism::Type operator()(CospanMorphism::PairType const &,
+  CospanMorphism::Type operator()(ZipWalk &walk,
+                                  CospanMorphism::PairType const &,
                                   CospanMorphism const &) const {
-    throw std::runtime_error("attempted to zip pair with cospan morphism");
+    return walk.mismatch("attempted to zip pair with cospan morphism");
   }
 
-  CospanMorphism::Type operator()(CospanMorphism::PairType const &,
+  CospanMorphism::Type operator()(ZipWalk &walk,
+                                  CospanMorphism::PairType const &,
                                   CospanMorphism::PairType const &) const {
-    throw std::runtime_error("unable to zip cospan pair types");
+    return walk.mismatch("unable to zip cospan pair types");
   }
 
   template <typename T, typename U>
-  CospanMorphism::Type operator()(T const &, U const &) const {
-    throw std::runtime_error("unable to zip cospans type");
+  CospanMorphism::Type operator()(ZipWalk &walk, T const &, U const &) const {
+    return walk.mismatch("unable to zip cospans type");
   }
 
 } _zip_cospan_types;
 
-CospanMorphism zip_morphisms(CospanMorphism const &left,
+CospanMorphism::Type zip_types(ZipWalk &walk, CospanMorphism::Type const &left,
+                               CospanMorphism::Type const &right) {
+  return std::visit(std::bind(_zip_cospan_types, std::ref(walk),
+                              std::placeholders::_1, std::placeholders::_2),
+                    left, right);
+}
+
+CospanMorphism zip_morphisms(ZipWalk &walk, CospanMorphism const &left,
                              CospanMorphism const &right) {
   auto const expected_size = left.map.size();
 
-  if (right.map.size() != expected_size)
-    throw std::runtime_error(
+  if (right.map.size() != expected_size) {
+    walk.mismatch(
         "attempted to zip cospans with differing internal morphisms");
+    return {};
+  }
 
   CospanMorphism zipped;
   zipped.map.reserve(expected_size);
   for (auto i = 0u; i < expected_size; ++i) {
     auto const left_type = left.map[i];
-    zipped.map.emplace_back(CospanMorphism::MappedType{
-        zip_cospan_types(left_type.type, right.map[i].type),
-        left_type.variance});
+    walk.path.emplace_back(i);
+    auto type = zip_types(walk, left_type.type, right.map[i].type);
+    if (walk.reason)
+      return {};
+    walk.path.pop_back();
+    zipped.map.emplace_back(
+        CospanMorphism::MappedType{std::move(type), left_type.variance});
   }
   return std::move(zipped);
 }
 
+template <typename T, typename Zip> Checked<T> try_zip(Zip const &zip) {
+  ZipWalk walk{{}, nullptr};
+  auto zipped = zip(walk);
+  if (walk.reason)
+    return CospanMismatch{0, std::move(walk.path), walk.reason};
+  return std::move(zipped);
+}
+
 } // namespace
 
 namespace Project {
 namespace Naturality {
 
+Checked<CospanMorphism::Type>
+try_zip_cospan_types(CospanMorphism::Type const &left,
+                     CospanMorphism::Type const &right) {
+  return try_zip<CospanMorphism::Type>(
+      [&](ZipWalk &walk) { return zip_types(walk, left, right); });
+}
+
+Checked<CospanMorphism> try_zip_cospan_morphisms(CospanMorphism const &left,
+                                                 CospanMorphism const &right) {
+  return try_zip<CospanMorphism>([&](ZipWalk &walk) {
+    return zip_morphisms(walk, get_nested(left), get_nested(right));
+  });
+}
+
 CospanMorphism::Type zip_cospan_types(CospanMorphism::Type const &left,
                                       CospanMorphism::Type const &right) {
-  return std::visit(_zip_cospan_types, left, right);
+  return get_checked(try_zip_cospan_types(left, right));
 }
 
 CospanMorphism zip_cospan_morphisms(CospanMorphism const &left,
                                     CospanMorphism const &right) {
-  return zip_morphisms(get_nested(left), get_nested(right));
+  return get_checked(try_zip_cospan_morphisms(left, right));
 }
 
 } // namespace Naturality
-} // namespace Project
\ No newline at end of file
+} // namespace Project
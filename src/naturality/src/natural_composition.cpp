@@ -2,7 +2,9 @@
 #include "polymorphic_types/substitution.hpp"
 #include "polymorphic_types/type_replacement.hpp"
 
+#include <functional>
 #include <optional>
+#include <stdexcept>
 
 namespace {
 
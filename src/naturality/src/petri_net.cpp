@@ -0,0 +1,557 @@
+#include "naturality/petri_net.hpp"
+#include "naturality/cospan_equality.hpp"
+#include "naturality/parallel_for.hpp"
+#include "polymorphic_types/type_equality.hpp"
+
+#include <algorithm>
+#include <functional>
+#include <optional>
+
+namespace {
+
+using namespace Project::Naturality;
+using namespace Project::Types;
+
+struct TypeNode {
+  bool is_domain;
+};
+
+struct PetriNetBuilder {
+  std::vector<PetriNet *> nets;
+  std::vector<std::size_t> node_counts;
+  std::vector<std::size_t> path;
+  char const *reason;
+
+  void mismatch(char const *mismatch_reason) { reason = mismatch_reason; }
+};
+
+bool is_edge_source(TypeNode const &type_node, Variance variance) {
+  return (type_node.is_domain && Variance::COVARIANCE == variance) ||
+         (!type_node.is_domain && Variance::CONTRAVARIANCE == variance);
+}
+
+Variance invert_variance(Variance variance) {
+  switch (variance) {
+  case Variance::CONTRAVARIANCE:
+    return Variance::COVARIANCE;
+  case Variance::COVARIANCE:
+    return Variance::CONTRAVARIANCE;
+  default:
+    return variance;
+  }
+}
+
+Variance calculate_variance(Variance variance, Variance environment_variance) {
+  switch (environment_variance) {
+  case Variance::CONTRAVARIANCE:
+    return invert_variance(variance);
+  default:
+    return variance;
+  }
+}
+
+bool is_selected(PetriNetBuilder const &graph, std::size_t type) {
+  return type < graph.nets.size() && nullptr != graph.nets[type];
+}
+
+void create_edge(PetriNet &net, std::size_t node, TypeNode const &type_node,
+                 Variance variance, std::size_t transition) {
+  if (is_edge_source(type_node, variance))
+    add_edge(net.incoming_edges, node, transition, 2.0);
+  else
+    add_edge(net.outgoing_edges, transition, node, 2.0);
+}
+
+void generate_graph_part(PetriNetBuilder &, TypeNode const &, Variance,
+                         TypeConstructor const &, CospanMorphism const &);
+
+void generate_graph_part(PetriNetBuilder &, TypeNode const &, Variance,
+                         FunctorTypeConstructor const &,
+                         CospanMorphism const &);
+
+void add_graph_node(PetriNetBuilder &graph, std::size_t type,
+                    Variance variance, std::size_t count) {
+  auto &nodes = graph.nets[type]->nodes;
+  nodes.identifiers.emplace_back(graph.node_counts[type]++);
+  nodes.types.emplace_back(type);
+  nodes.variances.emplace_back(variance);
+  nodes.counts.emplace_back(count);
+}
+
+void add_graph_edge(PetriNetBuilder &graph, std::size_t type,
+                    TypeNode const &type_node, Variance variance,
+                    std::size_t transition) {
+  create_edge(*graph.nets[type], graph.node_counts[type], type_node, variance,
+              transition);
+}
+
+void create_graph_part(PetriNetBuilder &graph, TypeNode const &type_node,
+                       Variance variance, std::size_t type,
+                       std::size_t transition) {
+  if (is_selected(graph, type)) {
+    add_graph_edge(graph, type, type_node, variance, transition);
+    add_graph_node(graph, type, variance,
+                   is_edge_source(type_node, variance) ? 1 : 0);
+  }
+}
+
+void create_graph_part(PetriNetBuilder &graph, TypeNode const &,
+                       Variance variance, std::size_t type,
+                       CospanMorphism::PairType const &transitions) {
+  if (is_selected(graph, type)) {
+    add_graph_edge(graph, type, {false}, variance, transitions.first);
+    add_graph_edge(graph, type, {true}, variance, transitions.second);
+    add_graph_node(graph, type, variance, 0);
+  }
+}
+
+template <typename T>
+void generate_graph_part_with(PetriNetBuilder &, TypeNode const &, Variance,
+                              TypeConstructor::Type const &, T const &);
+
+template <typename T>
+void generate_graph_part_with(PetriNetBuilder &, TypeNode const &, Variance,
+                              T const &, CospanMorphism::Type const &);
+
+struct GeneratePetriNetPart {
+
+  void operator()(PetriNetBuilder &graph, TypeNode const &type_node,
+                  Variance variance, std::size_t type,
+                  std::size_t transition) const {
+    create_graph_part(graph, type_node, variance, type, transition);
+  }
+
+  void operator()(PetriNetBuilder &graph, TypeNode const &type_node,
+                  Variance variance, std::size_t type,
+                  CospanMorphism::PairType const &transitions) const {
+    create_graph_part(graph, type_node, variance, type, transitions);
+  }
+
+  void operator()(PetriNetBuilder &graph, TypeNode const &type_node,
+                  Variance variance, TypeConstructor const &constructor,
+                  CospanMorphism const &morphism) const {
+    generate_graph_part(graph, type_node, variance, constructor, morphism);
+  }
+
+  void operator()(PetriNetBuilder &graph, TypeNode const &type_node,
+                  Variance variance, FunctorTypeConstructor const &functor,
+                  CospanMorphism const &morphism) const {
+    generate_graph_part(graph, type_node, variance, functor, morphism);
+  }
+
+  template <typename T>
+  void operator()(PetriNetBuilder &graph, TypeNode const &type_node,
+                  Variance variance, FunctorTypeConstructor const &functor,
+                  T const &cospan_value) const {
+    if (functor.type.size() == 1)
+      generate_graph_part_with(graph, type_node, variance,
+                               functor.type[0].type, cospan_value);
+    else
+      graph.mismatch(
+          "cospan type does not match polymorphic type: functor found");
+  }
+
+  template <typename T>
+  void operator()(PetriNetBuilder &graph, TypeNode const &type_node,
+                  Variance variance, TypeConstructor const &type,
+                  T const &cospan_value) const {
+    if (type.type.size() == 1)
+      generate_graph_part_with(graph, type_node, variance, type.type[0].type,
+                               cospan_value);
+    else
+      graph.mismatch(
+          "cospan type does not match polymorphic type: constructor found");
+  }
+
+  template <typename T>
+  void operator()(PetriNetBuilder &graph, TypeNode const &type_node,
+                  Variance variance, T const &type,
+                  CospanMorphism const &morphism) const {
+    if (morphism.map.size() == 1)
+      generate_graph_part_with(graph, type_node, variance, type,
+                               morphism.map[0]);
+    else
+      graph.mismatch(
+          "cospan type does not match polymorphic type: morphism found");
+  }
+
+  template <typename T, typename U>
+  void operator()(PetriNetBuilder &graph, TypeNode const &, Variance,
+                  T const &, U const &) const {
+    graph.mismatch("cospan type does not match polymorphic type: unknown");
+  }
+} _generate_petri_net_part;
+
+template <typename T>
+void generate_graph_part_with(PetriNetBuilder &graph,
+                              TypeNode const &type_node, Variance variance,
+                              TypeConstructor::Type const &type,
+                              T const &cospan_value) {
+  std::visit(std::bind(_generate_petri_net_part, std::ref(graph),
+                       std::cref(type_node), variance, std::placeholders::_1,
+                       std::cref(cospan_value)),
+             type);
+}
+
+template <typename T>
+void generate_graph_part_with(PetriNetBuilder &graph,
+                              TypeNode const &type_node, Variance variance,
+                              T const &type,
+                              CospanMorphism::Type const &cospan_value) {
+  std::visit(std::bind(_generate_petri_net_part, std::ref(graph),
+                       std::cref(type_node), variance, std::cref(type),
+                       std::placeholders::_1),
+             cospan_value);
+}
+
+template <typename F>
+void generate_graph_part(PetriNetBuilder &graph, F const &create_graph_part,
+                         Variance variance,
+                         TypeConstructor::AtomicType const &type,
+                         CospanMorphism::MappedType const &cospan_type) {
+  if (type.variance != cospan_type.variance)
+    return graph.mismatch("cospan type does not match polymorphic type");
+
+  auto const create_part =
+      std::bind(create_graph_part, calculate_variance(type.variance, variance),
+                std::placeholders::_1, std::placeholders::_2);
+  std::visit(create_part, type.type, cospan_type.type);
+}
+
+void generate_graph_part(PetriNetBuilder &graph, TypeNode const &type_node,
+                         Variance variance,
+                         TypeConstructor::ConstructorType const &types,
+                         CospanMorphism const &morphism) {
+  auto const create_graph_part =
+      std::bind(_generate_petri_net_part, std::ref(graph),
+                std::cref(type_node), std::placeholders::_1,
+                std::placeholders::_2, std::placeholders::_3);
+
+  for (auto i = 0u; i < morphism.map.size(); ++i) {
+    graph.path.emplace_back(i);
+    generate_graph_part(graph, create_graph_part, variance, types[i],
+                        morphism.map[i]);
+    if (graph.reason)
+      return;
+    graph.path.pop_back();
+  }
+}
+
+void generate_graph_part(PetriNetBuilder &graph, TypeNode const &type_node,
+                         Variance variance,
+                         FunctorTypeConstructor const &functor,
+                         CospanMorphism const &morphism) {
+  auto const &nested_morphism = get_nested(morphism);
+
+  if (nested_morphism.map.size() == functor.type.size())
+    generate_graph_part(graph, type_node, variance, functor.type,
+                        nested_morphism);
+  else if (nested_morphism.map.size() == 1)
+    generate_graph_part_with(graph, type_node, variance, functor,
+                             nested_morphism.map[0]);
+  else if (functor.type.size() == 1)
+    generate_graph_part_with(graph, type_node, variance, functor.type[0].type,
+                             nested_morphism);
+  else
+    graph.mismatch("cospan type does not match polymorphic type");
+}
+
+void generate_graph_part(PetriNetBuilder &graph, TypeNode const &type_node,
+                         Variance variance, TypeConstructor const &constructor,
+                         CospanMorphism const &morphism) {
+  auto const &nested_constructor = get_nested(constructor);
+  auto const &nested_morphism = get_nested(morphism);
+
+  if (nested_morphism.map.size() == nested_constructor.type.size())
+    generate_graph_part(graph, type_node, variance, nested_constructor.type,
+                        nested_morphism);
+  else if (nested_morphism.map.size() == 1)
+    generate_graph_part_with(graph, type_node, variance, nested_constructor,
+                             nested_morphism.map[0]);
+  else if (nested_constructor.type.size() == 1)
+    generate_graph_part_with(graph, type_node, variance,
+                             nested_constructor.type[0].type, nested_morphism);
+  else
+    graph.mismatch("cospan type does not match polymorphic type");
+}
+
+void add_invisible_edges(PetriNet &net) {
+  auto const &offsets = net.nodes.offsets;
+  auto const &identifiers = net.nodes.identifiers;
+
+  for (auto i = 1u; i < offsets.size(); ++i) {
+    for (auto node = offsets[i - 1] + 1; node < offsets[i]; ++node)
+      add_edge(net.invisible_edges, identifiers[node - 1], identifiers[node],
+               1.0);
+  }
+}
+
+void generate_invisible_edges(PetriNet &net) {
+  auto const &offsets = net.transition_offsets;
+  for (auto i = 1u; i < offsets.size(); ++i) {
+    for (auto transition = offsets[i - 1]; transition + 1 < offsets[i];
+         ++transition)
+      add_edge(net.invisible_edges, transition, transition + 1, 0.5);
+  }
+}
+
+std::vector<std::size_t> group_transitions(
+    std::vector<std::pair<std::size_t, std::size_t>> const &shared_count) {
+  std::vector<std::size_t> offsets;
+  offsets.reserve(shared_count.size());
+  offsets.emplace_back(0);
+
+  for (auto i = 0u; i < shared_count.size() - 1; ++i)
+    offsets.emplace_back(offsets.back() + shared_count[i].second);
+  return std::move(offsets);
+}
+
+void add_node_offsets(PetriNetBuilder &graph) {
+  for (auto &&net : graph.nets) {
+    if (net)
+      net->nodes.offsets.emplace_back(net->nodes.identifiers.size());
+  }
+}
+
+std::optional<CospanMismatch>
+generate_domain(PetriNetBuilder &graph,
+                std::vector<TypeConstructor> const &domains,
+                CospanStructure const &cospan, std::size_t domain) {
+  generate_graph_part(graph, {0 == domain}, Variance::COVARIANCE,
+                      domains[domain], cospan.domains[domain]);
+  if (graph.reason)
+    return CospanMismatch{domain, std::move(graph.path), graph.reason};
+  return std::nullopt;
+}
+
+std::optional<CospanMismatch>
+generate_graph_parts(PetriNetBuilder &graph,
+                     std::vector<TypeConstructor> const &domains,
+                     CospanStructure const &cospan) {
+  add_node_offsets(graph);
+
+  for (auto i = 0u; i < domains.size(); ++i) {
+    if (auto mismatch = generate_domain(graph, domains, cospan, i))
+      return mismatch;
+    add_node_offsets(graph);
+  }
+  return std::nullopt;
+}
+
+using PetriNetParts = std::vector<std::vector<PetriNet>>;
+
+struct PartOffsets {
+  std::size_t nodes;
+  std::size_t incoming_edges;
+  std::size_t outgoing_edges;
+};
+
+Checked<PetriNetParts>
+generate_parts(PetriNetBuilder const &graph,
+               std::vector<TypeConstructor> const &domains,
+               CospanStructure const &cospan) {
+  auto const types = graph.nets.size();
+  PetriNetParts parts(domains.size(), std::vector<PetriNet>(types));
+  std::vector<std::optional<CospanMismatch>> mismatches(domains.size());
+
+  parallel_for(domains.size(), [&](std::size_t i) {
+    PetriNetBuilder part{{}, std::vector<std::size_t>(types, 0)};
+    for (auto type = 0u; type < types; ++type)
+      part.nets.emplace_back(graph.nets[type] ? &parts[i][type] : nullptr);
+    mismatches[i] = generate_domain(part, domains, cospan, i);
+  });
+
+  for (auto &&mismatch : mismatches) {
+    if (mismatch)
+      return std::move(*mismatch);
+  }
+  return std::move(parts);
+}
+
+std::vector<PartOffsets> part_offsets(PetriNetParts const &parts,
+                                      std::size_t type) {
+  std::vector<PartOffsets> offsets(parts.size() + 1, {0, 0, 0});
+  for (auto i = 0u; i < parts.size(); ++i) {
+    auto const &part = parts[i][type];
+    offsets[i + 1] = {
+        offsets[i].nodes + part.nodes.identifiers.size(),
+        offsets[i].incoming_edges + part.incoming_edges.sources.size(),
+        offsets[i].outgoing_edges + part.outgoing_edges.sources.size()};
+  }
+  return std::move(offsets);
+}
+
+void resize_nodes(PetriNetNodes &nodes, std::size_t size) {
+  nodes.identifiers.resize(size);
+  nodes.types.resize(size);
+  nodes.variances.resize(size);
+  nodes.counts.resize(size);
+}
+
+void resize_edges(PetriNetEdges &edges, std::size_t size) {
+  edges.sources.resize(size);
+  edges.targets.resize(size);
+  edges.distances.resize(size);
+}
+
+void copy_nodes(PetriNetNodes &nodes, PetriNetNodes const &part,
+                std::size_t offset, std::size_t shift) {
+  for (auto i = 0u; i < part.identifiers.size(); ++i) {
+    nodes.identifiers[offset + i] = part.identifiers[i] + shift;
+    nodes.types[offset + i] = part.types[i];
+    nodes.variances[offset + i] = part.variances[i];
+    nodes.counts[offset + i] = part.counts[i];
+  }
+}
+
+void copy_edges(PetriNetEdges &edges, PetriNetEdges const &part,
+                std::size_t offset, std::size_t source_shift,
+                std::size_t target_shift) {
+  for (auto i = 0u; i < part.sources.size(); ++i) {
+    edges.sources[offset + i] = part.sources[i] + source_shift;
+    edges.targets[offset + i] = part.targets[i] + target_shift;
+    edges.distances[offset + i] = part.distances[i];
+  }
+}
+
+void merge_parts(PetriNet &net, PetriNetParts const &parts, std::size_t type,
+                 std::size_t first_node) {
+  auto const offsets = part_offsets(parts, type);
+  auto const &total = offsets.back();
+  resize_nodes(net.nodes, total.nodes);
+  resize_edges(net.incoming_edges, total.incoming_edges);
+  resize_edges(net.outgoing_edges, total.outgoing_edges);
+
+  parallel_for(parts.size(), [&](std::size_t i) {
+    auto const &part = parts[i][type];
+    auto const shift = first_node + offsets[i].nodes;
+    copy_nodes(net.nodes, part.nodes, offsets[i].nodes, shift);
+    copy_edges(net.incoming_edges, part.incoming_edges,
+               offsets[i].incoming_edges, shift, 0);
+    copy_edges(net.outgoing_edges, part.outgoing_edges,
+               offsets[i].outgoing_edges, 0, shift);
+  });
+
+  for (auto &&offset : offsets)
+    net.nodes.offsets.emplace_back(offset.nodes);
+}
+
+std::optional<CospanMismatch> generate_graph_parts_in_parallel(
+    PetriNetBuilder &graph, std::vector<TypeConstructor> const &domains,
+    CospanStructure const &cospan) {
+  auto const parts = generate_parts(graph, domains, cospan);
+  if (auto const mismatch = std::get_if<CospanMismatch>(&parts))
+    return *mismatch;
+
+  for (auto type = 0u; type < graph.nets.size(); ++type) {
+    if (graph.nets[type])
+      merge_parts(*graph.nets[type], std::get<PetriNetParts>(parts), type,
+                  graph.node_counts[type]);
+  }
+  return std::nullopt;
+}
+
+std::optional<CospanMismatch>
+generate_petri_nets(PetriNetBuilder &graph,
+                    std::vector<TypeConstructor> const &domains,
+                    CospanStructure const &cospan, bool parallel) {
+  if (cospan.domains.size() != domains.size())
+    return CospanMismatch{0, {}, "number of domains differ"};
+
+  auto const transition_offsets = group_transitions(cospan.shared_counts);
+  for (auto &&net : graph.nets) {
+    if (net) {
+      net->transition_offsets = transition_offsets;
+      generate_invisible_edges(*net);
+    }
+  }
+
+  auto mismatch = parallel && domains.size() > 1
+                      ? generate_graph_parts_in_parallel(graph, domains, cospan)
+                      : generate_graph_parts(graph, domains, cospan);
+  if (mismatch)
+    return mismatch;
+
+  for (auto &&net : graph.nets) {
+    if (net)
+      add_invisible_edges(*net);
+  }
+  return std::nullopt;
+}
+
+} // namespace
+
+namespace Project {
+namespace Naturality {
+
+Checked<PetriNet>
+try_create_petri_net(std::vector<TypeConstructor> const &domains,
+                     CospanStructure const &cospan, std::size_t transitions,
+                     std::size_t type, bool parallel) {
+  PetriNet net;
+  PetriNetBuilder builder{std::vector<PetriNet *>(type + 1, nullptr),
+                          std::vector<std::size_t>(type + 1, 0)};
+  builder.nets[type] = &net;
+  builder.node_counts[type] = transitions;
+
+  if (auto mismatch = generate_petri_nets(builder, domains, cospan, parallel))
+    return std::move(*mismatch);
+  return std::move(net);
+}
+
+Checked<std::vector<PetriNet>>
+try_create_petri_nets(std::vector<TypeConstructor> const &domains,
+                      CospanStructure const &cospan,
+                      std::vector<std::size_t> const &transitions,
+                      bool parallel) {
+  std::vector<PetriNet> nets(transitions.size());
+  PetriNetBuilder builder{{}, transitions};
+  for (auto &&net : nets)
+    builder.nets.emplace_back(&net);
+
+  if (auto mismatch = generate_petri_nets(builder, domains, cospan, parallel))
+    return std::move(*mismatch);
+  return std::move(nets);
+}
+
+PetriNet create_petri_net(std::vector<TypeConstructor> const &domains,
+                          CospanStructure const &cospan,
+                          std::size_t transitions, std::size_t type,
+                          bool parallel) {
+  return get_checked(
+      try_create_petri_net(domains, cospan, transitions, type, parallel));
+}
+
+std::vector<PetriNet>
+create_petri_nets(std::vector<TypeConstructor> const &domains,
+                  CospanStructure const &cospan,
+                  std::vector<std::size_t> const &transitions,
+                  bool parallel) {
+  return get_checked(
+      try_create_petri_nets(domains, cospan, transitions, parallel));
+}
+
+void add_edge(PetriNetEdges &edges, std::size_t source, std::size_t target,
+              double distance) {
+  edges.sources.emplace_back(source);
+  edges.targets.emplace_back(target);
+  edges.distances.emplace_back(distance);
+}
+
+std::size_t number_of_vertices(PetriNet const &net) {
+  std::size_t vertices =
+      net.transition_offsets.empty() ? 0 : net.transition_offsets.back();
+  for (auto &&identifier : net.nodes.identifiers)
+    vertices = std::max(vertices, identifier + 1);
+
+  for (auto edges : {&net.incoming_edges, &net.outgoing_edges,
+                     &net.invisible_edges}) {
+    for (auto i = 0u; i < edges->sources.size(); ++i)
+      vertices = std::max({vertices, edges->sources[i] + 1,
+                           edges->targets[i] + 1});
+  }
+  return vertices;
+}
+
+} // namespace Naturality
+} // namespace Project
@@ -0,0 +1,301 @@
+#include "naturality/petri_net_acyclicity.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace {
+
+using namespace Project::Naturality;
+
+constexpr std::size_t no_vertex = std::numeric_limits<std::size_t>::max();
+
+using Adjacency = std::vector<std::vector<std::size_t>>;
+using Parents = std::unordered_map<std::size_t, std::size_t>;
+
+std::size_t number_of_groups(PetriNetNodes const &nodes) {
+  return nodes.offsets.empty() ? 0 : nodes.offsets.size() - 1;
+}
+
+std::size_t group_size(PetriNetNodes const &nodes, std::size_t group) {
+  if (group >= number_of_groups(nodes))
+    return 0;
+  return nodes.offsets[group + 1] - nodes.offsets[group];
+}
+
+std::vector<std::size_t> last_group(PetriNetNodes const &nodes,
+                                    std::vector<std::size_t> const &places) {
+  std::vector<std::size_t> vertices;
+  auto const groups = number_of_groups(nodes);
+  if (0 == groups)
+    return std::move(vertices);
+
+  for (auto i = nodes.offsets[groups - 1]; i < nodes.offsets[groups]; ++i)
+    vertices.emplace_back(places[nodes.identifiers[i]]);
+  return std::move(vertices);
+}
+
+std::vector<std::size_t>
+find_unsorted_cycle(Adjacency const &predecessors,
+                    std::vector<std::size_t> const &positions,
+                    std::size_t first) {
+  auto const is_unsorted = [&](std::size_t vertex) {
+    return vertex >= first && no_vertex == positions[vertex];
+  };
+
+  auto vertex = first;
+  while (!is_unsorted(vertex))
+    ++vertex;
+
+  Parents steps;
+  std::vector<std::size_t> walk;
+  while (!steps.count(vertex)) {
+    steps[vertex] = walk.size();
+    walk.emplace_back(vertex);
+    auto const &incoming = predecessors[vertex];
+    vertex = *std::find_if(incoming.begin(), incoming.end(), is_unsorted);
+  }
+  return {walk.rbegin(), walk.rend() - steps[vertex]};
+}
+
+bool is_back_edge(std::pair<std::size_t, std::size_t> const &edge,
+                  std::size_t first) {
+  return edge.first >= first && edge.second < first;
+}
+
+std::vector<std::size_t> trace_cycle(Parents const &parents, std::size_t from,
+                                     std::size_t to) {
+  std::vector<std::size_t> cycle;
+  for (auto vertex = to; vertex != from; vertex = parents.at(vertex))
+    cycle.emplace_back(vertex);
+  cycle.emplace_back(from);
+  std::reverse(cycle.begin(), cycle.end());
+  return std::move(cycle);
+}
+
+} // namespace
+
+namespace Project {
+namespace Naturality {
+
+AcyclicityChecker::AcyclicityChecker()
+    : m_sorted(0), m_mark(0), m_length(0), m_result{true, {}} {}
+
+AcyclicityResult const &
+AcyclicityChecker::extend(std::vector<PetriNet> const &nets) {
+  if (!is_matching(nets))
+    throw std::runtime_error("petri nets do not match the end of the chain");
+
+  auto const first = m_vertices.size();
+  std::vector<std::size_t> transitions;
+  std::vector<std::vector<std::size_t>> boundaries;
+  Edges edges;
+
+  for (auto type = 0u; type < nets.size(); ++type)
+    boundaries.emplace_back(add_net(nets[type], type, transitions, edges));
+
+  order_link(first, edges);
+  m_boundaries = std::move(boundaries);
+  ++m_length;
+  return m_result;
+}
+
+AcyclicityResult const &AcyclicityChecker::result() const { return m_result; }
+
+std::size_t AcyclicityChecker::length() const { return m_length; }
+
+bool AcyclicityChecker::is_matching(std::vector<PetriNet> const &nets) const {
+  if (0 == m_length)
+    return true;
+  if (nets.size() != m_boundaries.size())
+    return false;
+
+  for (auto type = 0u; type < nets.size(); ++type) {
+    if (group_size(nets[type].nodes, 0) != m_boundaries[type].size())
+      return false;
+  }
+  return true;
+}
+
+std::vector<std::size_t>
+AcyclicityChecker::add_net(PetriNet const &net, std::size_t type,
+                           std::vector<std::size_t> &transitions,
+                           Edges &edges) {
+  auto const &nodes = net.nodes;
+  std::vector<std::size_t> places(number_of_vertices(net), no_vertex);
+  if (m_length > 0)
+    glue_places(nodes, type, places);
+
+  auto const groups = number_of_groups(nodes);
+  for (auto group = m_length > 0 ? 1u : 0u; group < groups; ++group) {
+    for (auto i = nodes.offsets[group]; i < nodes.offsets[group + 1]; ++i)
+      places[nodes.identifiers[i]] =
+          add_vertex({m_length, type, nodes.identifiers[i]});
+  }
+
+  auto const vertex = [&](std::size_t identifier) {
+    if (no_vertex != places[identifier])
+      return places[identifier];
+
+    if (transitions.size() <= identifier)
+      transitions.resize(identifier + 1, no_vertex);
+    if (no_vertex == transitions[identifier])
+      transitions[identifier] =
+          add_vertex({m_length, transition_type, identifier});
+    return transitions[identifier];
+  };
+
+  for (auto edges_of_kind : {&net.incoming_edges, &net.outgoing_edges}) {
+    for (auto i = 0u; i < edges_of_kind->sources.size(); ++i)
+      edges.emplace_back(vertex(edges_of_kind->sources[i]),
+                         vertex(edges_of_kind->targets[i]));
+  }
+  return last_group(nodes, places);
+}
+
+void AcyclicityChecker::glue_places(PetriNetNodes const &nodes,
+                                    std::size_t type,
+                                    std::vector<std::size_t> &places) const {
+  auto const &boundary = m_boundaries[type];
+  for (auto i = 0u; i < boundary.size(); ++i)
+    places[nodes.identifiers[nodes.offsets[0] + i]] = boundary[i];
+}
+
+std::size_t AcyclicityChecker::add_vertex(PetriNetVertex const &vertex) {
+  m_vertices.emplace_back(vertex);
+  m_successors.emplace_back();
+  m_predecessors.emplace_back();
+  m_positions.emplace_back(no_vertex);
+  m_marks.emplace_back(0);
+  return m_vertices.size() - 1;
+}
+
+void AcyclicityChecker::connect(std::size_t source, std::size_t target) {
+  m_successors[source].emplace_back(target);
+  m_predecessors[target].emplace_back(source);
+}
+
+void AcyclicityChecker::order_link(std::size_t first, Edges const &edges) {
+  for (auto &&edge : edges) {
+    if (!is_back_edge(edge, first))
+      connect(edge.first, edge.second);
+  }
+
+  if (m_result.acyclic)
+    sort_link(first);
+
+  for (auto &&edge : edges) {
+    if (is_back_edge(edge, first))
+      insert_edge(edge.first, edge.second);
+  }
+}
+
+void AcyclicityChecker::sort_link(std::size_t first) {
+  std::vector<std::size_t> degrees(m_vertices.size() - first, 0);
+  std::vector<std::size_t> ready;
+
+  for (auto vertex = first; vertex < m_vertices.size(); ++vertex) {
+    auto const &incoming = m_predecessors[vertex];
+    degrees[vertex - first] = std::count_if(
+        incoming.begin(), incoming.end(),
+        [&](std::size_t predecessor) { return predecessor >= first; });
+    if (0 == degrees[vertex - first])
+      ready.emplace_back(vertex);
+  }
+
+  while (!ready.empty()) {
+    auto const vertex = ready.back();
+    ready.pop_back();
+    m_positions[vertex] = m_sorted++;
+
+    for (auto &&successor : m_successors[vertex]) {
+      if (successor >= first && 0 == --degrees[successor - first])
+        ready.emplace_back(successor);
+    }
+  }
+
+  if (m_sorted < m_vertices.size())
+    set_cycle(find_unsorted_cycle(m_predecessors, m_positions, first));
+}
+
+void AcyclicityChecker::insert_edge(std::size_t source, std::size_t target) {
+  if (m_result.acyclic && m_positions[source] > m_positions[target])
+    reorder(source, target);
+  connect(source, target);
+}
+
+void AcyclicityChecker::reorder(std::size_t source, std::size_t target) {
+  auto const lower = m_positions[target];
+  auto const upper = m_positions[source];
+  Parents parents;
+  std::vector<std::size_t> forward;
+  std::vector<std::size_t> stack = {target};
+  m_marks[target] = ++m_mark;
+
+  while (!stack.empty()) {
+    auto const vertex = stack.back();
+    stack.pop_back();
+    forward.emplace_back(vertex);
+
+    for (auto &&successor : m_successors[vertex]) {
+      if (successor == source) {
+        parents[source] = vertex;
+        return set_cycle(trace_cycle(parents, target, source));
+      }
+
+      if (m_mark != m_marks[successor] && m_positions[successor] < upper) {
+        m_marks[successor] = m_mark;
+        parents[successor] = vertex;
+        stack.emplace_back(successor);
+      }
+    }
+  }
+
+  std::vector<std::size_t> backward;
+  stack = {source};
+  m_marks[source] = ++m_mark;
+
+  while (!stack.empty()) {
+    auto const vertex = stack.back();
+    stack.pop_back();
+    backward.emplace_back(vertex);
+
+    for (auto &&predecessor : m_predecessors[vertex]) {
+      if (m_mark != m_marks[predecessor] && m_positions[predecessor] > lower) {
+        m_marks[predecessor] = m_mark;
+        stack.emplace_back(predecessor);
+      }
+    }
+  }
+
+  auto const by_position = [&](std::size_t left, std::size_t right) {
+    return m_positions[left] < m_positions[right];
+  };
+  std::sort(forward.begin(), forward.end(), by_position);
+  std::sort(backward.begin(), backward.end(), by_position);
+
+  auto affected = std::move(backward);
+  affected.insert(affected.end(), forward.begin(), forward.end());
+  std::vector<std::size_t> positions;
+  for (auto &&vertex : affected)
+    positions.emplace_back(m_positions[vertex]);
+  std::sort(positions.begin(), positions.end());
+
+  for (auto i = 0u; i < affected.size(); ++i)
+    m_positions[affected[i]] = positions[i];
+}
+
+void AcyclicityChecker::set_cycle(std::vector<std::size_t> const &cycle) {
+  m_result.acyclic = false;
+  m_result.cycle.clear();
+  for (auto &&vertex : cycle)
+    m_result.cycle.emplace_back(m_vertices[vertex]);
+}
+
+AcyclicityResult check_acyclicity(std::vector<PetriNet> const &nets) {
+  AcyclicityChecker checker;
+  return checker.extend(nets);
+}
+
+} // namespace Naturality
+} // namespace Project
@@ -0,0 +1,100 @@
+#include "naturality/petri_net_chunks.hpp"
+
+#include <algorithm>
+#include <unordered_map>
+
+namespace {
+
+using namespace Project::Naturality;
+
+using VertexChunks = std::unordered_map<std::size_t, std::size_t>;
+
+PetriNetChunk create_transition_chunk(PetriNet const &net) {
+  PetriNetChunk chunk{transition_chunk_group, {}};
+  chunk.net.nodes.offsets = {0};
+  chunk.net.transition_offsets = net.transition_offsets;
+  return std::move(chunk);
+}
+
+PetriNetChunk create_node_chunk(std::size_t group) {
+  PetriNetChunk chunk{group, {}};
+  chunk.net.nodes.offsets = {0, 0};
+  return std::move(chunk);
+}
+
+bool is_chunk_full(PetriNetChunk const &chunk, std::size_t group,
+                   std::size_t size) {
+  return transition_chunk_group == chunk.group || group != chunk.group ||
+         chunk.net.nodes.identifiers.size() >= size;
+}
+
+void add_node(PetriNetNodes &chunk, PetriNetNodes const &nodes,
+              std::size_t index) {
+  chunk.identifiers.emplace_back(nodes.identifiers[index]);
+  chunk.types.emplace_back(nodes.types[index]);
+  chunk.variances.emplace_back(nodes.variances[index]);
+  chunk.counts.emplace_back(nodes.counts[index]);
+  chunk.offsets.back() = chunk.identifiers.size();
+}
+
+void add_node_chunks(std::vector<PetriNetChunk> &chunks,
+                     VertexChunks &vertex_chunks, PetriNetNodes const &nodes,
+                     std::size_t size) {
+  for (auto group = 0u; group + 1 < nodes.offsets.size(); ++group) {
+    for (auto i = nodes.offsets[group]; i < nodes.offsets[group + 1]; ++i) {
+      if (is_chunk_full(chunks.back(), group, size))
+        chunks.emplace_back(create_node_chunk(group));
+
+      add_node(chunks.back().net.nodes, nodes, i);
+      vertex_chunks[nodes.identifiers[i]] = chunks.size() - 1;
+    }
+  }
+}
+
+std::size_t find_chunk(VertexChunks const &vertex_chunks,
+                       std::size_t vertex) {
+  auto const found = vertex_chunks.find(vertex);
+  return vertex_chunks.end() == found ? 0 : found->second;
+}
+
+template <typename Select>
+void add_edge_chunks(std::vector<PetriNetChunk> &chunks,
+                     VertexChunks const &vertex_chunks,
+                     PetriNetEdges const &edges, Select const &select) {
+  for (auto i = 0u; i < edges.sources.size(); ++i) {
+    auto const chunk = std::max(find_chunk(vertex_chunks, edges.sources[i]),
+                                find_chunk(vertex_chunks, edges.targets[i]));
+    add_edge(select(chunks[chunk].net), edges.sources[i], edges.targets[i],
+             edges.distances[i]);
+  }
+}
+
+} // namespace
+
+namespace Project {
+namespace Naturality {
+
+std::vector<PetriNetChunk> split_petri_net(PetriNet const &net,
+                                           std::size_t size) {
+  std::vector<PetriNetChunk> chunks = {create_transition_chunk(net)};
+  VertexChunks vertex_chunks;
+  add_node_chunks(chunks, vertex_chunks, net.nodes,
+                  std::max<std::size_t>(size, 1));
+
+  add_edge_chunks(chunks, vertex_chunks, net.incoming_edges,
+                  [](PetriNet &chunk) -> PetriNetEdges & {
+                    return chunk.incoming_edges;
+                  });
+  add_edge_chunks(chunks, vertex_chunks, net.outgoing_edges,
+                  [](PetriNet &chunk) -> PetriNetEdges & {
+                    return chunk.outgoing_edges;
+                  });
+  add_edge_chunks(chunks, vertex_chunks, net.invisible_edges,
+                  [](PetriNet &chunk) -> PetriNetEdges & {
+                    return chunk.invisible_edges;
+                  });
+  return std::move(chunks);
+}
+
+} // namespace Naturality
+} // namespace Project
@@ -0,0 +1,169 @@
+#include "naturality/petri_net_diff.hpp"
+
+#include <map>
+#include <tuple>
+
+namespace {
+
+using namespace Project::Naturality;
+
+constexpr std::size_t no_attributes = std::numeric_limits<std::size_t>::max();
+
+struct VertexKey {
+  bool is_transition;
+  std::size_t group;
+  std::size_t index;
+
+  bool operator<(VertexKey const &other) const {
+    return std::tie(is_transition, group, index) <
+           std::tie(other.is_transition, other.group, other.index);
+  }
+};
+
+struct Vertex {
+  VertexKey key;
+  std::size_t attributes;
+};
+
+using VertexKeys = std::map<std::size_t, Vertex>;
+using VertexIdentifiers = std::map<VertexKey, std::size_t>;
+using EdgeKey = std::tuple<VertexKey, VertexKey, std::size_t>;
+using EdgeDistances = std::map<EdgeKey, std::pair<std::size_t, double>>;
+
+template <typename Function>
+void for_each_group(std::vector<std::size_t> const &offsets,
+                    Function const &function) {
+  for (auto group = 0u; group + 1 < offsets.size(); ++group) {
+    for (auto i = offsets[group]; i < offsets[group + 1]; ++i)
+      function(group, i - offsets[group], i);
+  }
+}
+
+VertexKeys create_vertex_keys(PetriNet const &net) {
+  VertexKeys keys;
+  for_each_group(net.transition_offsets, [&](std::size_t group,
+                                             std::size_t index,
+                                             std::size_t identifier) {
+    keys[identifier] = {{true, group, index}, no_attributes};
+  });
+  for_each_group(net.nodes.offsets, [&](std::size_t group, std::size_t index,
+                                        std::size_t i) {
+    keys[net.nodes.identifiers[i]] = {{false, group, index}, i};
+  });
+  return std::move(keys);
+}
+
+VertexIdentifiers create_vertex_identifiers(VertexKeys const &keys) {
+  VertexIdentifiers identifiers;
+  for (auto &&vertex : keys)
+    identifiers.emplace(vertex.second.key, vertex.first);
+  return std::move(identifiers);
+}
+
+bool is_changed(PetriNetNodes const &previous, std::size_t previous_index,
+                PetriNetNodes const &next, std::size_t next_index) {
+  if (no_attributes == previous_index || no_attributes == next_index)
+    return previous_index != next_index;
+
+  return previous.types[previous_index] != next.types[next_index] ||
+         previous.variances[previous_index] != next.variances[next_index] ||
+         previous.counts[previous_index] != next.counts[next_index];
+}
+
+void diff_vertices(PetriNetDiff &diff, PetriNet const &previous,
+                   VertexKeys const &previous_keys, PetriNet const &next,
+                   VertexKeys const &next_keys) {
+  auto const identifiers = create_vertex_identifiers(previous_keys);
+  auto const vertices = next_keys.empty() ? 0 : next_keys.rbegin()->first + 1;
+  diff.previous.assign(vertices, no_previous_vertex);
+
+  std::vector<bool> kept(
+      previous_keys.empty() ? 0 : previous_keys.rbegin()->first + 1, false);
+  for (auto &&vertex : next_keys) {
+    auto const found = identifiers.find(vertex.second.key);
+    if (identifiers.end() == found) {
+      diff.added_vertices.emplace_back(vertex.first);
+      continue;
+    }
+
+    diff.previous[vertex.first] = found->second;
+    kept[found->second] = true;
+    if (is_changed(previous.nodes,
+                   previous_keys.at(found->second).attributes, next.nodes,
+                   vertex.second.attributes))
+      diff.changed_vertices.emplace_back(vertex.first);
+  }
+
+  for (auto &&vertex : previous_keys) {
+    if (!kept[vertex.first])
+      diff.removed_vertices.emplace_back(vertex.first);
+  }
+}
+
+EdgeDistances create_edge_distances(PetriNetEdges const &edges,
+                                    VertexKeys const &keys) {
+  EdgeDistances distances;
+  std::map<std::pair<VertexKey, VertexKey>, std::size_t> occurrences;
+
+  for (auto i = 0u; i < edges.sources.size(); ++i) {
+    auto const &source = keys.at(edges.sources[i]).key;
+    auto const &target = keys.at(edges.targets[i]).key;
+    auto const occurrence = occurrences[{source, target}]++;
+    distances.emplace(EdgeKey{source, target, occurrence},
+                      std::make_pair(i, edges.distances[i]));
+  }
+  return std::move(distances);
+}
+
+void copy_edge(PetriNetEdges &output, PetriNetEdges const &edges,
+               std::size_t index) {
+  add_edge(output, edges.sources[index], edges.targets[index],
+           edges.distances[index]);
+}
+
+PetriNetEdgeDiff diff_edges(PetriNetEdges const &previous,
+                            VertexKeys const &previous_keys,
+                            PetriNetEdges const &next,
+                            VertexKeys const &next_keys) {
+  PetriNetEdgeDiff diff;
+  auto const previous_distances =
+      create_edge_distances(previous, previous_keys);
+  auto const next_distances = create_edge_distances(next, next_keys);
+
+  for (auto &&edge : next_distances) {
+    auto const found = previous_distances.find(edge.first);
+    if (previous_distances.end() == found)
+      copy_edge(diff.added, next, edge.second.first);
+    else if (found->second.second != edge.second.second)
+      copy_edge(diff.changed, next, edge.second.first);
+  }
+
+  for (auto &&edge : previous_distances) {
+    if (!next_distances.count(edge.first))
+      copy_edge(diff.removed, previous, edge.second.first);
+  }
+  return std::move(diff);
+}
+
+} // namespace
+
+namespace Project {
+namespace Naturality {
+
+PetriNetDiff diff_petri_nets(PetriNet const &previous, PetriNet const &next) {
+  auto const previous_keys = create_vertex_keys(previous);
+  auto const next_keys = create_vertex_keys(next);
+
+  PetriNetDiff diff;
+  diff_vertices(diff, previous, previous_keys, next, next_keys);
+  diff.incoming_edges = diff_edges(previous.incoming_edges, previous_keys,
+                                   next.incoming_edges, next_keys);
+  diff.outgoing_edges = diff_edges(previous.outgoing_edges, previous_keys,
+                                   next.outgoing_edges, next_keys);
+  diff.invisible_edges = diff_edges(previous.invisible_edges, previous_keys,
+                                    next.invisible_edges, next_keys);
+  return std::move(diff);
+}
+
+} // namespace Naturality
+} // namespace Project
@@ -0,0 +1,352 @@
+#include "naturality/petri_net_layout.hpp"
+#include "naturality/parallel_for.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <numeric>
+#include <optional>
+
+namespace {
+
+using namespace Project::Naturality;
+
+constexpr std::size_t parallel_threshold = 256;
+constexpr std::size_t max_tree_depth = 32;
+constexpr double alpha_min = 0.001;
+
+struct Point {
+  double x;
+  double y;
+};
+
+struct Link {
+  std::size_t other;
+  double distance;
+  double strength;
+};
+
+struct LayoutGraph {
+  std::vector<std::size_t> offsets;
+  std::vector<Link> links;
+  std::vector<std::optional<double>> layers;
+};
+
+struct QuadCell {
+  Point centre;
+  double size;
+  double weight;
+  std::size_t first;
+  std::size_t last;
+  std::size_t next;
+  bool leaf;
+};
+
+struct QuadTree {
+  std::vector<QuadCell> cells;
+  std::vector<std::size_t> order;
+};
+
+template <typename Function>
+void for_each_vertex(std::size_t size, bool parallel,
+                     Function const &function) {
+  if (parallel && size >= parallel_threshold)
+    return parallel_for(size, function);
+
+  for (auto i = 0u; i < size; ++i)
+    function(i);
+}
+
+template <typename Function>
+void for_each_edge(PetriNet const &net, Function const &function) {
+  for (auto edges : {&net.incoming_edges, &net.outgoing_edges,
+                     &net.invisible_edges}) {
+    for (auto i = 0u; i < edges->sources.size(); ++i)
+      function(edges->sources[i], edges->targets[i], edges->distances[i]);
+  }
+}
+
+std::vector<std::size_t> vertex_degrees(PetriNet const &net,
+                                        std::size_t vertices) {
+  std::vector<std::size_t> degrees(vertices, 0);
+  for_each_edge(net, [&](std::size_t source, std::size_t target, double) {
+    ++degrees[source];
+    ++degrees[target];
+  });
+  return std::move(degrees);
+}
+
+void add_link(LayoutGraph &graph, std::vector<std::size_t> &positions,
+              std::vector<std::size_t> const &degrees, std::size_t vertex,
+              std::size_t other, double distance) {
+  auto const strength = 1.0 / std::min(degrees[vertex], degrees[other]);
+  auto const weight = static_cast<double>(degrees[other]) /
+                      (degrees[vertex] + degrees[other]);
+  graph.links[positions[vertex]++] = {other, distance, strength * weight};
+}
+
+void add_links(LayoutGraph &graph, PetriNet const &net,
+               PetriNetLayoutOptions const &options,
+               std::vector<std::size_t> const &degrees) {
+  graph.offsets.assign(degrees.size() + 1, 0);
+  std::partial_sum(degrees.begin(), degrees.end(), graph.offsets.begin() + 1);
+  graph.links.resize(graph.offsets.back());
+
+  auto positions = graph.offsets;
+  for_each_edge(net, [&](std::size_t source, std::size_t target,
+                         double distance) {
+    auto const length = distance * options.link_distance;
+    add_link(graph, positions, degrees, source, target, length);
+    add_link(graph, positions, degrees, target, source, length);
+  });
+}
+
+void add_layers(LayoutGraph &graph, PetriNet const &net,
+                PetriNetLayoutOptions const &options, std::size_t vertices) {
+  auto const &nodes = net.nodes;
+  auto const groups = nodes.offsets.empty() ? 0 : nodes.offsets.size() - 1;
+  auto const middle = (static_cast<double>(groups) - 1.0) / 2.0;
+
+  graph.layers.assign(vertices, std::nullopt);
+  for (auto group = 0u; group < groups; ++group) {
+    auto const x = (group - middle) * options.layer_spacing;
+    for (auto i = nodes.offsets[group]; i < nodes.offsets[group + 1]; ++i)
+      graph.layers[nodes.identifiers[i]] = x;
+  }
+}
+
+LayoutGraph create_layout_graph(PetriNet const &net,
+                                PetriNetLayoutOptions const &options,
+                                std::size_t vertices) {
+  LayoutGraph graph;
+  add_links(graph, net, options, vertex_degrees(net, vertices));
+  add_layers(graph, net, options, vertices);
+  return std::move(graph);
+}
+
+std::vector<Point> initial_positions(std::size_t vertices) {
+  auto const angle = M_PI * (3.0 - std::sqrt(5.0));
+  std::vector<Point> positions(vertices);
+  for (auto i = 0u; i < vertices; ++i) {
+    auto const radius = 10.0 * std::sqrt(0.5 + i);
+    positions[i] = {radius * std::cos(i * angle), radius * std::sin(i * angle)};
+  }
+  return std::move(positions);
+}
+
+Point centre_of_mass(QuadTree const &tree, std::vector<Point> const &positions,
+                     std::size_t first, std::size_t last) {
+  Point centre{0.0, 0.0};
+  for (auto i = first; i < last; ++i) {
+    centre.x += positions[tree.order[i]].x;
+    centre.y += positions[tree.order[i]].y;
+  }
+  return {centre.x / (last - first), centre.y / (last - first)};
+}
+
+void build_cell(QuadTree &tree, std::vector<Point> const &positions,
+                std::size_t first, std::size_t last, Point corner,
+                double size, std::size_t depth) {
+  auto const index = tree.cells.size();
+  auto const leaf = 1 == last - first || max_tree_depth == depth;
+  tree.cells.push_back({centre_of_mass(tree, positions, first, last), size,
+                        static_cast<double>(last - first), first, last,
+                        index + 1, leaf});
+  if (leaf)
+    return;
+
+  auto const half = size / 2.0;
+  auto const begin = tree.order.begin();
+  auto const is_top = [&](std::size_t i) {
+    return positions[i].y < corner.y + half;
+  };
+  auto const is_left = [&](std::size_t i) {
+    return positions[i].x < corner.x + half;
+  };
+
+  auto const middle = std::partition(begin + first, begin + last, is_top);
+  std::array<std::size_t, 5> bounds = {
+      first,
+      static_cast<std::size_t>(
+          std::partition(begin + first, middle, is_left) - begin),
+      static_cast<std::size_t>(middle - begin),
+      static_cast<std::size_t>(
+          std::partition(middle, begin + last, is_left) - begin),
+      last};
+
+  for (auto quadrant = 0u; quadrant < 4; ++quadrant) {
+    if (bounds[quadrant] == bounds[quadrant + 1])
+      continue;
+
+    Point const child_corner{corner.x + (quadrant % 2) * half,
+                             corner.y + (quadrant / 2) * half};
+    build_cell(tree, positions, bounds[quadrant], bounds[quadrant + 1],
+               child_corner, half, depth + 1);
+  }
+  tree.cells[index].next = tree.cells.size();
+}
+
+QuadTree build_quad_tree(std::vector<Point> const &positions) {
+  QuadTree tree;
+  tree.order.resize(positions.size());
+  std::iota(tree.order.begin(), tree.order.end(), 0);
+  if (positions.empty())
+    return std::move(tree);
+
+  auto const [min_x, max_x] = std::minmax_element(
+      positions.begin(), positions.end(),
+      [](Point const &a, Point const &b) { return a.x < b.x; });
+  auto const [min_y, max_y] = std::minmax_element(
+      positions.begin(), positions.end(),
+      [](Point const &a, Point const &b) { return a.y < b.y; });
+  auto const size =
+      std::max({max_x->x - min_x->x, max_y->y - min_y->y, 1.0}) * 1.0001;
+
+  build_cell(tree, positions, 0, positions.size(), {min_x->x, min_y->y}, size,
+             0);
+  return std::move(tree);
+}
+
+void add_repulsion(Point &force, Point const &from, Point const &to,
+                   double strength) {
+  auto const dx = to.x - from.x;
+  auto const dy = to.y - from.y;
+  auto distance = dx * dx + dy * dy;
+  if (0.0 == distance)
+    return;
+  if (distance < 1.0)
+    distance = std::sqrt(distance);
+
+  force.x += dx * strength / distance;
+  force.y += dy * strength / distance;
+}
+
+Point calculate_repulsion(QuadTree const &tree,
+                          std::vector<Point> const &positions,
+                          std::size_t vertex, double strength, double theta) {
+  Point force{0.0, 0.0};
+  auto const &position = positions[vertex];
+
+  for (auto index = 0u; index < tree.cells.size();) {
+    auto const &cell = tree.cells[index];
+    auto const dx = cell.centre.x - position.x;
+    auto const dy = cell.centre.y - position.y;
+    auto const distance = dx * dx + dy * dy;
+    auto const far = cell.size * cell.size < theta * theta * distance;
+
+    if (!cell.leaf && !far) {
+      ++index;
+      continue;
+    }
+
+    if (cell.leaf) {
+      for (auto i = cell.first; i < cell.last; ++i) {
+        if (tree.order[i] != vertex)
+          add_repulsion(force, position, positions[tree.order[i]], strength);
+      }
+    } else
+      add_repulsion(force, position, cell.centre, strength * cell.weight);
+    index = cell.next;
+  }
+  return force;
+}
+
+Point calculate_attraction(LayoutGraph const &graph,
+                           std::vector<Point> const &positions,
+                           std::size_t vertex) {
+  Point force{0.0, 0.0};
+  auto const &position = positions[vertex];
+
+  for (auto i = graph.offsets[vertex]; i < graph.offsets[vertex + 1]; ++i) {
+    auto const &link = graph.links[i];
+    auto const dx = positions[link.other].x - position.x;
+    auto const dy = positions[link.other].y - position.y;
+    auto const length = std::sqrt(dx * dx + dy * dy);
+    if (0.0 == length)
+      continue;
+
+    auto const scale = (length - link.distance) / length * link.strength;
+    force.x += dx * scale;
+    force.y += dy * scale;
+  }
+  return force;
+}
+
+void update_velocity(Point &velocity, LayoutGraph const &graph,
+                     QuadTree const &tree, std::vector<Point> const &positions,
+                     std::size_t vertex, double alpha,
+                     PetriNetLayoutOptions const &options) {
+  auto const repulsion = calculate_repulsion(
+      tree, positions, vertex, -options.repulsion * alpha, options.theta);
+  auto const attraction = calculate_attraction(graph, positions, vertex);
+
+  velocity.x += repulsion.x + attraction.x * alpha;
+  velocity.y += repulsion.y + attraction.y * alpha;
+  if (auto const &layer = graph.layers[vertex]) {
+    auto const offset = *layer - positions[vertex].x;
+    velocity.x += offset * options.layer_strength * alpha;
+  }
+
+  velocity.x *= 1.0 - options.velocity_decay;
+  velocity.y *= 1.0 - options.velocity_decay;
+}
+
+void move_vertices(std::vector<Point> &positions,
+                   std::vector<Point> const &velocities) {
+  Point mean{0.0, 0.0};
+  for (auto i = 0u; i < positions.size(); ++i) {
+    positions[i].x += velocities[i].x;
+    positions[i].y += velocities[i].y;
+    mean.x += positions[i].x;
+    mean.y += positions[i].y;
+  }
+
+  for (auto &&position : positions) {
+    position.x -= mean.x / positions.size();
+    position.y -= mean.y / positions.size();
+  }
+}
+
+std::vector<double> flatten_positions(std::vector<Point> const &positions) {
+  std::vector<double> flattened;
+  flattened.reserve(2 * positions.size());
+  for (auto &&position : positions) {
+    flattened.emplace_back(position.x);
+    flattened.emplace_back(position.y);
+  }
+  return std::move(flattened);
+}
+
+} // namespace
+
+namespace Project {
+namespace Naturality {
+
+std::vector<double> layout_petri_net(PetriNet const &net,
+                                     PetriNetLayoutOptions const &options) {
+  auto const vertices = number_of_vertices(net);
+  auto const graph = create_layout_graph(net, options, vertices);
+  auto positions = initial_positions(vertices);
+  std::vector<Point> velocities(vertices, {0.0, 0.0});
+
+  auto const iterations = std::max<std::size_t>(options.iterations, 1);
+  auto const alpha_decay = 1.0 - std::pow(alpha_min, 1.0 / iterations);
+  auto alpha = 1.0;
+
+  // Each tick is d3-force's damped explicit Euler step: forces are added to
+  // the velocities, the velocities decay, and the positions move by them.
+  for (auto iteration = 0u; iteration < iterations && vertices > 0;
+       ++iteration) {
+    alpha -= alpha * alpha_decay;
+    auto const tree = build_quad_tree(positions);
+    for_each_vertex(vertices, options.parallel, [&](std::size_t vertex) {
+      update_velocity(velocities[vertex], graph, tree, positions, vertex, alpha,
+                      options);
+    });
+    move_vertices(positions, velocities);
+  }
+  return flatten_positions(positions);
+}
+
+} // namespace Naturality
+} // namespace Project
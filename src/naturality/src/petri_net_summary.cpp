@@ -0,0 +1,179 @@
+#include "naturality/petri_net_summary.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <numeric>
+#include <set>
+
+namespace {
+
+using namespace Project::Naturality;
+using namespace Project::Types;
+
+constexpr std::size_t collapsed = std::numeric_limits<std::size_t>::max();
+
+std::size_t number_of_groups(std::vector<std::size_t> const &offsets) {
+  return offsets.empty() ? 0 : offsets.size() - 1;
+}
+
+std::size_t number_of_regions(std::vector<std::size_t> const &offsets) {
+  std::size_t regions = 0;
+  for (auto group = 0u; group < number_of_groups(offsets); ++group)
+    regions += offsets[group + 1] > offsets[group] ? 1 : 0;
+  return regions;
+}
+
+std::vector<std::size_t>
+expand_groups(std::vector<std::size_t> const &offsets,
+              std::vector<std::size_t> const &expanded, std::size_t &budget) {
+  std::vector<std::size_t> shown(number_of_groups(offsets), collapsed);
+
+  for (auto it = expanded.rbegin(); it != expanded.rend(); ++it) {
+    auto const group = *it;
+    if (group >= shown.size() || collapsed != shown[group])
+      continue;
+
+    auto const size = offsets[group + 1] - offsets[group];
+    if (size <= budget + 1) {
+      shown[group] = size;
+      budget -= size > 0 ? size - 1 : 0;
+    } else {
+      shown[group] = budget;
+      budget = 0;
+    }
+  }
+  return std::move(shown);
+}
+
+std::size_t shown_end(std::vector<std::size_t> const &offsets,
+                      std::vector<std::size_t> const &shown,
+                      std::size_t group) {
+  if (collapsed == shown[group])
+    return offsets[group];
+  return offsets[group] + shown[group];
+}
+
+std::size_t add_vertex(PetriNetSummary &summary, std::size_t multiplicity) {
+  summary.multiplicities.emplace_back(multiplicity);
+  return summary.multiplicities.size() - 1;
+}
+
+void add_node(PetriNetNodes &nodes, std::size_t identifier, std::size_t type,
+              Variance variance, std::size_t count) {
+  nodes.identifiers.emplace_back(identifier);
+  nodes.types.emplace_back(type);
+  nodes.variances.emplace_back(variance);
+  nodes.counts.emplace_back(count);
+}
+
+Variance summarise_variance(PetriNetNodes const &nodes, std::size_t first,
+                            std::size_t last) {
+  auto const variance = nodes.variances[first];
+  auto const uniform =
+      std::all_of(nodes.variances.begin() + first,
+                  nodes.variances.begin() + last,
+                  [&](Variance other) { return variance == other; });
+  return uniform ? variance : Variance::BIVARIANCE;
+}
+
+void summarise_transitions(PetriNetSummary &summary, PetriNet const &net,
+                           std::vector<std::size_t> const &shown,
+                           std::vector<std::size_t> &vertices) {
+  auto const &offsets = net.transition_offsets;
+  summary.net.transition_offsets = {0};
+
+  for (auto group = 0u; group < number_of_groups(offsets); ++group) {
+    auto const split = shown_end(offsets, shown, group);
+    for (auto i = offsets[group]; i < split; ++i)
+      vertices[i] = add_vertex(summary, 1);
+
+    if (split < offsets[group + 1]) {
+      auto const vertex = add_vertex(summary, offsets[group + 1] - split);
+      for (auto i = split; i < offsets[group + 1]; ++i)
+        vertices[i] = vertex;
+    }
+    summary.net.transition_offsets.emplace_back(summary.multiplicities.size());
+  }
+}
+
+void summarise_nodes(PetriNetSummary &summary, PetriNet const &net,
+                     std::vector<std::size_t> const &shown,
+                     std::vector<std::size_t> &vertices) {
+  auto const &nodes = net.nodes;
+  auto &summary_nodes = summary.net.nodes;
+  summary_nodes.offsets = {0};
+
+  for (auto group = 0u; group < number_of_groups(nodes.offsets); ++group) {
+    auto const split = shown_end(nodes.offsets, shown, group);
+    auto const last = nodes.offsets[group + 1];
+
+    for (auto i = nodes.offsets[group]; i < split; ++i) {
+      auto const vertex = add_vertex(summary, 1);
+      add_node(summary_nodes, vertex, nodes.types[i], nodes.variances[i],
+               nodes.counts[i]);
+      vertices[nodes.identifiers[i]] = vertex;
+    }
+
+    if (split < last) {
+      auto const vertex = add_vertex(summary, last - split);
+      auto const count = std::accumulate(nodes.counts.begin() + split,
+                                         nodes.counts.begin() + last,
+                                         std::size_t(0));
+      add_node(summary_nodes, vertex, nodes.types[split],
+               summarise_variance(nodes, split, last), count);
+      for (auto i = split; i < last; ++i)
+        vertices[nodes.identifiers[i]] = vertex;
+    }
+    summary_nodes.offsets.emplace_back(summary_nodes.identifiers.size());
+  }
+}
+
+PetriNetEdges summarise_edges(PetriNetEdges const &edges,
+                              std::vector<std::size_t> const &vertices) {
+  PetriNetEdges summary;
+  std::set<std::pair<std::size_t, std::size_t>> added;
+
+  for (auto i = 0u; i < edges.sources.size(); ++i) {
+    auto const source = vertices[edges.sources[i]];
+    auto const target = vertices[edges.targets[i]];
+    if (source != target && added.emplace(source, target).second)
+      add_edge(summary, source, target, edges.distances[i]);
+  }
+  return std::move(summary);
+}
+
+} // namespace
+
+namespace Project {
+namespace Naturality {
+
+PetriNetSummary
+summarise_petri_net(PetriNet const &net,
+                    std::vector<std::size_t> const &expanded_nodes,
+                    std::vector<std::size_t> const &expanded_transitions,
+                    std::size_t limit) {
+  // Collapsed regions are always drawn. Expanded regions share whatever is
+  // left of the limit, most recently expanded first, places before
+  // transitions. A region that does not fit draws part of its vertices and
+  // keeps the rest as one summary vertex.
+  auto const regions = number_of_regions(net.nodes.offsets) +
+                       number_of_regions(net.transition_offsets);
+  auto budget = limit > regions ? limit - regions : 0;
+  auto const shown_nodes =
+      expand_groups(net.nodes.offsets, expanded_nodes, budget);
+  auto const shown_transitions =
+      expand_groups(net.transition_offsets, expanded_transitions, budget);
+
+  PetriNetSummary summary;
+  std::vector<std::size_t> vertices(number_of_vertices(net), 0);
+  summarise_transitions(summary, net, shown_transitions, vertices);
+  summarise_nodes(summary, net, shown_nodes, vertices);
+
+  summary.net.incoming_edges = summarise_edges(net.incoming_edges, vertices);
+  summary.net.outgoing_edges = summarise_edges(net.outgoing_edges, vertices);
+  summary.net.invisible_edges = summarise_edges(net.invisible_edges, vertices);
+  return std::move(summary);
+}
+
+} // namespace Naturality
+} // namespace Project
@@ -1,10 +1,16 @@
 #include "naturality/unify_cospan_with_type.hpp"
 #include "naturality/cospan_equality.hpp"
+#include "naturality/cospan_shared_count.hpp"
 
 #include "polymorphic_types/type_equality.hpp"
 
+#include <algorithm>
+#include <functional>
 #include <numeric>
 #include <optional>
+#include <stdexcept>
+#include <type_traits>
+#include <unordered_map>
 
 namespace {
 
@@ -13,173 +19,347 @@ using namespace Project::Types;
 
 using CospanUnifiers = std::vector<std::vector<std::optional<std::size_t>>>;
 
-void unify_cospan_with_type(CospanUnifiers &, std::vector<std::size_t> &,
+template <bool Const, typename T>
+using Walked = std::conditional_t<Const, T const, T>;
+
+template <typename Leaf, bool Const = false> struct CospanWalk {
+  Leaf &leaf;
+  std::vector<std::size_t> path;
+  char const *reason;
+
+  bool mismatch(char const *mismatch_reason) {
+    reason = mismatch_reason;
+    return false;
+  }
+};
+
+template <typename Leaf, bool Const>
+bool unify_cospan_with_type(CospanWalk<Leaf, Const> &,
                             TypeConstructor::Type const &,
-                            CospanMorphism::Type &);
+                            Walked<Const, CospanMorphism::Type> &);
 
-template <typename T>
-void unify_cospan_with_type_with(CospanUnifiers &, std::vector<std::size_t> &,
-                                 T const &, CospanMorphism::Type &);
+template <typename Leaf, bool Const, typename T>
+bool unify_cospan_with_type_with(CospanWalk<Leaf, Const> &, T const &,
+                                 Walked<Const, CospanMorphism::Type> &);
 
-template <typename T>
-void unify_cospan_with_type_with(CospanUnifiers &, std::vector<std::size_t> &,
+template <typename Leaf, bool Const, typename T>
+bool unify_cospan_with_type_with(CospanWalk<Leaf, Const> &,
                                  TypeConstructor::Type const &, T &);
 
-void unify_constructor_with_morphism(
-    CospanUnifiers &unified, std::vector<std::size_t> &counts,
+template <typename Leaf, bool Const>
+bool unify_constructor_with_morphism(
+    CospanWalk<Leaf, Const> &walk,
     TypeConstructor::ConstructorType const &constructor,
-    std::vector<CospanMorphism::MappedType> &morphism) {
+    Walked<Const, std::vector<CospanMorphism::MappedType>> &morphism) {
   for (auto i = 0u; i < morphism.size(); ++i) {
     auto &cospan_type = morphism[i];
     auto const &type = constructor[i];
 
+    walk.path.emplace_back(i);
     if (cospan_type.variance != type.variance)
-      throw std::runtime_error("variance error");
-    unify_cospan_with_type(unified, counts, type.type, cospan_type.type);
+      return walk.mismatch("variance error");
+    if (!unify_cospan_with_type(walk, type.type, cospan_type.type))
+      return false;
+    walk.path.pop_back();
   }
+  return true;
+}
+
+template <typename Leaf, bool Const>
+bool unify_nested_with_type(CospanWalk<Leaf, Const> &walk,
+                            TypeConstructor::Type const &type,
+                            Walked<Const, CospanMorphism> &morphism) {
+  walk.path.emplace_back(0);
+  if (!unify_cospan_with_type_with(walk, type, morphism))
+    return false;
+  walk.path.pop_back();
+  return true;
+}
+
+template <typename Leaf, bool Const, typename T>
+bool unify_type_with_nested(CospanWalk<Leaf, Const> &walk, T const &type,
+                            Walked<Const, CospanMorphism::Type> &cospan_type) {
+  walk.path.emplace_back(0);
+  if (!unify_cospan_with_type_with(walk, type, cospan_type))
+    return false;
+  walk.path.pop_back();
+  return true;
 }
 
-void unify_constructor_with_morphism(CospanUnifiers &unified,
-                                     std::vector<std::size_t> &counts,
+template <typename Leaf, bool Const>
+bool unify_constructor_with_morphism(CospanWalk<Leaf, Const> &walk,
                                      TypeConstructor const &constructor,
-                                     CospanMorphism &morphism) {
+                                     Walked<Const, CospanMorphism> &morphism) {
   auto const &nested_constructor = get_nested(constructor);
   auto &nested_morphism = get_nested(morphism);
   auto const constructor_size = nested_constructor.type.size();
   auto const morphism_size = nested_morphism.map.size();
 
   if (constructor_size == morphism_size)
-    unify_constructor_with_morphism(unified, counts, nested_constructor.type,
-                                    nested_morphism.map);
+    return unify_constructor_with_morphism(walk, nested_constructor.type,
+                                           nested_morphism.map);
   else if (constructor_size == 1)
-    unify_cospan_with_type_with(
-        unified, counts, nested_constructor.type[0].type, nested_morphism);
+    return unify_nested_with_type(walk, nested_constructor.type[0].type,
+                                  nested_morphism);
   else if (morphism_size == 1)
-    unify_cospan_with_type_with(unified, counts, nested_constructor,
-                                nested_morphism.map[0].type);
-  else
-    throw std::runtime_error("structure error (constructor, morphism)");
+    return unify_type_with_nested(walk, nested_constructor,
+                                  nested_morphism.map[0].type);
+  return walk.mismatch("structure error (constructor, morphism)");
 }
 
-void unify_functor_with_morphism(CospanUnifiers &unified,
-                                 std::vector<std::size_t> &counts,
+template <typename Leaf, bool Const>
+bool unify_functor_with_morphism(CospanWalk<Leaf, Const> &walk,
                                  FunctorTypeConstructor const &functor,
-                                 CospanMorphism &morphism) {
+                                 Walked<Const, CospanMorphism> &morphism) {
   auto &nested_morphism = get_nested(morphism);
   auto const functor_size = functor.type.size();
   auto const morphism_size = nested_morphism.map.size();
 
   if (functor_size == morphism_size)
-    unify_constructor_with_morphism(unified, counts, functor.type,
-                                    nested_morphism.map);
+    return unify_constructor_with_morphism(walk, functor.type,
+                                           nested_morphism.map);
   else if (functor_size == 1)
-    unify_cospan_with_type_with(unified, counts, functor.type[0].type,
-                                nested_morphism);
+    return unify_nested_with_type(walk, functor.type[0].type,
+                                  nested_morphism);
   else if (morphism_size == 1)
-    unify_cospan_with_type_with(unified, counts, functor,
-                                nested_morphism.map[0].type);
-  else
-    throw std::runtime_error("structure error (functor, morphism)");
+    return unify_type_with_nested(walk, functor, nested_morphism.map[0].type);
+  return walk.mismatch("structure error (functor, morphism)");
 }
 
-void unify_identifier_with(CospanUnifiers &unified,
-                           std::vector<std::size_t> &counts,
-                           std::size_t identifier, std::size_t &cospan_value) {
-  auto &identifier_unified = unified[identifier];
-  auto &count = counts[identifier];
+struct ValidateValues {
+  std::size_t total_number_of_identifiers;
 
-  if (auto const value = identifier_unified[cospan_value])
-    cospan_value = *value;
-  else {
-    identifier_unified[cospan_value] = count;
-    cospan_value = count++;
+  bool operator()(std::size_t, std::size_t const &cospan_value) {
+    return cospan_value < total_number_of_identifiers;
   }
-}
 
-struct UnifyCospanWithType {
+  bool operator()(std::size_t, CospanMorphism::PairType const &) {
+    return true;
+  }
+};
+
+struct UnifyIdentifiers {
+  CospanUnifiers &unified;
+  std::vector<std::size_t> &counts;
+
+  bool operator()(std::size_t identifier, std::size_t &cospan_value) {
+    auto &identifier_unified = unified[identifier];
+    auto &count = counts[identifier];
+
+    if (cospan_value >= identifier_unified.size())
+      return false;
+
+    if (auto const value = identifier_unified[cospan_value])
+      cospan_value = *value;
+    else {
+      identifier_unified[cospan_value] = count;
+      cospan_value = count++;
+    }
+    return true;
+  }
+
+  bool operator()(std::size_t, CospanMorphism::PairType &) { return true; }
+};
+
+struct CollectValues {
+  std::vector<std::vector<std::size_t>> &values;
+
+  bool operator()(std::size_t identifier, std::size_t &cospan_value) {
+    values[identifier].emplace_back(cospan_value);
+    return true;
+  }
+
+  bool operator()(std::size_t identifier, CospanMorphism::PairType &pair) {
+    values[identifier].emplace_back(pair.first);
+    values[identifier].emplace_back(pair.second);
+    return true;
+  }
+};
+
+struct RenumberValues {
+  std::vector<std::vector<std::size_t>> const &values;
 
-  void operator()(CospanUnifiers &unified, std::vector<std::size_t> &counts,
-                  std::size_t identifier, std::size_t &cospan_value) const {
-    unify_identifier_with(unified, counts, identifier, cospan_value);
+  std::size_t renumber(std::size_t identifier, std::size_t value) const {
+    auto const &used = values[identifier];
+    return std::lower_bound(used.begin(), used.end(), value) - used.begin();
   }
 
-  void operator()(CospanUnifiers &unified, std::vector<std::size_t> &counts,
+  bool operator()(std::size_t identifier, std::size_t &cospan_value) {
+    cospan_value = renumber(identifier, cospan_value);
+    return true;
+  }
+
+  bool operator()(std::size_t identifier, CospanMorphism::PairType &pair) {
+    pair.first = renumber(identifier, pair.first);
+    pair.second = renumber(identifier, pair.second);
+    return true;
+  }
+};
+
+struct CanonicalValues {
+  std::vector<std::unordered_map<std::size_t, std::size_t>> &labels;
+
+  std::size_t label(std::size_t identifier, std::size_t value) {
+    auto &identifier_labels = labels[identifier];
+    auto const label_count = identifier_labels.size();
+    return identifier_labels.emplace(value, label_count).first->second;
+  }
+
+  bool operator()(std::size_t identifier, std::size_t &cospan_value) {
+    cospan_value = label(identifier, cospan_value);
+    return true;
+  }
+
+  bool operator()(std::size_t identifier, CospanMorphism::PairType &pair) {
+    pair.first = label(identifier, pair.first);
+    pair.second = label(identifier, pair.second);
+    return true;
+  }
+};
+
+struct CollectIdentifiers {
+  std::vector<std::size_t> &identifiers;
+
+  bool operator()(std::size_t identifier, std::size_t &) {
+    identifiers.emplace_back(identifier);
+    return true;
+  }
+
+  bool operator()(std::size_t, CospanMorphism::PairType &) { return true; }
+};
+
+struct AssignValues {
+  std::vector<std::size_t> const &values;
+  std::size_t index;
+
+  bool operator()(std::size_t, std::size_t &cospan_value) {
+    cospan_value = values[index++];
+    return true;
+  }
+
+  bool operator()(std::size_t, CospanMorphism::PairType &) { return true; }
+};
+
+template <bool Const> struct UnifyCospanWithType {
+  template <typename T> using Part = Walked<Const, T>;
+
+  template <typename Leaf>
+  bool operator()(CospanWalk<Leaf, Const> &walk, std::size_t identifier,
+                  Part<std::size_t> &cospan_value) const {
+    return walk.leaf(identifier, cospan_value) ||
+           walk.mismatch("cospan value out of range");
+  }
+
+  template <typename Leaf>
+  bool operator()(CospanWalk<Leaf, Const> &walk, std::size_t identifier,
+                  Part<CospanMorphism::PairType> &pair) const {
+    return walk.leaf(identifier, pair) ||
+           walk.mismatch("cospan value out of range");
+  }
+
+  template <typename Leaf>
+  bool operator()(CospanWalk<Leaf, Const> &walk,
                   TypeConstructor const &constructor,
-                  CospanMorphism &morphism) const {
-    unify_constructor_with_morphism(unified, counts, constructor, morphism);
+                  Part<CospanMorphism> &morphism) const {
+    return unify_constructor_with_morphism(walk, constructor, morphism);
   }
 
-  void operator()(CospanUnifiers &unified, std::vector<std::size_t> &counts,
+  template <typename Leaf>
+  bool operator()(CospanWalk<Leaf, Const> &walk,
                   FunctorTypeConstructor const &functor,
-                  CospanMorphism &morphism) const {
-    unify_functor_with_morphism(unified, counts, functor, morphism);
+                  Part<CospanMorphism> &morphism) const {
+    return unify_functor_with_morphism(walk, functor, morphism);
   }
 
-  template <typename T>
-  void operator()(CospanUnifiers &unified, std::vector<std::size_t> &counts,
-                  T const &type, CospanMorphism &morphism) const {
-    auto const &nested = get_nested(morphism);
+  template <typename Leaf, typename T>
+  bool operator()(CospanWalk<Leaf, Const> &walk, T const &type,
+                  Part<CospanMorphism> &morphism) const {
+    auto &nested = get_nested(morphism);
     if (nested.map.size() != 1)
-      throw std::runtime_error("structure error (type, morphism)");
-    unify_cospan_with_type_with(unified, counts, type, nested.map[0]);
+      return walk.mismatch("structure error (type, morphism)");
+    return unify_type_with_nested(walk, type, nested.map[0].type);
   }
 
-  template <typename T>
-  void operator()(CospanUnifiers &unified, std::vector<std::size_t> &counts,
-                  TypeConstructor const &constructor, T &cospan_type) const {
+  template <typename Leaf, typename T>
+  bool operator()(CospanWalk<Leaf, Const> &walk,
+                  TypeConstructor const &constructor,
+                  T &cospan_type) const {
     auto const &nested = get_nested(constructor);
     if (nested.type.size() != 1)
-      throw std::runtime_error("structure error (constructor, type)");
-    unify_cospan_with_type_with(unified, counts, nested.type[0].type,
-                                cospan_type);
+      return walk.mismatch("structure error (constructor, type)");
+    return unify_cospan_with_type_with(walk, nested.type[0].type,
+                                       cospan_type);
   }
 
-  template <typename T>
-  void operator()(CospanUnifiers &unified, std::vector<std::size_t> &counts,
-                  FunctorTypeConstructor const &functor, T &cospan_type) const {
+  template <typename Leaf, typename T>
+  bool operator()(CospanWalk<Leaf, Const> &walk,
+                  FunctorTypeConstructor const &functor,
+                  T &cospan_type) const {
     if (functor.type.size() != 1)
-      throw std::runtime_error("structure error (functor, type)");
-    unify_cospan_with_type_with(unified, counts, functor.type[0].type,
-                                cospan_type);
+      return walk.mismatch("structure error (functor, type)");
+    return unify_cospan_with_type_with(walk, functor.type[0].type,
+                                       cospan_type);
   }
 
-  template <typename T, typename U>
-  void operator()(CospanUnifiers &, std::vector<std::size_t> &, T const &,
-                  U &) const {}
+  template <typename Leaf, typename T, typename U>
+  bool operator()(CospanWalk<Leaf, Const> &, T const &, U &) const {
+    return true;
+  }
 
-} _unify_cospan_with_type;
+};
 
-void unify_cospan_with_type(CospanUnifiers &unified,
-                            std::vector<std::size_t> &count,
+template <typename Leaf, bool Const>
+bool unify_cospan_with_type(CospanWalk<Leaf, Const> &walk,
                             TypeConstructor::Type const &type,
-                            CospanMorphism::Type &cospan_type) {
-  return std::visit(std::bind(_unify_cospan_with_type, std::ref(unified),
-                              std::ref(count), std::placeholders::_1,
-                              std::placeholders::_2),
+                            Walked<Const, CospanMorphism::Type> &cospan_type) {
+  return std::visit(std::bind(UnifyCospanWithType<Const>(), std::ref(walk),
+                              std::placeholders::_1, std::placeholders::_2),
                     type, cospan_type);
 }
 
-template <typename T>
-void unify_cospan_with_type_with(CospanUnifiers &unified,
-                                 std::vector<std::size_t> &count, T const &type,
-                                 CospanMorphism::Type &cospan_type) {
-  return std::visit(std::bind(_unify_cospan_with_type, std::ref(unified),
-                              std::ref(count), std::cref(type),
-                              std::placeholders::_1),
+template <typename Leaf, bool Const, typename T>
+bool unify_cospan_with_type_with(
+    CospanWalk<Leaf, Const> &walk, T const &type,
+    Walked<Const, CospanMorphism::Type> &cospan_type) {
+  return std::visit(std::bind(UnifyCospanWithType<Const>(), std::ref(walk),
+                              std::cref(type), std::placeholders::_1),
                     cospan_type);
 }
 
-template <typename T>
-void unify_cospan_with_type_with(CospanUnifiers &unified,
-                                 std::vector<std::size_t> &count,
+template <typename Leaf, bool Const, typename T>
+bool unify_cospan_with_type_with(CospanWalk<Leaf, Const> &walk,
                                  TypeConstructor::Type const &type,
                                  T &cospan_type) {
-  return std::visit(std::bind(_unify_cospan_with_type, std::ref(unified),
-                              std::ref(count), std::placeholders::_1,
-                              std::ref(cospan_type)),
+  return std::visit(std::bind(UnifyCospanWithType<Const>(), std::ref(walk),
+                              std::placeholders::_1, std::ref(cospan_type)),
                     type);
 }
 
+template <typename Leaf, typename Cospan>
+std::optional<CospanMismatch>
+walk_cospan_with_type(Leaf &leaf, NaturalTransformation const &transformation,
+                      Cospan &cospan) {
+  if (cospan.domains.size() != transformation.domains.size())
+    return CospanMismatch{0, {}, "number of domains differ"};
+
+  CospanWalk<Leaf, std::is_const<Cospan>::value> walk{leaf, {}, nullptr};
+  for (auto i = 0u; i < transformation.domains.size(); ++i) {
+    if (!unify_constructor_with_morphism(walk, transformation.domains[i],
+                                         cospan.domains[i]))
+      return CospanMismatch{i, std::move(walk.path), walk.reason};
+  }
+  return std::nullopt;
+}
+
+template <typename Leaf>
+void unify_cospan_with_type(Leaf &leaf,
+                            NaturalTransformation const &transformation,
+                            CospanStructure &cospan) {
+  if (auto const mismatch =
+          walk_cospan_with_type(leaf, transformation, cospan))
+    throw std::runtime_error(mismatch->reason);
+}
+
 template <typename T>
 std::vector<std::vector<T>> create_vector(std::size_t outer_size,
                                           std::size_t inner_size,
@@ -196,19 +376,98 @@ std::vector<std::vector<T>> create_vector(std::size_t outer_size,
 namespace Project {
 namespace Naturality {
 
-std::vector<std::size_t>
-unify_cospan_with_type(NaturalTransformation const &transformation,
-                       CospanStructure &cospan) {
+std::optional<CospanMismatch>
+validate_cospan(NaturalTransformation const &transformation,
+                CospanStructure const &cospan) {
+  ValidateValues validate{cospan.total_number_of_identifiers};
+  return walk_cospan_with_type(validate, transformation, cospan);
+}
+
+CospanUnification
+try_unify_cospan_with_type(NaturalTransformation const &transformation,
+                           CospanStructure &cospan) {
   CospanUnifiers unified = create_vector(
       transformation.symbols.size(), cospan.total_number_of_identifiers,
       std::optional<std::size_t>(std::nullopt));
   std::vector<std::size_t> count(transformation.symbols.size(), 0);
 
-  for (auto i = 0u; i < transformation.domains.size(); ++i)
-    unify_constructor_with_morphism(unified, count, transformation.domains[i],
-                                    cospan.domains[i]);
+  UnifyIdentifiers unify{unified, count};
+  if (auto mismatch = walk_cospan_with_type(unify, transformation, cospan))
+    return std::move(*mismatch);
   return std::move(count);
 }
 
+std::vector<std::size_t>
+unify_cospan_with_type(NaturalTransformation const &transformation,
+                       CospanStructure &cospan) {
+  return get_checked(try_unify_cospan_with_type(transformation, cospan));
+}
+
+std::vector<std::size_t>
+compact_cospan_values(NaturalTransformation const &transformation,
+                      CospanStructure &cospan) {
+  std::vector<std::vector<std::size_t>> values(transformation.symbols.size());
+  CollectValues collect{values};
+  unify_cospan_with_type(collect, transformation, cospan);
+
+  std::vector<std::size_t> counts;
+  counts.reserve(values.size());
+  for (auto &&used : values) {
+    std::sort(used.begin(), used.end());
+    used.erase(std::unique(used.begin(), used.end()), used.end());
+    counts.emplace_back(used.size());
+  }
+
+  RenumberValues renumber{values};
+  unify_cospan_with_type(renumber, transformation, cospan);
+
+  cospan.shared_counts = shared_count(cospan.domains);
+  cospan.total_number_of_identifiers =
+      counts.empty() ? 0 : *std::max_element(counts.begin(), counts.end());
+  return std::move(counts);
+}
+
+std::vector<std::size_t>
+canonicalize_cospan(NaturalTransformation const &transformation,
+                    CospanStructure &cospan) {
+  std::vector<std::unordered_map<std::size_t, std::size_t>> labels(
+      transformation.symbols.size());
+  CanonicalValues canonical{labels};
+  unify_cospan_with_type(canonical, transformation, cospan);
+
+  std::vector<std::size_t> counts;
+  counts.reserve(labels.size());
+  for (auto &&identifier_labels : labels)
+    counts.emplace_back(identifier_labels.size());
+
+  cospan.shared_counts = shared_count(cospan.domains);
+  cospan.total_number_of_identifiers =
+      counts.empty() ? 0 : *std::max_element(counts.begin(), counts.end());
+  return std::move(counts);
+}
+
+std::size_t canonical_hash(NaturalTransformation const &transformation,
+                           CospanStructure const &cospan) {
+  auto canonical = cospan;
+  canonicalize_cospan(transformation, canonical);
+  return hash_value(canonical);
+}
+
+std::vector<std::size_t>
+cospan_value_identifiers(NaturalTransformation const &transformation,
+                         CospanStructure &cospan) {
+  std::vector<std::size_t> identifiers;
+  CollectIdentifiers collect{identifiers};
+  unify_cospan_with_type(collect, transformation, cospan);
+  return std::move(identifiers);
+}
+
+void assign_cospan_values(NaturalTransformation const &transformation,
+                          CospanStructure &cospan,
+                          std::vector<std::size_t> const &values) {
+  AssignValues assign{values, 0};
+  unify_cospan_with_type(assign, transformation, cospan);
+}
+
 } // namespace Naturality
 } // namespace Project
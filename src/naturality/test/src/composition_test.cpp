@@ -1,10 +1,34 @@
 #include "composition_test.hpp"
 
+#include "naturality/compact_cospan.hpp"
+#include "naturality/composition_cache.hpp"
+#include "naturality/composition_store.hpp"
+#include "naturality/cospan_composition.hpp"
+#include "naturality/cospan_enumeration.hpp"
+#include "naturality/cospan_equality.hpp"
+#include "naturality/cospan_shared_count.hpp"
+#include "naturality/cospan_zip.hpp"
 #include "naturality/natural_composition.hpp"
+#include "naturality/petri_net.hpp"
+#include "naturality/petri_net_acyclicity.hpp"
+#include "naturality/petri_net_chunks.hpp"
+#include "naturality/petri_net_diff.hpp"
+#include "naturality/petri_net_layout.hpp"
+#include "naturality/petri_net_summary.hpp"
+#include "naturality/unify_cospan_with_type.hpp"
 
 #include "polymorphic_types/type_to_string.hpp"
 
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
 #include <iostream>
+#include <limits>
+#include <map>
+#include <random>
+#include <set>
+#include <tuple>
 
 using namespace Project::Types;
 using namespace Project::Naturality;
@@ -45,11 +69,11 @@ TypeConstructor single_covariant_type(std::size_t identifier) {
 TypeConstructor single_covariant_type() { return single_covariant_type(0); }
 
 TypeConstructor single_pair_type() {
-  return {{{pair_functor(1, 0), Variance::COVARIANCE}}};
+  return {{{pair_functor(0, 0), Variance::COVARIANCE}}};
 }
 
 TypeConstructor pair_type() {
-  return {{{pair_functor(2, 0, 1), Variance::COVARIANCE}}};
+  return {{{pair_functor(0, 0, 1), Variance::COVARIANCE}}};
 }
 
 TypeConstructor identity_function() {
@@ -72,13 +96,13 @@ TypeConstructor true_function() {
 
 FunctorTypeConstructor application_functor(std::size_t functor) {
   return {
-      {{general_function(), Variance::COVARIANCE}, {0, Variance::COVARIANCE}},
+      {{general_function(), Variance::COVARIANCE}, create_covariant_type(0)},
       functor};
 }
 
 FunctorTypeConstructor application_diagonal_functor(std::size_t functor) {
-  return {{{0, Variance::COVARIANCE},
-           {0, Variance::COVARIANCE},
+  return {{create_covariant_type(0),
+           create_covariant_type(0),
            {general_function(), Variance::COVARIANCE}},
           functor};
 }
@@ -92,8 +116,8 @@ TypeConstructor application_diagonal_type(std::size_t functor) {
 }
 
 FunctorTypeConstructor evaluation_and_id_functor(std::size_t functor) {
-  return {{{0, Variance::COVARIANCE},
-           {0, Variance::COVARIANCE},
+  return {{create_covariant_type(0),
+           create_covariant_type(0),
            {general_function(), Variance::COVARIANCE}},
           functor};
 }
@@ -123,14 +147,15 @@ NaturalTransformation y_combinator() {
 }
 
 NaturalTransformation diagonal() {
-  return NaturalTransformation{{single_covariant_type(), single_pair_type()},
-                               {"a", "f"}};
+  return NaturalTransformation{
+      {single_covariant_type(), single_pair_type()}, {"a"}, {"f"}};
 }
 
 NaturalTransformation diagonal_and_function() {
   return NaturalTransformation{
-      {application_type(2), application_diagonal_type(3)},
-      {"a", "b", "Pair", "Tuple"}};
+      {application_type(0), application_diagonal_type(1)},
+      {"a", "b"},
+      {"Pair", "Tuple"}};
 }
 
 NaturalTransformation y_combinator_identity() {
@@ -147,8 +172,178 @@ NaturalTransformation true_transformation() {
 }
 
 NaturalTransformation evaluation_map_and_id() {
-  return NaturalTransformation{{evaluation_and_id_type(3), pair_type()},
-                               {"a", "b", "Pair", "Tuple"}};
+  return NaturalTransformation{{evaluation_and_id_type(1), pair_type()},
+                               {"a", "b"},
+                               {"Pair", "Tuple"}};
+}
+
+Unification unify_transformations(NaturalTransformation const &left,
+                                  NaturalTransformation const &right) {
+  return *calculate_unification(left.domains.back(), right.domains.front(),
+                                left.symbols.size(), right.symbols.size(),
+                                left.functor_symbols.size(),
+                                right.functor_symbols.size());
+}
+
+CospanStructure default_cospan(NaturalTransformation const &transformation) {
+  return create_default_cospan(transformation.domains.front(),
+                               transformation.domains.back());
+}
+
+::testing::AssertionResult is_equal_cospans(CospanStructure const &left,
+                                            CospanStructure const &right) {
+  if (left.domains.size() != right.domains.size())
+    return ::testing::AssertionFailure() << "Differing number of domains";
+
+  for (auto i = 0u; i < left.domains.size(); ++i) {
+    if (!is_equal(left.domains[i], right.domains[i]))
+      return ::testing::AssertionFailure() << "Domain " << i << " differs";
+  }
+
+  if (left.shared_counts != right.shared_counts)
+    return ::testing::AssertionFailure() << "Shared counts differ";
+  return ::testing::AssertionSuccess();
+}
+
+void expect_compact_substitution(CospanStructure const &cospan,
+                                 NaturalTransformation const &transformation,
+                                 SubstitutionTemplates const &templates,
+                                 std::size_t identifiers) {
+  auto structured_substitution =
+      create_empty_substitution(transformation, identifiers);
+  auto compact_substitution =
+      create_empty_substitution(transformation, identifiers);
+
+  for (auto i = 0u; i < cospan.domains.size(); ++i) {
+    auto const structured =
+        cospan_substitution(structured_substitution, templates,
+                            cospan.domains[i], transformation.domains[i]);
+    auto const compact = cospan_substitution(
+        compact_substitution, templates, to_compact(cospan.domains[i]),
+        transformation.domains[i]);
+    EXPECT_TRUE(is_equal(from_compact(compact), structured));
+    EXPECT_TRUE(is_equal(compact, to_compact(structured)));
+  }
+}
+
+using GluedVertex = std::tuple<std::size_t, std::size_t, std::size_t>;
+
+struct GluedGraph {
+  std::map<GluedVertex, std::size_t> vertices;
+  std::vector<std::set<std::size_t>> successors;
+  std::vector<std::vector<std::size_t>> boundaries;
+  std::size_t length;
+};
+
+std::size_t glued_vertex(GluedGraph &graph, GluedVertex const &key) {
+  auto const found = graph.vertices.find(key);
+  if (graph.vertices.end() != found)
+    return found->second;
+
+  graph.successors.emplace_back();
+  return graph.vertices[key] = graph.successors.size() - 1;
+}
+
+void glue_link(GluedGraph &graph, std::vector<PetriNet> const &nets) {
+  std::map<std::size_t, std::size_t> transitions;
+  std::vector<std::vector<std::size_t>> boundaries;
+
+  for (auto type = 0u; type < nets.size(); ++type) {
+    auto const &nodes = nets[type].nodes;
+    std::map<std::size_t, std::size_t> places;
+    for (auto group = 0u; group + 1 < nodes.offsets.size(); ++group) {
+      for (auto i = nodes.offsets[group]; i < nodes.offsets[group + 1]; ++i) {
+        auto const identifier = nodes.identifiers[i];
+        places[identifier] =
+            0 == group && graph.length > 0
+                ? graph.boundaries[type][i - nodes.offsets[0]]
+                : glued_vertex(graph, {graph.length, type, identifier});
+      }
+    }
+
+    auto const vertex = [&](std::size_t identifier) {
+      if (places.count(identifier))
+        return places[identifier];
+      return glued_vertex(graph,
+                          {graph.length, transition_type, identifier});
+    };
+    for (auto edges : {&nets[type].incoming_edges,
+                       &nets[type].outgoing_edges}) {
+      for (auto i = 0u; i < edges->sources.size(); ++i) {
+        auto const source = vertex(edges->sources[i]);
+        auto const target = vertex(edges->targets[i]);
+        graph.successors[source].insert(target);
+      }
+    }
+
+    boundaries.emplace_back();
+    auto const groups = nodes.offsets.size() - 1;
+    for (auto i = nodes.offsets[groups - 1]; i < nodes.offsets[groups]; ++i)
+      boundaries.back().emplace_back(places[nodes.identifiers[i]]);
+  }
+
+  graph.boundaries = std::move(boundaries);
+  ++graph.length;
+}
+
+bool reaches_cycle(GluedGraph const &graph, std::vector<int> &colours,
+                   std::size_t vertex) {
+  colours[vertex] = 1;
+  for (auto &&successor : graph.successors[vertex]) {
+    if (1 == colours[successor] ||
+        (0 == colours[successor] &&
+         reaches_cycle(graph, colours, successor)))
+      return true;
+  }
+  colours[vertex] = 2;
+  return false;
+}
+
+bool has_cycle(GluedGraph const &graph) {
+  std::vector<int> colours(graph.successors.size(), 0);
+  for (auto vertex = 0u; vertex < colours.size(); ++vertex) {
+    if (0 == colours[vertex] && reaches_cycle(graph, colours, vertex))
+      return true;
+  }
+  return false;
+}
+
+bool is_cycle(GluedGraph const &graph,
+              std::vector<PetriNetVertex> const &cycle) {
+  std::vector<std::size_t> vertices;
+  for (auto &&vertex : cycle)
+    vertices.emplace_back(
+        graph.vertices.at({vertex.link, vertex.type, vertex.identifier}));
+
+  for (auto i = 0u; i < vertices.size(); ++i) {
+    auto const next = vertices[(i + 1) % vertices.size()];
+    if (!graph.successors[vertices[i]].count(next))
+      return false;
+  }
+  return !vertices.empty();
+}
+
+PetriNet random_link(std::mt19937 &random, std::size_t transitions,
+                     std::size_t glued, std::size_t boundary) {
+  PetriNet net;
+  net.transition_offsets = {0, transitions};
+  net.nodes.offsets = {0};
+  for (auto size : {glued, boundary}) {
+    for (auto i = 0u; i < size; ++i)
+      net.nodes.identifiers.emplace_back(transitions +
+                                         net.nodes.identifiers.size());
+    net.nodes.offsets.emplace_back(net.nodes.identifiers.size());
+  }
+
+  std::uniform_int_distribution<std::size_t> transition(0, transitions - 1);
+  std::bernoulli_distribution incoming(0.5);
+  for (auto &&place : net.nodes.identifiers) {
+    if (incoming(random))
+      add_edge(net.incoming_edges, place, transition(random), 2.0);
+    else
+      add_edge(net.outgoing_edges, transition(random), place, 2.0);
+  }
+  return std::move(net);
 }
 
 } // namespace
@@ -225,3 +420,850 @@ TEST(CompositionTest, EVAL_TRANS_DIAG_TEST) {
             << "\n";
   std::cout << to_string(composite) << "\n";
 }
+
+TEST(CompositionTest, REUSED_LEFT_COMPOSITION_TEST) {
+  auto const left = church_encoding();
+  auto const right = church_encoding();
+  auto const left_cospan = default_cospan(left);
+  auto const right_cospan = default_cospan(right);
+  auto unification = unify_transformations(left, right);
+  auto const composite = compose_transformations(left, right, unification);
+  auto const identifiers = composite.symbols.size();
+
+  auto const full = compose_cospans(left_cospan, right_cospan, left, right,
+                                    unification, identifiers);
+  auto const templates = create_composition_templates(unification);
+  auto const left_composition =
+      compose_left_cospan(left_cospan, left, templates, identifiers);
+  auto const reused = compose_cospans(left_composition, left_cospan,
+                                      right_cospan, left, right, templates);
+
+  EXPECT_TRUE(is_equal_cospans(full.cospan, reused.cospan));
+  EXPECT_EQ(full.value_count, reused.value_count);
+}
+
+TEST(CompositionTest, BATCHED_COMPOSITION_TEST) {
+  auto const left = church_encoding();
+  auto const right = church_encoding();
+  auto unification = unify_transformations(left, right);
+  auto const composite = compose_transformations(left, right, unification);
+  auto const identifiers = composite.symbols.size();
+
+  auto const accept = [](CospanStructure const &) { return true; };
+  auto const enumerated = enumerate_cospans(left, 3, accept, false);
+  ASSERT_GE(enumerated.size(), 3);
+
+  CospanPairs cospans;
+  for (auto i = 0u; i < 8; ++i)
+    cospans.emplace_back(enumerated[i % enumerated.size()],
+                         enumerated[(3 * i + 1) % enumerated.size()]);
+
+  auto mismatched = enumerated[0];
+  auto &morphism = mismatched.domains.front().map;
+  morphism.emplace_back(morphism.back());
+  cospans.emplace_back(mismatched, enumerated[1]);
+
+  auto const sequential =
+      compose_cospans(cospans, left, right, unification, identifiers, false);
+  auto const parallel =
+      compose_cospans(cospans, left, right, unification, identifiers, true);
+
+  ASSERT_EQ(sequential.size(), cospans.size());
+  ASSERT_EQ(parallel.size(), cospans.size());
+  for (auto i = 0u; i + 1 < cospans.size(); ++i) {
+    auto const expected =
+        compose_cospans(cospans[i].first, cospans[i].second, left, right,
+                        unification, identifiers);
+    auto const &in_sequence = std::get<CompositionResult>(sequential[i]);
+    auto const &in_parallel = std::get<CompositionResult>(parallel[i]);
+    EXPECT_TRUE(is_equal_cospans(expected.cospan, in_sequence.cospan));
+    EXPECT_TRUE(is_equal_cospans(expected.cospan, in_parallel.cospan));
+    EXPECT_EQ(expected.value_count, in_sequence.value_count);
+    EXPECT_EQ(expected.value_count, in_parallel.value_count);
+  }
+  EXPECT_FALSE(
+      is_equal_cospans(std::get<CompositionResult>(sequential[0]).cospan,
+                       std::get<CompositionResult>(sequential[1]).cospan));
+
+  auto const mismatch = std::get_if<CospanMismatch>(&parallel.back());
+  ASSERT_NE(mismatch, nullptr);
+  EXPECT_EQ(mismatch->domain, 0u);
+  EXPECT_TRUE(std::holds_alternative<CospanMismatch>(sequential.back()));
+  EXPECT_THROW(compose_cospans(cospans.back().first, cospans.back().second,
+                               left, right, unification, identifiers),
+               std::runtime_error);
+}
+
+TEST(CompositionTest, PARALLEL_COMPOSITION_TEST) {
+  std::vector<std::pair<NaturalTransformation, NaturalTransformation>> const
+      transformations{{church_encoding(), church_encoding()},
+                      {evaluation_map(), evaluation_map()},
+                      {diagonal(), diagonal()},
+                      {diagonal_and_function(), evaluation_map_and_id()}};
+
+  for (auto &&transformation : transformations) {
+    auto const &left = transformation.first;
+    auto const &right = transformation.second;
+    auto const left_cospan = default_cospan(left);
+    auto const right_cospan = default_cospan(right);
+    auto unification = unify_transformations(left, right);
+    auto const composite = compose_transformations(left, right, unification);
+    auto const identifiers = composite.symbols.size();
+    auto const templates = create_composition_templates(unification);
+
+    auto const sequential = compose_cospans(
+        left_cospan, right_cospan, left, right, templates, identifiers, false);
+    auto const parallel = compose_cospans(left_cospan, right_cospan, left,
+                                          right, templates, identifiers, true);
+
+    EXPECT_TRUE(is_equal_cospans(sequential.cospan, parallel.cospan));
+    EXPECT_EQ(sequential.value_count, parallel.value_count);
+  }
+}
+
+TEST(CompositionTest, COMPACT_COSPAN_TEST) {
+  std::vector<std::pair<NaturalTransformation, NaturalTransformation>> const
+      transformations{{church_encoding(), church_encoding()},
+                      {evaluation_map(), evaluation_map()},
+                      {diagonal(), diagonal()},
+                      {diagonal_and_function(), evaluation_map_and_id()}};
+
+  for (auto &&transformation : transformations) {
+    auto const &left = transformation.first;
+    auto const &right = transformation.second;
+    auto const cospan = default_cospan(left);
+    auto unification = unify_transformations(left, right);
+    auto const composite = compose_transformations(left, right, unification);
+    auto const identifiers = composite.symbols.size();
+    auto const templates = create_composition_templates(unification);
+    auto const result =
+        compose_cospans(cospan, default_cospan(right), left, right,
+                        templates, identifiers)
+            .cospan;
+    auto const compact = to_compact(result.domains);
+
+    for (auto i = 0u; i < compact.size(); ++i) {
+      EXPECT_TRUE(is_equal(from_compact(compact[i]), result.domains[i]));
+      EXPECT_TRUE(is_equal(compact[i], compact[i]));
+    }
+    EXPECT_EQ(shared_count(compact), shared_count(result.domains));
+    EXPECT_EQ(hash_value(to_compact(result)), hash_value(result));
+    EXPECT_TRUE(is_equal(to_compact(from_compact(to_compact(result))),
+                         to_compact(result)));
+    EXPECT_TRUE(is_equal(
+        zip_cospan_morphisms(compact.front(), compact.front()),
+        to_compact(zip_cospan_morphisms(result.domains.front(),
+                                        result.domains.front()))));
+
+    expect_compact_substitution(cospan, left, templates.left, identifiers);
+
+    auto composite_unification = unify_transformations(composite, composite);
+    auto const recomposite =
+        compose_transformations(composite, composite, composite_unification);
+    expect_compact_substitution(
+        result, composite,
+        create_substitution_templates(composite_unification.left),
+        recomposite.symbols.size());
+  }
+}
+
+TEST(CompositionTest, INCREMENTAL_SHARED_COUNT_TEST) {
+  auto const left = diagonal_and_function();
+  auto const right = evaluation_map_and_id();
+  auto unification = unify_transformations(left, right);
+  auto const composite = compose_transformations(left, right, unification);
+  auto const result =
+      compose_cospans(default_cospan(left), default_cospan(right), left, right,
+                      unification, composite.symbols.size());
+
+  auto domains = result.cospan.domains;
+  auto bounds = morphism_bounds(domains);
+  auto counts = shared_count(bounds);
+  EXPECT_EQ(counts, result.cospan.shared_counts);
+  EXPECT_EQ(counts, shared_count(to_compact(domains)));
+
+  for (auto i = 0u; i < domains.size(); ++i) {
+    domains[i] = CospanMorphism{{{std::size_t{i + 3}, Variance::COVARIANCE}}};
+    bounds[i] = morphism_bounds(domains[i]);
+    update_shared_count(counts, bounds, i);
+    EXPECT_EQ(counts, shared_count(domains));
+  }
+}
+
+TEST(CompositionTest, COSPAN_COMPACTION_TEST) {
+  std::vector<std::pair<NaturalTransformation, NaturalTransformation>> const
+      transformations{{church_encoding(), church_encoding()},
+                      {evaluation_map(), evaluation_map()},
+                      {diagonal(), diagonal()},
+                      {diagonal_and_function(), evaluation_map_and_id()}};
+
+  for (auto &&transformation : transformations) {
+    auto const &left = transformation.first;
+    auto const &right = transformation.second;
+    auto unification = unify_transformations(left, right);
+    auto const composite = compose_transformations(left, right, unification);
+    auto result =
+        compose_cospans(default_cospan(left), default_cospan(right), left,
+                        right, unification, composite.symbols.size());
+
+    auto compacted = result.cospan;
+    auto const counts = compact_cospan_values(composite, compacted);
+    ASSERT_EQ(counts.size(), composite.symbols.size());
+    EXPECT_EQ(compacted.total_number_of_identifiers,
+              *std::max_element(counts.begin(), counts.end()));
+    EXPECT_EQ(compacted.shared_counts, shared_count(compacted.domains));
+    for (auto i = 0u; i < counts.size(); ++i)
+      EXPECT_LE(counts[i], result.value_count[i]);
+
+    auto recompacted = compacted;
+    EXPECT_EQ(compact_cospan_values(composite, recompacted), counts);
+    EXPECT_TRUE(is_equal_cospans(compacted, recompacted));
+  }
+}
+
+TEST(CompositionTest, COSPAN_ENUMERATION_TEST) {
+  std::vector<NaturalTransformation> const transformations{
+      church_encoding(), evaluation_map(), diagonal(),
+      diagonal_and_function(), evaluation_map_and_id()};
+  auto const accept = [](CospanStructure const &) { return true; };
+
+  for (auto &&transformation : transformations) {
+    for (auto maximum_values = 1u; maximum_values <= 3; ++maximum_values) {
+      auto const sequential =
+          enumerate_cospans(transformation, maximum_values, accept, false);
+      auto const parallel =
+          enumerate_cospans(transformation, maximum_values, accept, true);
+      ASSERT_EQ(sequential.size(), parallel.size());
+
+      for (auto i = 0u; i < sequential.size(); ++i) {
+        EXPECT_TRUE(is_equal_cospans(sequential[i], parallel[i]));
+
+        auto canonical = sequential[i];
+        unify_cospan_with_type(transformation, canonical);
+        EXPECT_TRUE(is_equal_cospans(sequential[i], canonical));
+
+        for (auto j = 0u; j < i; ++j)
+          EXPECT_FALSE(is_equal_cospans(sequential[i], sequential[j]));
+      }
+    }
+  }
+
+  auto const transformation = diagonal_and_function();
+  CospanEnumerator enumerator(transformation, 2);
+  auto const first = enumerator.next();
+  ASSERT_TRUE(first.has_value());
+  EXPECT_EQ(first->domains.size(), transformation.domains.size());
+}
+
+TEST(CompositionTest, COSPAN_VALIDATION_TEST) {
+  auto const transformation = diagonal_and_function();
+  auto cospan = create_default_cospan(transformation.domains);
+  EXPECT_FALSE(validate_cospan(transformation, cospan).has_value());
+
+  auto unification = try_unify_cospan_with_type(transformation, cospan);
+  ASSERT_TRUE(std::holds_alternative<std::vector<std::size_t>>(unification));
+
+  NaturalTransformation const function{
+      {identity_function(), identity_function()}, {"a"}, {}};
+  auto mismatched = create_default_cospan(function.domains);
+  mismatched.domains.back().map.back().variance = Variance::CONTRAVARIANCE;
+  auto const mismatch = validate_cospan(function, mismatched);
+  ASSERT_TRUE(mismatch.has_value());
+  EXPECT_EQ(mismatch->domain, 1u);
+  EXPECT_EQ(mismatch->path, std::vector<std::size_t>{1});
+  EXPECT_TRUE(std::holds_alternative<CospanMismatch>(
+      try_unify_cospan_with_type(function, mismatched)));
+  EXPECT_THROW(unify_cospan_with_type(function, mismatched),
+               std::runtime_error);
+
+  auto const net = try_create_petri_net(function.domains, mismatched, 1, 0);
+  auto const net_mismatch = std::get_if<CospanMismatch>(&net);
+  ASSERT_NE(net_mismatch, nullptr);
+  EXPECT_EQ(net_mismatch->domain, 1u);
+  EXPECT_EQ(net_mismatch->path, std::vector<std::size_t>{1});
+  EXPECT_THROW(create_petri_net(function.domains, mismatched, 1, 0),
+               std::runtime_error);
+
+  auto const &left_domain = mismatched.domains.front();
+  auto const zipped = try_zip_cospan_morphisms(left_domain, CospanMorphism{});
+  EXPECT_TRUE(std::holds_alternative<CospanMismatch>(zipped));
+  EXPECT_THROW(zip_cospan_morphisms(left_domain, CospanMorphism{}),
+               std::runtime_error);
+
+  auto truncated = cospan;
+  truncated.domains.pop_back();
+  EXPECT_TRUE(validate_cospan(transformation, truncated).has_value());
+
+  auto out_of_range = cospan;
+  out_of_range.total_number_of_identifiers = 0;
+  EXPECT_TRUE(validate_cospan(transformation, out_of_range).has_value());
+}
+
+TEST(CompositionTest, CANONICAL_LABELLING_TEST) {
+  auto const transformation = diagonal_and_function();
+  auto cospan = create_default_cospan(transformation.domains);
+  auto const identifiers = cospan_value_identifiers(transformation, cospan);
+
+  std::vector<std::size_t> values;
+  std::vector<std::size_t> relabelled;
+  for (auto i = 0u; i < identifiers.size(); ++i) {
+    values.emplace_back((i * 5 + 1) % 3);
+    relabelled.emplace_back(10 + 2 * identifiers[i] - values.back());
+  }
+
+  auto left = cospan;
+  auto right = cospan;
+  assign_cospan_values(transformation, left, values);
+  assign_cospan_values(transformation, right, relabelled);
+  EXPECT_NE(hash_value(left), hash_value(right));
+  EXPECT_EQ(canonical_hash(transformation, left),
+            canonical_hash(transformation, right));
+
+  auto const left_counts = canonicalize_cospan(transformation, left);
+  auto const right_counts = canonicalize_cospan(transformation, right);
+  EXPECT_EQ(left_counts, right_counts);
+  EXPECT_TRUE(is_equal_cospans(left, right));
+  EXPECT_EQ(hash_value(left), hash_value(right));
+
+  auto const accept = [](CospanStructure const &) { return true; };
+  for (auto &&enumerated : enumerate_cospans(transformation, 2, accept)) {
+    auto canonical = enumerated;
+    canonicalize_cospan(transformation, canonical);
+    EXPECT_TRUE(is_equal_cospans(enumerated, canonical));
+  }
+}
+
+TEST(CompositionTest, COMPOSITION_CACHE_TEST) {
+  auto const left = church_encoding();
+  auto const right = church_encoding();
+  auto const left_cospan = default_cospan(left);
+  auto const right_cospan = default_cospan(right);
+  auto unification = unify_transformations(left, right);
+  auto const composite = compose_transformations(left, right, unification);
+  auto const expected =
+      compose_cospans(left_cospan, right_cospan, left, right, unification,
+                      composite.symbols.size());
+
+  CompositionCache cache(std::numeric_limits<std::size_t>::max());
+  auto const first = cache.compose(left, left_cospan, right, right_cospan);
+  auto const second = cache.compose(left, left_cospan, right, right_cospan);
+  EXPECT_EQ(first, second);
+  EXPECT_EQ(debug_string(composite), debug_string(first->transformation));
+  EXPECT_TRUE(is_equal_cospans(expected.cospan, first->result.cospan));
+  EXPECT_EQ(expected.value_count, first->result.value_count);
+
+  auto relabelled = left_cospan;
+  auto values = cospan_value_identifiers(left, relabelled);
+  for (auto &&value : values)
+    value += 3;
+  assign_cospan_values(left, relabelled, values);
+  EXPECT_EQ(first, cache.find(left, relabelled, right, right_cospan));
+
+  auto statistics = cache.statistics();
+  EXPECT_EQ(2, statistics.hits);
+  EXPECT_EQ(1, statistics.misses);
+  EXPECT_EQ(1, statistics.entries);
+  EXPECT_EQ(0, statistics.evictions);
+
+  auto const identity = identity_transformation();
+  auto const identity_cospan = default_cospan(identity);
+  EXPECT_EQ(nullptr, cache.find(left, left_cospan, identity, identity_cospan));
+  EXPECT_LT(memory_footprint(identity), memory_footprint(left));
+  cache.set_memory_limit(statistics.memory_footprint);
+  cache.compose(identity, identity_cospan, identity, identity_cospan);
+
+  statistics = cache.statistics();
+  EXPECT_EQ(1, statistics.entries);
+  EXPECT_EQ(1, statistics.evictions);
+  EXPECT_EQ(nullptr, cache.find(left, left_cospan, right, right_cospan));
+  EXPECT_NE(nullptr, cache.find(identity, identity_cospan, identity,
+                                identity_cospan));
+
+  cache.set_memory_limit(0);
+  EXPECT_EQ(0, cache.statistics().entries);
+  EXPECT_EQ(0, cache.statistics().memory_footprint);
+}
+
+TEST(CompositionTest, COMPOSITION_STORE_TEST) {
+  auto const left = church_encoding();
+  auto const right = church_encoding();
+  auto const left_cospan = default_cospan(left);
+  auto const right_cospan = default_cospan(right);
+  auto const path = testing::TempDir() + "composition_store_test.cache";
+  std::remove(path.c_str());
+
+  CompositionCache cache(std::numeric_limits<std::size_t>::max());
+  cache.set_store(std::make_shared<CompositionStore>(path));
+  auto const expected = cache.compose(left, left_cospan, right, right_cospan);
+
+  CompositionCache restarted(std::numeric_limits<std::size_t>::max());
+  restarted.set_store(std::make_shared<CompositionStore>(path));
+  auto const stored = restarted.find(left, left_cospan, right, right_cospan);
+  ASSERT_NE(nullptr, stored);
+  EXPECT_EQ(1, restarted.statistics().store_hits);
+  EXPECT_EQ(debug_string(expected->transformation),
+            debug_string(stored->transformation));
+  EXPECT_EQ(expected->transformation.symbols, stored->transformation.symbols);
+  EXPECT_TRUE(
+      is_equal_cospans(expected->result.cospan, stored->result.cospan));
+  EXPECT_EQ(expected->result.value_count, stored->result.value_count);
+
+  std::string contents;
+  {
+    std::ifstream input(path, std::ios::binary);
+    contents.assign(std::istreambuf_iterator<char>(input),
+                    std::istreambuf_iterator<char>());
+  }
+  auto const corrupt = [&](std::size_t position) {
+    auto damaged = contents;
+    damaged[position] ^= 0x5A;
+    std::ofstream(path, std::ios::binary | std::ios::trunc) << damaged;
+    return CompositionStore(path).size();
+  };
+  EXPECT_EQ(0, corrupt(contents.size() - 1));
+  EXPECT_EQ(0, corrupt(8));
+
+  CompositionStore store(path);
+  auto const key =
+      create_composition_key(left, left_cospan, right, right_cospan);
+  store.append(key, *expected);
+  EXPECT_EQ(1, CompositionStore(path).size());
+
+  auto const record_size = [&]() {
+    std::ifstream input(path, std::ios::binary | std::ios::ate);
+    return static_cast<std::size_t>(input.tellg());
+  };
+  auto const limit = 4 * record_size();
+  std::remove(path.c_str());
+
+  CompositionStore capped(path, limit);
+  std::vector<CompositionKey> keys;
+  for (auto i = 0u; i < 20; ++i) {
+    keys.emplace_back(key);
+    keys.back().left.symbols = {"a" + std::to_string(i)};
+    keys.back().hash = hash_value(keys.back());
+    capped.append(keys.back(), *expected);
+    EXPECT_LE(record_size(), limit);
+  }
+  EXPECT_LT(capped.size(), keys.size());
+  EXPECT_TRUE(capped.find(keys.back()));
+  EXPECT_FALSE(capped.find(keys.front()));
+
+  CompositionStore reopened(path, limit);
+  EXPECT_EQ(capped.size(), reopened.size());
+  EXPECT_TRUE(reopened.find(keys.back()));
+  std::remove(path.c_str());
+}
+
+TEST(CompositionTest, PETRI_NET_TEST) {
+  auto const transformation = church_encoding();
+  auto const net = create_petri_net(transformation.domains,
+                                    default_cospan(transformation), 1, 0);
+
+  std::vector<std::size_t> const offsets = {0, 2, 4};
+  std::vector<std::size_t> const identifiers = {1, 2, 3, 4};
+  std::vector<std::size_t> const counts = {0, 1, 1, 0};
+  std::vector<Variance> const variances = {
+      Variance::CONTRAVARIANCE, Variance::COVARIANCE, Variance::CONTRAVARIANCE,
+      Variance::COVARIANCE};
+  EXPECT_EQ(offsets, net.nodes.offsets);
+  EXPECT_EQ(identifiers, net.nodes.identifiers);
+  EXPECT_EQ(counts, net.nodes.counts);
+  EXPECT_EQ(variances, net.nodes.variances);
+  EXPECT_EQ(std::vector<std::size_t>(4, 0), net.nodes.types);
+  EXPECT_EQ(std::vector<std::size_t>({0, 1}), net.transition_offsets);
+
+  EXPECT_EQ(std::vector<std::size_t>({2, 3}), net.incoming_edges.sources);
+  EXPECT_EQ(std::vector<std::size_t>({0, 0}), net.incoming_edges.targets);
+  EXPECT_EQ(std::vector<std::size_t>({0, 0}), net.outgoing_edges.sources);
+  EXPECT_EQ(std::vector<std::size_t>({1, 4}), net.outgoing_edges.targets);
+  EXPECT_EQ(std::vector<std::size_t>({1, 3}), net.invisible_edges.sources);
+  EXPECT_EQ(std::vector<std::size_t>({2, 4}), net.invisible_edges.targets);
+  EXPECT_EQ(std::vector<double>({1.0, 1.0}), net.invisible_edges.distances);
+
+  auto const evaluation = evaluation_map();
+  auto const filtered = create_petri_net(evaluation.domains,
+                                         default_cospan(evaluation), 1, 1);
+  EXPECT_EQ(std::vector<std::size_t>({0, 1, 2}), filtered.nodes.offsets);
+  EXPECT_EQ(std::vector<std::size_t>({1, 1}), filtered.nodes.types);
+
+  auto const expect_equal_edges = [](PetriNetEdges const &left,
+                                     PetriNetEdges const &right) {
+    EXPECT_EQ(left.sources, right.sources);
+    EXPECT_EQ(left.targets, right.targets);
+    EXPECT_EQ(left.distances, right.distances);
+  };
+
+  std::vector<std::size_t> const transitions = {2, 3};
+  auto const nets = create_petri_nets(evaluation.domains,
+                                      default_cospan(evaluation), transitions);
+  ASSERT_EQ(transitions.size(), nets.size());
+  for (auto i = 0u; i < nets.size(); ++i) {
+    auto const expected = create_petri_net(
+        evaluation.domains, default_cospan(evaluation), transitions[i], i);
+    EXPECT_EQ(expected.nodes.identifiers, nets[i].nodes.identifiers);
+    EXPECT_EQ(expected.nodes.types, nets[i].nodes.types);
+    EXPECT_EQ(expected.nodes.variances, nets[i].nodes.variances);
+    EXPECT_EQ(expected.nodes.counts, nets[i].nodes.counts);
+    EXPECT_EQ(expected.nodes.offsets, nets[i].nodes.offsets);
+    EXPECT_EQ(expected.transition_offsets, nets[i].transition_offsets);
+    expect_equal_edges(expected.incoming_edges, nets[i].incoming_edges);
+    expect_equal_edges(expected.outgoing_edges, nets[i].outgoing_edges);
+    expect_equal_edges(expected.invisible_edges, nets[i].invisible_edges);
+  }
+}
+
+TEST(CompositionTest, PARALLEL_PETRI_NET_TEST) {
+  auto const expect_equal_edges = [](PetriNetEdges const &left,
+                                     PetriNetEdges const &right) {
+    EXPECT_EQ(left.sources, right.sources);
+    EXPECT_EQ(left.targets, right.targets);
+    EXPECT_EQ(left.distances, right.distances);
+  };
+
+  auto const expect_equal_nets = [&](PetriNet const &left,
+                                     PetriNet const &right) {
+    EXPECT_EQ(left.nodes.identifiers, right.nodes.identifiers);
+    EXPECT_EQ(left.nodes.types, right.nodes.types);
+    EXPECT_EQ(left.nodes.variances, right.nodes.variances);
+    EXPECT_EQ(left.nodes.counts, right.nodes.counts);
+    EXPECT_EQ(left.nodes.offsets, right.nodes.offsets);
+    EXPECT_EQ(left.transition_offsets, right.transition_offsets);
+    expect_equal_edges(left.incoming_edges, right.incoming_edges);
+    expect_equal_edges(left.outgoing_edges, right.outgoing_edges);
+    expect_equal_edges(left.invisible_edges, right.invisible_edges);
+  };
+
+  for (auto &&transformation : {church_encoding(), evaluation_map()}) {
+    auto const cospan = default_cospan(transformation);
+    std::vector<std::size_t> const transitions(
+        cospan.shared_counts.size(), 2);
+    auto const sequential =
+        create_petri_nets(transformation.domains, cospan, transitions);
+    auto const parallel =
+        create_petri_nets(transformation.domains, cospan, transitions, true);
+
+    ASSERT_EQ(sequential.size(), parallel.size());
+    for (auto i = 0u; i < sequential.size(); ++i) {
+      expect_equal_nets(sequential[i], parallel[i]);
+      expect_equal_nets(create_petri_net(transformation.domains, cospan,
+                                         transitions[i], i),
+                        create_petri_net(transformation.domains, cospan,
+                                         transitions[i], i, true));
+    }
+  }
+}
+
+TEST(CompositionTest, PETRI_NET_DIFF_TEST) {
+  auto const transformation = church_encoding();
+  auto const cospan = default_cospan(transformation);
+  auto const net = create_petri_net(transformation.domains, cospan, 1, 0);
+
+  auto const unchanged = diff_petri_nets(net, net);
+  EXPECT_EQ(std::vector<std::size_t>({0, 1, 2, 3, 4}), unchanged.previous);
+  EXPECT_TRUE(unchanged.added_vertices.empty());
+  EXPECT_TRUE(unchanged.removed_vertices.empty());
+  EXPECT_TRUE(unchanged.changed_vertices.empty());
+  EXPECT_TRUE(unchanged.incoming_edges.added.sources.empty());
+  EXPECT_TRUE(unchanged.incoming_edges.removed.sources.empty());
+  EXPECT_TRUE(unchanged.invisible_edges.changed.sources.empty());
+
+  auto const created = diff_petri_nets(PetriNet(), net);
+  EXPECT_EQ(std::vector<std::size_t>(5, no_previous_vertex), created.previous);
+  EXPECT_EQ(std::vector<std::size_t>({0, 1, 2, 3, 4}), created.added_vertices);
+  EXPECT_EQ(net.incoming_edges.sources, created.incoming_edges.added.sources);
+  EXPECT_EQ(net.outgoing_edges.targets, created.outgoing_edges.added.targets);
+
+  auto edited = net;
+  edited.nodes.counts[1] = 3;
+  edited.invisible_edges.distances[0] = 4.0;
+  edited.incoming_edges.sources.pop_back();
+  edited.incoming_edges.targets.pop_back();
+  edited.incoming_edges.distances.pop_back();
+
+  auto const diff = diff_petri_nets(net, edited);
+  EXPECT_EQ(std::vector<std::size_t>({2}), diff.changed_vertices);
+  EXPECT_EQ(std::vector<std::size_t>({1}),
+            diff.invisible_edges.changed.sources);
+  EXPECT_EQ(std::vector<double>({4.0}), diff.invisible_edges.changed.distances);
+  EXPECT_EQ(std::vector<std::size_t>({3}), diff.incoming_edges.removed.sources);
+  EXPECT_TRUE(diff.incoming_edges.added.sources.empty());
+  EXPECT_TRUE(diff.removed_vertices.empty());
+
+  auto const shifted = create_petri_net(transformation.domains, cospan, 2, 0);
+  auto const renumbered = diff_petri_nets(net, shifted);
+  EXPECT_EQ(std::vector<std::size_t>({0, no_previous_vertex, 1, 2, 3, 4}),
+            renumbered.previous);
+  EXPECT_TRUE(renumbered.added_vertices.empty());
+  EXPECT_TRUE(renumbered.removed_vertices.empty());
+  EXPECT_TRUE(renumbered.changed_vertices.empty());
+}
+
+TEST(CompositionTest, PETRI_NET_CHUNKS_TEST) {
+  auto const transformation = church_encoding();
+  auto const net = create_petri_net(transformation.domains,
+                                    default_cospan(transformation), 1, 0);
+
+  auto const whole = split_petri_net(net, 100);
+  ASSERT_EQ(3, whole.size());
+  EXPECT_EQ(transition_chunk_group, whole[0].group);
+  EXPECT_EQ(net.transition_offsets, whole[0].net.transition_offsets);
+  EXPECT_EQ(0, whole[1].group);
+  EXPECT_EQ(std::vector<std::size_t>({1, 2}), whole[1].net.nodes.identifiers);
+  EXPECT_EQ(1, whole[2].group);
+  EXPECT_EQ(std::vector<std::size_t>({3, 4}), whole[2].net.nodes.identifiers);
+
+  auto const chunks = split_petri_net(net, 1);
+  ASSERT_EQ(5, chunks.size());
+
+  std::set<std::size_t> delivered;
+  std::size_t edges = 0;
+  for (auto &&chunk : chunks) {
+    if (transition_chunk_group == chunk.group) {
+      for (auto i = 0u; i < chunk.net.transition_offsets.back(); ++i)
+        delivered.insert(i);
+    } else
+      EXPECT_EQ(std::vector<std::size_t>({0, 1}), chunk.net.nodes.offsets);
+    for (auto &&identifier : chunk.net.nodes.identifiers)
+      delivered.insert(identifier);
+
+    for (auto edges_of_kind :
+         {&chunk.net.incoming_edges, &chunk.net.outgoing_edges,
+          &chunk.net.invisible_edges}) {
+      for (auto i = 0u; i < edges_of_kind->sources.size(); ++i) {
+        EXPECT_TRUE(delivered.count(edges_of_kind->sources[i]));
+        EXPECT_TRUE(delivered.count(edges_of_kind->targets[i]));
+        ++edges;
+      }
+    }
+  }
+  EXPECT_EQ(net.incoming_edges.sources.size() +
+                net.outgoing_edges.sources.size() +
+                net.invisible_edges.sources.size(),
+            edges);
+}
+
+TEST(CompositionTest, PETRI_NET_SUMMARY_TEST) {
+  auto const transformation = church_encoding();
+  auto const net = create_petri_net(transformation.domains,
+                                    default_cospan(transformation), 1, 0);
+
+  auto const summary = summarise_petri_net(net, {}, {});
+  EXPECT_EQ(std::vector<std::size_t>({1, 2, 2}), summary.multiplicities);
+  EXPECT_EQ(std::vector<std::size_t>({0, 1, 2}), summary.net.nodes.offsets);
+  EXPECT_EQ(std::vector<std::size_t>({1, 2}), summary.net.nodes.identifiers);
+  EXPECT_EQ(std::vector<std::size_t>({1, 1}), summary.net.nodes.counts);
+  EXPECT_EQ(std::vector<Variance>({Variance::BIVARIANCE, Variance::BIVARIANCE}),
+            summary.net.nodes.variances);
+  EXPECT_EQ(std::vector<std::size_t>({1, 2}),
+            summary.net.incoming_edges.sources);
+  EXPECT_EQ(std::vector<std::size_t>({1, 2}),
+            summary.net.outgoing_edges.targets);
+  EXPECT_TRUE(summary.net.invisible_edges.sources.empty());
+
+  auto const partial = summarise_petri_net(net, {1}, {});
+  EXPECT_EQ(std::vector<std::size_t>({1, 2, 1, 1}), partial.multiplicities);
+  EXPECT_EQ(std::vector<std::size_t>({1, 2, 3}), partial.net.nodes.identifiers);
+  EXPECT_EQ(std::vector<std::size_t>({2}), partial.net.invisible_edges.sources);
+  EXPECT_EQ(std::vector<std::size_t>({3}), partial.net.invisible_edges.targets);
+
+  auto const expanded = summarise_petri_net(net, {0, 1}, {0});
+  EXPECT_EQ(std::vector<std::size_t>(5, 1), expanded.multiplicities);
+  EXPECT_EQ(net.nodes.identifiers, expanded.net.nodes.identifiers);
+  EXPECT_EQ(net.nodes.counts, expanded.net.nodes.counts);
+  EXPECT_EQ(net.transition_offsets, expanded.net.transition_offsets);
+  EXPECT_EQ(net.incoming_edges.sources, expanded.net.incoming_edges.sources);
+  EXPECT_EQ(net.outgoing_edges.targets, expanded.net.outgoing_edges.targets);
+  EXPECT_EQ(net.invisible_edges.sources, expanded.net.invisible_edges.sources);
+
+  EXPECT_EQ(std::vector<std::size_t>({1, 2, 1, 1}),
+            summarise_petri_net(net, {0, 1}, {0}, 4).multiplicities);
+  EXPECT_EQ(std::vector<std::size_t>({1, 1, 1, 2}),
+            summarise_petri_net(net, {1, 0}, {0}, 4).multiplicities);
+  EXPECT_EQ(summary.multiplicities,
+            summarise_petri_net(net, {0, 1}, {0}, 3).multiplicities);
+
+  PetriNet wide;
+  wide.transition_offsets = {0};
+  wide.nodes.offsets = {0, 10};
+  for (auto i = 0u; i < 10; ++i) {
+    wide.nodes.identifiers.emplace_back(i);
+    wide.nodes.types.emplace_back(0);
+    wide.nodes.variances.emplace_back(Variance::COVARIANCE);
+    wide.nodes.counts.emplace_back(1);
+  }
+  auto const bounded = summarise_petri_net(wide, {0}, {}, 4);
+  EXPECT_EQ(std::vector<std::size_t>({1, 1, 1, 7}), bounded.multiplicities);
+  EXPECT_EQ(std::vector<std::size_t>({1, 1, 1, 7}), bounded.net.nodes.counts);
+}
+
+TEST(CompositionTest, PETRI_NET_LAYOUT_TEST) {
+  auto const transformation = church_encoding();
+  auto const net = create_petri_net(transformation.domains,
+                                    default_cospan(transformation), 1, 0);
+  auto const positions = layout_petri_net(net);
+
+  ASSERT_EQ(5, number_of_vertices(net));
+  ASSERT_EQ(10, positions.size());
+  for (auto &&position : positions)
+    EXPECT_TRUE(std::isfinite(position));
+
+  auto const mean_x = [&](std::size_t group) {
+    auto sum = 0.0;
+    for (auto i = net.nodes.offsets[group]; i < net.nodes.offsets[group + 1];
+         ++i)
+      sum += positions[2 * net.nodes.identifiers[i]];
+    return sum / (net.nodes.offsets[group + 1] - net.nodes.offsets[group]);
+  };
+  EXPECT_LT(mean_x(0), mean_x(1));
+
+  PetriNet chain;
+  chain.transition_offsets = {0, 100};
+  chain.nodes.offsets = {0};
+  for (auto group = 0u; group < 4; ++group) {
+    for (auto i = 0u; i < 100; ++i) {
+      auto const identifier = 100 + chain.nodes.identifiers.size();
+      chain.nodes.identifiers.emplace_back(identifier);
+      chain.nodes.types.emplace_back(0);
+      chain.nodes.variances.emplace_back(Variance::COVARIANCE);
+      chain.nodes.counts.emplace_back(0);
+      if (group % 2)
+        add_edge(chain.outgoing_edges, i, identifier, 2.0);
+      else
+        add_edge(chain.incoming_edges, identifier, i, 2.0);
+    }
+    chain.nodes.offsets.emplace_back(chain.nodes.identifiers.size());
+  }
+
+  PetriNetLayoutOptions options;
+  options.iterations = 20;
+  auto const parallel = layout_petri_net(chain, options);
+  options.parallel = false;
+  EXPECT_EQ(layout_petri_net(chain, options), parallel);
+  EXPECT_EQ(1000, parallel.size());
+}
+
+TEST(CompositionTest, PETRI_NET_ACYCLICITY_TEST) {
+  auto const church = church_encoding();
+  std::vector<PetriNet> const church_nets = {
+      create_petri_net(church.domains, default_cospan(church), 1, 0)};
+  EXPECT_TRUE(check_acyclicity(church_nets).acyclic);
+
+  PetriNet loop;
+  loop.transition_offsets = {0, 2};
+  loop.nodes.identifiers = {2, 3};
+  loop.nodes.offsets = {0, 2};
+  add_edge(loop.outgoing_edges, 0, 2, 2.0);
+  add_edge(loop.incoming_edges, 2, 1, 2.0);
+  add_edge(loop.outgoing_edges, 1, 3, 2.0);
+  add_edge(loop.incoming_edges, 3, 0, 2.0);
+  auto const cyclic = check_acyclicity({loop});
+  EXPECT_FALSE(cyclic.acyclic);
+  EXPECT_EQ(4, cyclic.cycle.size());
+
+  AcyclicityChecker checker;
+  EXPECT_TRUE(checker.extend(church_nets).acyclic);
+  auto const composite = checker.extend(church_nets);
+  ASSERT_FALSE(composite.acyclic);
+  ASSERT_EQ(4, composite.cycle.size());
+  std::vector<std::size_t> const links = {0, 0, 0, 1};
+  std::vector<std::size_t> const types = {0, transition_type, 0,
+                                          transition_type};
+  std::vector<std::size_t> const identifiers = {3, 0, 4, 0};
+  for (auto i = 0u; i < composite.cycle.size(); ++i) {
+    EXPECT_EQ(links[i], composite.cycle[i].link);
+    EXPECT_EQ(types[i], composite.cycle[i].type);
+    EXPECT_EQ(identifiers[i], composite.cycle[i].identifier);
+  }
+
+  PetriNet bridge;
+  bridge.transition_offsets = {0, 2};
+  bridge.nodes.identifiers = {2, 3, 4, 5};
+  bridge.nodes.offsets = {0, 2, 4};
+  add_edge(bridge.outgoing_edges, 0, 2, 2.0);
+  add_edge(bridge.incoming_edges, 3, 1, 2.0);
+  add_edge(bridge.incoming_edges, 4, 0, 2.0);
+  add_edge(bridge.outgoing_edges, 1, 5, 2.0);
+
+  AcyclicityChecker chain;
+  chain.extend(church_nets);
+  EXPECT_TRUE(chain.extend({bridge}).acyclic);
+  auto const evaluation = evaluation_map();
+  EXPECT_THROW(chain.extend(create_petri_nets(evaluation.domains,
+                                              default_cospan(evaluation),
+                                              {1, 1})),
+               std::runtime_error);
+  auto const extended = chain.extend(church_nets);
+  EXPECT_EQ(3, chain.length());
+  ASSERT_FALSE(extended.acyclic);
+  EXPECT_EQ(8, extended.cycle.size());
+  std::set<std::size_t> cycle_links;
+  for (auto &&vertex : extended.cycle)
+    cycle_links.insert(vertex.link);
+  EXPECT_EQ(std::set<std::size_t>({0, 1, 2}), cycle_links);
+
+  PetriNet source;
+  source.transition_offsets = {0, 2};
+  source.nodes.identifiers = {2, 4};
+  source.nodes.offsets = {0, 2};
+  add_edge(source.outgoing_edges, 1, 4, 2.0);
+  add_edge(source.outgoing_edges, 1, 2, 2.0);
+
+  PetriNet crossing;
+  crossing.transition_offsets = {0, 2};
+  crossing.nodes.identifiers = {2, 3};
+  crossing.nodes.offsets = {0, 2};
+  add_edge(crossing.incoming_edges, 2, 1, 2.0);
+  add_edge(crossing.incoming_edges, 3, 0, 2.0);
+  add_edge(crossing.outgoing_edges, 0, 2, 2.0);
+  add_edge(crossing.outgoing_edges, 1, 3, 2.0);
+
+  AcyclicityChecker glued;
+  EXPECT_TRUE(glued.extend({source}).acyclic);
+  auto const crossed = glued.extend({crossing});
+  EXPECT_FALSE(crossed.acyclic);
+  EXPECT_EQ(4, crossed.cycle.size());
+
+  NaturalTransformation const identity{
+      {single_covariant_type(), single_covariant_type()}, {"a"}};
+  std::vector<PetriNet> const identity_nets = {
+      create_petri_net(identity.domains, default_cospan(identity), 1, 0)};
+  AcyclicityChecker identities;
+  for (auto i = 0u; i < 1000; ++i)
+    EXPECT_TRUE(identities.extend(identity_nets).acyclic);
+  EXPECT_EQ(1000, identities.length());
+}
+
+TEST(CompositionTest, PETRI_NET_ACYCLICITY_CHAIN_TEST) {
+  std::mt19937 random(50);
+  std::uniform_int_distribution<std::size_t> sizes(0, 3);
+  std::uniform_int_distribution<std::size_t> transitions(1, 3);
+  std::size_t cyclic = 0;
+
+  for (auto chain = 0u; chain < 5000; ++chain) {
+    AcyclicityChecker checker;
+    GluedGraph graph{{}, {}, {}, 0};
+    std::vector<std::size_t> boundaries = {sizes(random), sizes(random)};
+
+    for (auto link = 0u; link < 6; ++link) {
+      auto const count = transitions(random);
+      std::vector<PetriNet> nets;
+      for (auto &&boundary : boundaries) {
+        auto const next = sizes(random);
+        nets.emplace_back(random_link(random, count, boundary, next));
+        boundary = next;
+      }
+
+      auto const result = checker.extend(nets);
+      glue_link(graph, nets);
+      ASSERT_EQ(!has_cycle(graph), result.acyclic)
+          << "chain " << chain << ", link " << link;
+      if (!result.acyclic) {
+        EXPECT_TRUE(is_cycle(graph, result.cycle));
+        ++cyclic;
+        break;
+      }
+    }
+  }
+  EXPECT_GT(cyclic, 0);
+}
@@ -2,6 +2,7 @@ import { Component } from 'react';
 import { Selection } from './selection';
 import { CompositePetriForm } from './composite_petri_form';
 import { IPetriNet, PetriNetDiagram } from './petri_net_diagram';
+import { INode } from './place_nodes';
 
 interface ICompositePetriComponentProps {
   readonly width: number;
@@ -16,6 +17,7 @@ interface ICompositePetriComponentProps {
   readonly transform: string;
   readonly setVariable: (x: string) => any;
   readonly setSVGReference: (x: SVGSVGElement) => void;
+  readonly expandRegion: (node: INode, transition: boolean) => any;
 }
 
 export class CompositePetriComponent extends Component<ICompositePetriComponentProps, {}> {
@@ -41,6 +43,7 @@ export class CompositePetriComponent extends Component<ICompositePetriComponentP
           placeSize={18}
           transitionSize={28}
           setSVGReference={this.props.setSVGReference}
+          onExpand={this.props.expandRegion}
           zIndex={zIndex - 1}
         />
       </div>
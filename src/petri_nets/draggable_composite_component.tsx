@@ -3,6 +3,7 @@ import { DragSource } from 'react-dnd';
 import { Selection } from './selection';
 import { CompositePetriComponent } from './composite_petri_component';
 import { IPetriNet } from '../petri_nets/petri_net_diagram';
+import { INode } from './place_nodes';
 import ItemTypes from './item_types';
 
 interface ICompositeComponent {
@@ -16,6 +17,7 @@ interface ICompositeComponent {
   readonly graph: IPetriNet;
   readonly setVariable: (x: string) => any;
   readonly setSVGReference: (x: SVGSVGElement) => void;
+  readonly expandRegion: (node: INode, transition: boolean) => any;
 };
 
 interface IDraggable {
@@ -76,6 +78,7 @@ class DraggableCompositeComponent extends Component<IDraggableCompositeComponent
           transform={this.props.transform}
           setVariable={this.props.setVariable}
           setSVGReference={this.props.setSVGReference}
+          expandRegion={this.props.expandRegion}
         />
       </div>
     );
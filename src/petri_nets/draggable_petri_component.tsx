@@ -3,6 +3,7 @@ import { DragSource } from 'react-dnd';
 import { Selection } from './selection';
 import { PetriTypeComponent } from './petri_type_component';
 import { IPetriNet } from '../petri_nets/petri_net_diagram';
+import { INode } from './place_nodes';
 import ItemTypes from './item_types';
 
 interface IPetriComponent {
@@ -19,6 +20,7 @@ interface IPetriComponent {
   readonly setTransform: (x:string) => any;
   readonly setVariable: (x: string) => any;
   readonly setSVGReference: (x: SVGSVGElement) => void;
+  readonly expandRegion: (node: INode, transition: boolean) => any;
 };
 
 interface IDraggable {
@@ -85,6 +87,7 @@ class DraggablePetriComponent extends Component<IDraggableTypeComponentProps, {}
           setTransform={this.props.setTransform}
           setVariable={this.props.setVariable}
           setSVGReference={this.props.setSVGReference}
+          expandRegion={this.props.expandRegion}
         />
       </div>
     );
@@ -2,8 +2,18 @@ import { Selection } from './selection';
 import { PetriTypeComponent } from './draggable_petri_component';
 import { INode, IPlaceNode } from './place_nodes';
 import { IEdge } from './edges';
-import { IPetriNet } from './petri_net_diagram';
+import {
+  IPetriNet,
+  IFlatPetriNet,
+  IPetriNetDiff,
+  IPetriNetChunk,
+  IPetriNetSummary,
+  expandFlatPetriNet,
+  expandPetriNetSummary,
+  mergePetriNetChunk,
+  carryPositions,
+} from './petri_net_diagram';
 import { PetriCompositeComponent } from './draggable_composite_component';
 import ItemTypes from './item_types';
 
-export { PetriCompositeComponent, ItemTypes, INode, IPlaceNode, IEdge, IPetriNet, Selection, PetriTypeComponent };
+export { PetriCompositeComponent, ItemTypes, INode, IPlaceNode, IEdge, IPetriNet, IFlatPetriNet, IPetriNetDiff, IPetriNetChunk, IPetriNetSummary, expandFlatPetriNet, expandPetriNetSummary, mergePetriNetChunk, carryPositions, Selection, PetriTypeComponent };
@@ -8,6 +8,152 @@ export interface IPetriNet {
   readonly nodes: IPlaceNode[][];
   readonly transitions: INode[][];
   readonly edges: IEdges;
+  readonly positions?: Float64Array;
+}
+
+export interface IFlatPetriNet {
+  readonly buffer: ArrayBuffer;
+  readonly nodes: {
+    readonly id: Uint32Array;
+    readonly type: Uint32Array;
+    readonly variance: Uint32Array;
+    readonly count: Uint32Array;
+    readonly offsets: Uint32Array;
+  };
+  readonly transitions: Uint32Array;
+  readonly edges: {
+    readonly source: Uint32Array;
+    readonly target: Uint32Array;
+    readonly distance: Float64Array;
+    readonly offsets: Uint32Array;
+  };
+}
+
+export interface IFlatEdges {
+  readonly source: Uint32Array;
+  readonly target: Uint32Array;
+  readonly distance: Float64Array;
+}
+
+export interface IEdgeDiff {
+  readonly added: IFlatEdges;
+  readonly removed: IFlatEdges;
+  readonly changed: IFlatEdges;
+}
+
+export interface IPetriNetDiff {
+  readonly previous: Uint32Array;
+  readonly added: Uint32Array;
+  readonly removed: Uint32Array;
+  readonly changed: Uint32Array;
+  readonly edges: {
+    readonly incoming: IEdgeDiff;
+    readonly outgoing: IEdgeDiff;
+    readonly invisible: IEdgeDiff;
+  };
+}
+
+export interface IPetriNetSummary {
+  readonly summarised: boolean;
+  readonly graph?: IFlatPetriNet;
+  readonly multiplicity?: Uint32Array;
+}
+
+export interface IPetriNetChunk {
+  readonly index: number;
+  readonly count: number;
+  readonly group: number;
+  readonly graph: IFlatPetriNet;
+}
+
+const noPreviousVertex = 0xFFFFFFFF;
+
+function groupBy<T>(offsets: Uint32Array, create: (i: number) => T): T[][] {
+  const groups: T[][] = [];
+  for (let group = 0; group + 1 < offsets.length; group += 1) {
+    const items: T[] = [];
+    for (let i = offsets[group]; i < offsets[group + 1]; i += 1) {
+      items.push(create(i));
+    }
+    groups.push(items);
+  }
+  return groups;
+}
+
+export function expandFlatPetriNet(flat: IFlatPetriNet, positions?: Float64Array): IPetriNet {
+  const { nodes, transitions, edges } = flat;
+  const edgeGroups = groupBy(edges.offsets, i => ({
+    source: edges.source[i],
+    target: edges.target[i],
+    distance: edges.distance[i],
+  }));
+
+  return {
+    nodes: groupBy(nodes.offsets, i => ({
+      id: nodes.id[i],
+      type: nodes.type[i],
+      variance: nodes.variance[i],
+      count: nodes.count[i],
+    })),
+    transitions: groupBy(transitions, id => ({ id })),
+    edges: {
+      incoming: edgeGroups[0],
+      outgoing: edgeGroups[1],
+      invisible: edgeGroups[2],
+    },
+    positions,
+  };
+}
+
+export function expandPetriNetSummary(summary: IPetriNetSummary): IPetriNet {
+  const graph = expandFlatPetriNet(summary.graph);
+  const annotate = (groups: INode[][]) => groups.map((nodes, group) => nodes.map(node => ({
+    ...node,
+    group,
+    multiplicity: summary.multiplicity[node.id],
+  })));
+
+  return {
+    ...graph,
+    nodes: annotate(graph.nodes) as IPlaceNode[][],
+    transitions: annotate(graph.transitions),
+  };
+}
+
+export function mergePetriNetChunk(graph: IPetriNet, chunk: IPetriNetChunk): IPetriNet {
+  const part = expandFlatPetriNet(chunk.graph);
+  const nodes = graph.nodes.slice();
+  if (chunk.group >= 0) {
+    nodes[chunk.group] = (nodes[chunk.group] || []).concat(part.nodes[0]);
+  }
+
+  return {
+    nodes,
+    transitions: chunk.group < 0 ? part.transitions : graph.transitions,
+    edges: {
+      incoming: graph.edges.incoming.concat(part.edges.incoming),
+      outgoing: graph.edges.outgoing.concat(part.edges.outgoing),
+      invisible: graph.edges.invisible.concat(part.edges.invisible),
+    },
+  };
+}
+
+export function carryPositions(graph: IPetriNet, previous: IPetriNet, diff: IPetriNetDiff): IPetriNet {
+  const placed = new Map<number, any>();
+  [].concat(...previous.transitions, ...previous.nodes).forEach((node: any) => {
+    if (node.x !== undefined) {
+      placed.set(node.id, node);
+    }
+  });
+
+  [].concat(...graph.transitions, ...graph.nodes).forEach((node: any) => {
+    const id = diff.previous[node.id];
+    if (id !== undefined && id !== noPreviousVertex && placed.has(id)) {
+      node.x = placed.get(id).x;
+      node.y = placed.get(id).y;
+    }
+  });
+  return graph;
 }
 
 interface IPetriNetProps {
@@ -20,13 +166,32 @@ interface IPetriNetProps {
   readonly transitionSize: number;
   readonly zIndex: number;
   readonly setSVGReference: (x: SVGSVGElement) => void;
+  readonly onExpand?: (node: INode, transition: boolean) => any;
 }
 
 function all(xs: boolean[]): boolean {
   return xs.reduce((x, y) => x && y, true);
 }
 
-function createSimulation(nodes: INode[], edges: IEdges, centre: [number, number]): any {
+function placeNodes(nodes: INode[], positions: Float64Array, centre: [number, number]): void {
+  nodes.forEach((node: any) => {
+    if (node.x === undefined) {
+      node.x = positions[2 * node.id] + centre[0];
+      node.y = positions[2 * node.id + 1] + centre[1];
+    }
+  });
+}
+
+function createSimulation(
+  nodes: INode[],
+  edges: IEdges,
+  centre: [number, number],
+  positions?: Float64Array,
+): any {
+  if (positions) {
+    placeNodes(nodes, positions, centre);
+  }
+
   const links = edges.incoming.concat(
     edges.outgoing,
     edges.invisible,
@@ -39,6 +204,9 @@ function createSimulation(nodes: INode[], edges: IEdges, centre: [number, number
     .nodes(nodes);
 
   simulation.force('link').links(links);
+  if (positions) {
+    simulation.alpha(0.05);
+  }
   return simulation;
 }
 
@@ -55,7 +223,7 @@ export class PetriNetDiagram extends Component<IPetriNetProps, IPetriNetDiagramP
     // prevState.simulation.stop();
     return {nodes, simulation: createSimulation(nodes, nextProps.graphData.edges, [
       nextProps.width / 2, nextProps.height / 2,
-    ])};
+    ], nextProps.graphData.positions)};
   }
 
   constructor(props: IPetriNetProps) {
@@ -70,7 +238,7 @@ export class PetriNetDiagram extends Component<IPetriNetProps, IPetriNetDiagramP
       nodes,
       simulation: createSimulation(nodes, props.graphData.edges, [
         this.props.width / 2, this.props.height / 2,
-      ]),
+      ], props.graphData.positions),
     };
   }
 
@@ -115,6 +283,7 @@ export class PetriNetDiagram extends Component<IPetriNetProps, IPetriNetDiagramP
           nodes={this.props.graphData.nodes}
           radius={this.props.placeSize}
           simulation={this.state.simulation}
+          onExpand={this.props.onExpand}
         />
         <TransitionNodes
           transitions={this.props.graphData.transitions}
@@ -123,6 +292,7 @@ export class PetriNetDiagram extends Component<IPetriNetProps, IPetriNetDiagramP
           simulation={this.state.simulation}
           fillColour={this.getTransitionColour.bind(this)}
           onClick={this.fireIfActive.bind(this)}
+          onExpand={this.props.onExpand}
         />
       </svg>
     );
@@ -1,5 +1,6 @@
 import { PureComponent } from 'react';
 import { IPetriNet, PetriNetDiagram } from './petri_net_diagram';
+import { INode } from './place_nodes';
 import { PetriTypeForm } from './petri_type_form';
 import { Selection } from './selection';
 
@@ -19,6 +20,7 @@ interface IPetriTypeComponentProps {
   readonly setTransform: (x:string) => any;
   readonly setVariable: (x: string) => any;
   readonly setSVGReference: (x: SVGSVGElement) => void;
+  readonly expandRegion: (node: INode, transition: boolean) => any;
 }
 
 export class PetriTypeComponent extends PureComponent<IPetriTypeComponentProps, {}> {
@@ -47,6 +49,7 @@ export class PetriTypeComponent extends PureComponent<IPetriTypeComponentProps,
           placeSize={18}
           transitionSize={28}
           setSVGReference={this.props.setSVGReference}
+          onExpand={this.props.expandRegion}
           zIndex={zIndex - 1}
         />
       </div>
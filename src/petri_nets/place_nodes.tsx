@@ -4,6 +4,8 @@ import { node_drag } from './node_drag';
 
 export interface INode {
   readonly id: number;
+  readonly group?: number;
+  readonly multiplicity?: number;
 }
 
 export interface IPlaceNode extends INode {
@@ -12,10 +14,18 @@ export interface IPlaceNode extends INode {
   readonly count: number;
 }
 
+function placeLabel(node: IPlaceNode): string {
+  if (node.multiplicity > 1) {
+    return `${node.multiplicity}`;
+  }
+  return node.count > 0 ? 'f' : '';
+}
+
 interface IPlaceNodesProps {
   readonly nodes: IPlaceNode[][];
   readonly radius: number;
   readonly simulation: any;
+  readonly onExpand?: (node: INode, transition: boolean) => any;
 }
 
 export class PlaceNodes extends Component<IPlaceNodesProps, {}> {
@@ -62,6 +72,10 @@ export class PlaceNodes extends Component<IPlaceNodesProps, {}> {
       .style('stroke-width', '2')
       .call(node_drag(this.props.simulation));
 
+    d3.select(this.ref)
+      .selectAll('circle.node')
+      .on('dblclick', (d: IPlaceNode) => this.expand(d));
+
     nodes.exit().remove();
 
     const text = d3.select(this.ref)
@@ -70,16 +84,22 @@ export class PlaceNodes extends Component<IPlaceNodesProps, {}> {
       .selectAll('text')
       .data(d => d);
 
-    text.text(d => d.count > 0 ? 'f' : '')
+    text.text(placeLabel)
       .attr('class', 'function')
       .call(node_drag(this.props.simulation));
 
     text.enter().append('text')
       .attr('class', 'function')
-      .text(d => d.count > 0 ? 'f' : '')
+      .text(placeLabel)
       .call(node_drag(this.props.simulation));
 
     text.exit().remove();
   }
 
+  private expand(node: IPlaceNode): void {
+    if (this.props.onExpand && node.multiplicity > 1) {
+      this.props.onExpand(node, false);
+    }
+  }
+
 }
@@ -4,6 +4,8 @@ import { node_drag } from './node_drag';
 
 interface INode {
   readonly id: number;
+  readonly group?: number;
+  readonly multiplicity?: number;
 }
 
 interface ITransitionProps {
@@ -13,6 +15,7 @@ interface ITransitionProps {
   readonly simulation: any;
   readonly fillColour: (node: INode) => string;
   readonly onClick: (node: INode, index: number) => any;
+  readonly onExpand?: (node: INode, transition: boolean) => any;
 }
 
 export class TransitionNodes extends Component<ITransitionProps, {}> {
@@ -56,5 +59,15 @@ export class TransitionNodes extends Component<ITransitionProps, {}> {
       .on('click', this.props.onClick);
 
     nodes.exit().remove();
+
+    d3.select(this.ref)
+      .selectAll('rect.node')
+      .on('dblclick', (d: INode) => this.expand(d));
+  }
+
+  private expand(node: INode): void {
+    if (this.props.onExpand && node.multiplicity > 1) {
+      this.props.onExpand(node, true);
+    }
   }
 }
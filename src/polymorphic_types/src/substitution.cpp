@@ -1,5 +1,7 @@
 #include "polymorphic_types/substitution.hpp"
 
+#include <functional>
+
 namespace {
 
 using namespace Project::Types;
@@ -1,5 +1,7 @@
 #include "polymorphic_types/type_replacement.hpp"
 
+#include <functional>
+
 namespace {
 
 using namespace Project::Types;
@@ -1,6 +1,8 @@
 #include "polymorphic_types/unification.hpp"
 #include "polymorphic_types/type_equality.hpp"
 
+#include <functional>
+
 namespace {
 
 using namespace Project::Types;
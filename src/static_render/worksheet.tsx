@@ -3,9 +3,19 @@ import MouseTrap from 'mousetrap';
 import { DropTarget } from 'react-dnd';
 import { remote } from 'electron';
 import { writeFile } from 'fs';
+import { join } from 'path';
 import {
   PetriCompositeComponent, 
   IPetriNet, 
+  IFlatPetriNet,
+  IPetriNetDiff,
+  IPetriNetChunk,
+  IPetriNetSummary,
+  INode,
+  expandFlatPetriNet,
+  expandPetriNetSummary,
+  mergePetriNetChunk,
+  carryPositions,
   ItemTypes,
   Selection,
   PetriTypeComponent 
@@ -16,12 +26,26 @@ import svg2png from 'svg2png';
 const bindings = require('bindings');
 const naturality = bindings('Naturality.node');
 
+naturality.NaturalTransformation.setCompositionCachePath(
+  join(remote.app.getPath('userData'), 'compositions.cache')
+);
+
 interface ITransformation {
   readonly graph: (x: string | number) => IPetriNet;
+  readonly flatGraph: (x: string | number) => IFlatPetriNet;
+  readonly graphs: () => IPetriNet[];
+  readonly flatGraphs: () => IFlatPetriNet[];
+  readonly layout: (x: string | number) => Float64Array;
+  readonly graphDiff: (x: string | number) => { graph: IFlatPetriNet, diff: IPetriNetDiff };
+  readonly graphChunk: (x: string | number, index: number, size?: number) => IPetriNetChunk | undefined;
+  readonly summaryGraph: (x: string | number, nodes: number[], transitions: number[], limit: number) => IPetriNetSummary;
   readonly setCospan: (x: string) => ITransformation;
+  readonly editCospan: (offset: number, removed: number, inserted: string) => ITransformation;
+  readonly setTransformation: (x: string) => ITransformation;
   readonly cospanString: () => string;
   readonly string: () => string;
   readonly compose: (right: ITransformation) => ITransformation;
+  readonly recompose: () => ITransformation;
   readonly variable: (x: number) => string;
 }
 
@@ -34,8 +58,19 @@ interface IPetriNetModel {
   top: number;
   left: number;
   composite: boolean;
+  expanded: IExpandedRegions;
+  // The variable whose graphDiff produced graph, or '' when graph is a
+  // summary, a streamed merge or empty; only then do vertex ids line up.
+  diffedVariable: string;
+};
+
+interface IExpandedRegions {
+  nodes: number[];
+  transitions: number[];
 };
 
+const summaryLimit = 1500;
+
 interface IWorksheetProps {
   readonly componentHeight: number;
   readonly componentWidth: number;
@@ -82,10 +117,37 @@ function emptyGraph(): IPetriNet {
   };
 }
 
+function noExpandedRegions(): IExpandedRegions {
+  return { nodes: [], transitions: [] };
+}
+
+function generateSummary(model: IPetriNetModel): IPetriNet | undefined {
+  const summary = model.transformation.summaryGraph(
+    model.variable,
+    model.expanded.nodes,
+    model.expanded.transitions,
+    summaryLimit,
+  );
+  return summary.summarised ? expandPetriNetSummary(summary) : undefined;
+}
+
 function generateGraph(model: IPetriNetModel): IPetriNet {
+  const previous = model.diffedVariable === model.variable ? model.graph : emptyGraph();
+  model.diffedVariable = '';
   if (model.variable.length !== 0) {
     try {
-      return model.transformation.graph(model.variable);
+      const summary = generateSummary(model);
+      if (summary) {
+        return summary;
+      }
+
+      const { graph, diff } = model.transformation.graphDiff(model.variable);
+      model.diffedVariable = model.variable;
+      return carryPositions(
+        expandFlatPetriNet(graph, model.transformation.layout(model.variable)),
+        previous,
+        diff,
+      );
     } catch (err) {
       return emptyGraph();
     }
@@ -93,13 +155,33 @@ function generateGraph(model: IPetriNetModel): IPetriNet {
   return emptyGraph();
 }
 
+function editCospan(transformation: ITransformation, previous: string, cospan: string) {
+  let prefix = 0;
+  const length = Math.min(previous.length, cospan.length);
+  while (prefix < length && previous[prefix] === cospan[prefix]) {
+    ++prefix;
+  }
+
+  let suffix = 0;
+  while (suffix < length - prefix &&
+         previous[previous.length - suffix - 1] === cospan[cospan.length - suffix - 1]) {
+    ++suffix;
+  }
+
+  const removed = previous.slice(prefix, previous.length - suffix);
+  const inserted = cospan.slice(prefix, cospan.length - suffix);
+  transformation.editCospan(Buffer.byteLength(previous.slice(0, prefix)),
+                            Buffer.byteLength(removed), inserted);
+}
+
 function setCospan(models: IPetriNetModel[], index: number, cospan: string): IPetriNetModel[] {
   let newModels = models.slice(0, index);
   let modified = models[index];
+  const previous = modified.cospan;
   modified.cospan = cospan;
   
   try {
-    modified.transformation.setCospan(cospan);
+    editCospan(modified.transformation, previous, cospan);
     modified.graph = generateGraph(modified);
   } catch (err) {}
 
@@ -111,6 +193,7 @@ function setVariable(models: IPetriNetModel[], index: number, variable: string):
   let newModels = models.slice(0, index);
   let modified = models[index];
   modified.variable = variable;
+  modified.expanded = noExpandedRegions();
   modified.graph = generateGraph(modified);
   newModels.push(modified);
   return newModels.concat(models.slice(index + 1));
@@ -121,7 +204,11 @@ function setTransform(models: IPetriNetModel[], index: number, transform: string
   let modified = models[index];
 
   try {
-    modified.transformation = naturality.createTransformation(transform);
+    if (modified.transformation) {
+      modified.transformation.setTransformation(transform);
+    } else {
+      modified.transformation = naturality.createTransformation(transform);
+    }
     modified.cospan = modified.transformation.cospanString();
     modified.graph = generateGraph(modified);
   } catch (err) {}
@@ -131,6 +218,48 @@ function setTransform(models: IPetriNetModel[], index: number, transform: string
   return newModels.concat(models.slice(index + 1));
 }
 
+function restartGraph(model: IPetriNetModel): boolean {
+  model.graph = emptyGraph();
+  model.diffedVariable = '';
+  if (model.variable.length === 0) {
+    return false;
+  }
+
+  try {
+    const summary = generateSummary(model);
+    if (summary) {
+      model.graph = summary;
+      return false;
+    }
+  } catch (err) {
+    return false;
+  }
+  return true;
+}
+
+function refreshComposites(models: IPetriNetModel[]): IPetriNetModel[] {
+  return models.filter((model) => {
+    if (!model.composite) {
+      return false;
+    }
+
+    const { transform, cospan } = model;
+    try {
+      model.transform = model.transformation.string();
+      model.cospan = model.transformation.cospanString();
+    } catch (err) {
+      model.graph = emptyGraph();
+      model.diffedVariable = '';
+      return false;
+    }
+
+    if (model.transform === transform && model.cospan === cospan) {
+      return false;
+    }
+    return restartGraph(model);
+  });
+}
+
 function setPosition(models: IPetriNetModel[], index: number, top: number, left: number) {
   let newModels = models.slice(0, index);
   let modified = models[index];
@@ -150,6 +279,8 @@ function emptyModel(): IPetriNetModel {
     top: 0,
     left: 0,
     composite: false,
+    expanded: noExpandedRegions(),
+    diffedVariable: '',
   };
 }
 
@@ -197,21 +328,54 @@ class Worksheet extends Component<IWorksheetProps, IWorksheetState> {
     const left = this.state.models[this.state.primarySelected];
     const right = this.state.models[this.state.secondarySelected];
     const composed = left.transformation.compose(right.transformation);
+    const model = {
+      left: (left.left + right.left) / 2.0,
+      top: (left.top + right.top) / 2.0,
+      variable: composed.variable(0),
+      cospan: composed.cospanString(),
+      transform: composed.string(),
+      graph: emptyGraph(),
+      transformation: composed,
+      composite: true,
+      expanded: noExpandedRegions(),
+      diffedVariable: '',
+    };
+    const summary = generateSummary(model);
 
     this.setState({
-      models: [...this.state.models, {
-        left: (left.left + right.left) / 2.0,
-        top: (left.top + right.top) / 2.0,
-        variable: composed.variable(0),
-        cospan: composed.cospanString(),
-        transform: composed.string(),
-        graph: composed.graph(0),
-        transformation: composed,
-        composite: true,
-      }],
+      models: [...this.state.models, { ...model, graph: summary || model.graph }],
+    }, () => {
+      if (!summary) {
+        this.streamGraph(composed, 0);
+      }
     });
   }
 
+  private expandRegion(index: number, node: INode, transition: boolean) {
+    const model = this.state.models[index];
+    const regions = transition ? model.expanded.transitions : model.expanded.nodes;
+    regions.push(node.group);
+    model.graph = generateGraph(model);
+    this.setState({ models: this.state.models.slice() });
+  }
+
+  private streamGraph(transformation: ITransformation, variable: string | number) {
+    let graph = this.state.models.find(model => model.transformation === transformation).graph;
+
+    const deliver = (index: number) => {
+      const model = this.state.models.find(x => x.transformation === transformation);
+      const chunk = model && model.graph === graph ? transformation.graphChunk(variable, index) : undefined;
+      if (!chunk) {
+        return;
+      }
+
+      graph = mergePetriNetChunk(graph, chunk);
+      model.graph = graph;
+      this.setState({ models: this.state.models.slice() }, () => setImmediate(() => deliver(index + 1)));
+    };
+    deliver(0);
+  }
+
   private selectComponent(shift: boolean, i: number) {
     if (shift && this.state.primarySelected >= 0) {
       if (this.state.secondarySelected >= 0) {
@@ -277,14 +441,17 @@ class Worksheet extends Component<IWorksheetProps, IWorksheetState> {
   }
 
   private setTransformation(index: number, transform: string) {
-    this.setState({
-      models: setTransform(this.state.models, index, transform),
-    });
+    this.setModels(setTransform(this.state.models, index, transform));
   }
 
   private setCospan(index: number, cospan: string) {
-    this.setState({
-      models: setCospan(this.state.models, index, cospan),
+    this.setModels(setCospan(this.state.models, index, cospan));
+  }
+
+  private setModels(models: IPetriNetModel[]) {
+    const streamed = refreshComposites(models);
+    this.setState({ models }, () => {
+      streamed.forEach(model => this.streamGraph(model.transformation, model.variable));
     });
   }
 
@@ -359,6 +526,7 @@ class Worksheet extends Component<IWorksheetProps, IWorksheetState> {
         setVariable={(variable: string) => this.setVariable(index, variable)}
         setTransform={(transform: string) => this.setTransformation(index, transform)}
         setSVGReference={(ref: SVGSVGElement) => this.setSVGReference(index, ref)}
+        expandRegion={(node: INode, transition: boolean) => this.expandRegion(index, node, transition)}
       />
     );
   }
@@ -383,6 +551,7 @@ class Worksheet extends Component<IWorksheetProps, IWorksheetState> {
         transform={model.transform}
         setVariable={(variable: string) => this.setVariable(index, variable)}
         setSVGReference={(ref: SVGSVGElement) => this.setSVGReference(index, ref)}
+        expandRegion={(node: INode, transition: boolean) => this.expandRegion(index, node, transition)}
       />
     );
   }
@@ -0,0 +1,72 @@
+#ifndef __UNIFIED_COSPAN_PARSER_HPP_
+#define __UNIFIED_COSPAN_PARSER_HPP_
+
+#include "naturality/cospan.hpp"
+#include "naturality/natural_transformation.hpp"
+#include "naturality/unify_cospan_with_type.hpp"
+
+#include <optional>
+#include <string>
+#include <variant>
+
+namespace Project {
+namespace Types {
+
+struct UnifiedCospan {
+  Naturality::CospanStructure cospan;
+  std::vector<std::size_t> value_count;
+};
+
+struct CospanSyntaxError {
+  std::size_t position;
+};
+
+using CospanParse = std::variant<UnifiedCospan, CospanSyntaxError,
+                                 Naturality::CospanMismatch>;
+
+struct CospanSpan {
+  std::size_t begin;
+  std::size_t end;
+  bool functor_variable;
+  std::vector<CospanSpan> children;
+};
+
+class IncrementalCospanParser {
+public:
+  IncrementalCospanParser(Naturality::NaturalTransformation const &);
+
+  CospanParse parse(std::string const &);
+  CospanParse edit(std::size_t, std::size_t, std::string const &);
+  std::string const &text() const;
+
+private:
+  bool reparse(std::size_t, std::size_t, std::size_t);
+  CospanParse const &unify();
+
+  Naturality::NaturalTransformation m_transformation;
+  std::string m_text;
+  std::vector<Naturality::CospanMorphism> m_domains;
+  std::vector<std::vector<CospanSpan>> m_spans;
+  bool m_parsed;
+  std::optional<CospanParse> m_unified;
+};
+
+// Seeds a parser with the printed form of the cospan. Returns nothing when
+// that form does not parse back, as for composites with more than two
+// domains, since every later edit would then fail on text never typed.
+std::optional<IncrementalCospanParser>
+create_cospan_editor(Naturality::NaturalTransformation const &,
+                     Naturality::CospanStructure const &);
+
+CospanParse
+parse_unified_cospan(std::string const &cospan_string,
+                     Naturality::NaturalTransformation const &transformation);
+
+CospanParse
+parse_unified_cospan(std::string const &domain, std::string const &codomain,
+                     Naturality::NaturalTransformation const &transformation);
+
+} // namespace Types
+} // namespace Project
+
+#endif
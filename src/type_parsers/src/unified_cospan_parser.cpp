@@ -0,0 +1,442 @@
+#include "type_parsers/unified_cospan_parser.hpp"
+
+#include "naturality/cospan_equality.hpp"
+#include "naturality/cospan_shared_count.hpp"
+#include "naturality/cospan_to_string.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace {
+
+using namespace Project::Types;
+using namespace Project::Naturality;
+
+using MappedTypes = std::vector<CospanMorphism::MappedType>;
+using Spans = std::vector<CospanSpan>;
+
+struct CospanReader {
+  std::string const &text;
+  std::size_t position;
+  std::size_t furthest;
+  std::unordered_map<std::size_t, std::size_t> *symbols;
+};
+
+bool is_space(CospanReader const &reader) {
+  return reader.position < reader.text.size() &&
+         std::isspace(static_cast<unsigned char>(reader.text[reader.position]));
+}
+
+bool is_digit(CospanReader const &reader) {
+  return reader.position < reader.text.size() &&
+         std::isdigit(static_cast<unsigned char>(reader.text[reader.position]));
+}
+
+void skip_space(CospanReader &reader) {
+  while (is_space(reader))
+    ++reader.position;
+}
+
+bool at_end(CospanReader &reader) {
+  skip_space(reader);
+  return reader.position == reader.text.size();
+}
+
+void update_furthest(CospanReader &reader) {
+  reader.furthest = std::max(reader.furthest, reader.position);
+}
+
+bool read_literal(CospanReader &reader, char const *literal) {
+  skip_space(reader);
+  update_furthest(reader);
+  auto const length = std::strlen(literal);
+  if (reader.text.compare(reader.position, length, literal) != 0)
+    return false;
+  reader.position += length;
+  return true;
+}
+
+std::size_t find_or_insert_symbol(CospanReader &reader, std::size_t symbol) {
+  if (!reader.symbols)
+    return symbol;
+  auto const symbol_count = reader.symbols->size();
+  return reader.symbols->emplace(symbol, symbol_count).first->second;
+}
+
+std::optional<std::size_t> read_identifier(CospanReader &reader) {
+  skip_space(reader);
+  update_furthest(reader);
+  auto const start = reader.position;
+  std::size_t value = 0;
+
+  while (is_digit(reader)) {
+    std::size_t const digit = reader.text[reader.position] - '0';
+    if (value > (std::numeric_limits<std::size_t>::max() - digit) / 10) {
+      reader.position = start;
+      return std::nullopt;
+    }
+    value = value * 10 + digit;
+    ++reader.position;
+  }
+
+  if (reader.position == start)
+    return std::nullopt;
+  return find_or_insert_symbol(reader, value);
+}
+
+std::optional<MappedTypes> read_type(CospanReader &, Spans *);
+
+CospanMorphism::Type nested_type(MappedTypes &&types) {
+  if (types.size() == 1)
+    return std::move(types.front().type);
+  return CospanMorphism{std::move(types)};
+}
+
+Spans nested_spans(Spans &&spans) {
+  if (spans.size() == 1)
+    return std::move(spans.front().children);
+  return std::move(spans);
+}
+
+std::optional<CospanMorphism::Type> read_atomic_type(CospanReader &reader,
+                                                     Spans *children) {
+  auto const start = reader.position;
+  if (auto const identifier = read_identifier(reader))
+    return CospanMorphism::Type{*identifier};
+
+  if (read_literal(reader, "(")) {
+    Spans spans;
+    auto type = read_type(reader, children ? &spans : nullptr);
+    if (type && read_literal(reader, ")")) {
+      if (children)
+        *children = nested_spans(std::move(spans));
+      return nested_type(std::move(*type));
+    }
+  }
+  reader.position = start;
+  return std::nullopt;
+}
+
+Variance read_polarity(CospanReader &reader) {
+  auto const start = reader.position;
+  if (read_literal(reader, "+"))
+    return Variance::COVARIANCE;
+  else if (read_literal(reader, "-"))
+    return Variance::CONTRAVARIANCE;
+  reader.position = start;
+  return Variance::COVARIANCE;
+}
+
+std::optional<CospanMorphism::MappedType>
+read_functor_variable(CospanReader &reader, Spans *spans) {
+  auto const begin = reader.position;
+  Spans children;
+  auto type = read_atomic_type(reader, spans ? &children : nullptr);
+  if (!type)
+    return std::nullopt;
+  auto const variance = read_polarity(reader);
+
+  if (spans)
+    spans->push_back({begin, reader.position, true, std::move(children)});
+  return CospanMorphism::MappedType{std::move(*type), variance};
+}
+
+std::optional<CospanMorphism::Type> read_functor(CospanReader &reader,
+                                                 Spans *children) {
+  auto const start = reader.position;
+  Spans spans;
+  auto *const variable_spans = children ? &spans : nullptr;
+  auto first = read_functor_variable(reader, variable_spans);
+  if (!first)
+    return std::nullopt;
+
+  MappedTypes variables;
+  variables.emplace_back(std::move(*first));
+  while (is_space(reader)) {
+    auto const separator = reader.position++;
+    auto next = read_functor_variable(reader, variable_spans);
+    if (!next) {
+      reader.position = separator;
+      break;
+    }
+    variables.emplace_back(std::move(*next));
+  }
+
+  if (variables.size() < 2) {
+    reader.position = start;
+    return std::nullopt;
+  }
+
+  if (children)
+    *children = std::move(spans);
+  return CospanMorphism{std::move(variables)};
+}
+
+std::optional<CospanMorphism::Type> read_base_type(CospanReader &reader,
+                                                   Spans *spans) {
+  auto const begin = reader.position;
+  Spans children;
+  auto *const nested = spans ? &children : nullptr;
+  auto type = read_functor(reader, nested);
+  if (!type)
+    type = read_atomic_type(reader, nested);
+
+  if (type && spans)
+    spans->push_back({begin, reader.position, false, std::move(children)});
+  return type;
+}
+
+std::optional<MappedTypes> read_type(CospanReader &reader, Spans *spans) {
+  MappedTypes types;
+  auto type = read_base_type(reader, spans);
+  if (!type)
+    return std::nullopt;
+  types.push_back({std::move(*type), Variance::CONTRAVARIANCE});
+
+  while (true) {
+    auto const start = reader.position;
+    if (!read_literal(reader, "->"))
+      break;
+    if (auto next = read_base_type(reader, spans))
+      types.push_back({std::move(*next), Variance::CONTRAVARIANCE});
+    else {
+      reader.position = start;
+      break;
+    }
+  }
+
+  types.back().variance = Variance::COVARIANCE;
+  return std::move(types);
+}
+
+void densify_values(CospanMorphism &morphism,
+                    std::unordered_map<std::size_t, std::size_t> &symbols) {
+  for (auto &&mapped : morphism.map) {
+    if (auto const value = std::get_if<std::size_t>(&mapped.type)) {
+      auto const symbol_count = symbols.size();
+      mapped.type = symbols.emplace(*value, symbol_count).first->second;
+    } else if (auto const nested = std::get_if<CospanMorphism>(&mapped.type))
+      densify_values(*nested, symbols);
+  }
+}
+
+bool is_same_type(CospanMorphism::Type const &left,
+                  CospanMorphism::Type const &right) {
+  return std::visit([&](auto const &type) { return is_equal(left, type); },
+                    right);
+}
+
+void shift_spans(Spans &spans, std::size_t from, std::ptrdiff_t delta) {
+  for (auto &&span : spans) {
+    if (span.begin >= from)
+      span.begin += delta;
+    if (span.end >= from)
+      span.end += delta;
+    shift_spans(span.children, from, delta);
+  }
+}
+
+struct SpanPath {
+  std::vector<CospanSpan *> spans;
+  std::vector<CospanMorphism::MappedType *> types;
+};
+
+SpanPath find_span_path(Spans &spans, CospanMorphism &morphism,
+                        std::size_t begin, std::size_t end) {
+  SpanPath path;
+  auto *level = &spans;
+  auto *current = &morphism;
+
+  while (current) {
+    auto const span = std::find_if(
+        level->begin(), level->end(), [&](CospanSpan const &candidate) {
+          return candidate.begin <= begin && end <= candidate.end;
+        });
+    if (span == level->end())
+      break;
+
+    auto &type = current->map[span - level->begin()];
+    path.spans.emplace_back(&*span);
+    path.types.emplace_back(&type);
+    level = &span->children;
+    current =
+        level->empty() ? nullptr : std::get_if<CospanMorphism>(&type.type);
+  }
+  return std::move(path);
+}
+
+CospanParse unify_parsed_cospan(std::vector<CospanMorphism> &&domains,
+                                std::size_t number_of_symbols,
+                                NaturalTransformation const &transformation) {
+  auto shared_counts = shared_count(domains);
+  CospanStructure cospan{std::move(domains), std::move(shared_counts), 0,
+                         number_of_symbols};
+
+  auto unification = try_unify_cospan_with_type(transformation, cospan);
+  if (auto mismatch = std::get_if<CospanMismatch>(&unification))
+    return std::move(*mismatch);
+  return UnifiedCospan{
+      std::move(cospan),
+      std::move(std::get<std::vector<std::size_t>>(unification))};
+}
+
+} // namespace
+
+namespace Project {
+namespace Types {
+
+IncrementalCospanParser::IncrementalCospanParser(
+    NaturalTransformation const &transformation)
+    : m_transformation(transformation), m_parsed(false) {}
+
+std::string const &IncrementalCospanParser::text() const { return m_text; }
+
+CospanParse IncrementalCospanParser::parse(std::string const &cospan_string) {
+  m_text = cospan_string;
+  m_domains.clear();
+  m_spans.assign(2, {});
+  m_parsed = false;
+  m_unified.reset();
+
+  CospanReader reader{m_text, 0, 0, nullptr};
+  auto domain = read_type(reader, &m_spans[0]);
+  if (!domain || !read_literal(reader, "=>"))
+    return CospanSyntaxError{reader.furthest};
+  auto codomain = read_type(reader, &m_spans[1]);
+  if (!codomain || !at_end(reader))
+    return CospanSyntaxError{std::max(reader.furthest, reader.position)};
+
+  m_domains = {CospanMorphism{std::move(*domain)},
+               CospanMorphism{std::move(*codomain)}};
+  m_parsed = true;
+  return unify();
+}
+
+CospanParse IncrementalCospanParser::edit(std::size_t offset,
+                                          std::size_t removed,
+                                          std::string const &inserted) {
+  if (offset > m_text.size() || removed > m_text.size() - offset)
+    throw std::runtime_error("cospan edit is out of range");
+
+  auto text = m_text;
+  text.replace(offset, removed, inserted);
+  if (!m_parsed)
+    return parse(text);
+
+  m_text = std::move(text);
+  if (!reparse(offset, offset + removed, inserted.size()))
+    return parse(m_text);
+  return unify();
+}
+
+bool IncrementalCospanParser::reparse(std::size_t begin, std::size_t end,
+                                      std::size_t inserted) {
+  auto const delta = static_cast<std::ptrdiff_t>(inserted) -
+                     static_cast<std::ptrdiff_t>(end - begin);
+
+  for (auto i = 0u; i < m_domains.size(); ++i) {
+    auto path = find_span_path(m_spans[i], m_domains[i], begin, end);
+
+    for (auto j = path.spans.size(); j > 0; --j) {
+      auto &span = *path.spans[j - 1];
+      auto &type = *path.types[j - 1];
+      auto const old_end = span.end;
+      std::size_t const new_end = old_end + delta;
+
+      CospanReader reader{m_text, span.begin, span.begin, nullptr};
+      Spans spans;
+      if (span.functor_variable) {
+        auto variable = read_functor_variable(reader, &spans);
+        if (!variable || reader.position != new_end)
+          continue;
+        if (type.variance != variable->variance ||
+            !is_same_type(type.type, variable->type))
+          m_unified.reset();
+        type = std::move(*variable);
+      } else {
+        auto base = read_base_type(reader, &spans);
+        if (!base || reader.position != new_end)
+          continue;
+        if (!is_same_type(type.type, *base))
+          m_unified.reset();
+        type.type = std::move(*base);
+      }
+
+      for (auto &&domain_spans : m_spans)
+        shift_spans(domain_spans, old_end, delta);
+      span = std::move(spans.front());
+      return true;
+    }
+  }
+  return false;
+}
+
+CospanParse const &IncrementalCospanParser::unify() {
+  if (m_unified)
+    return *m_unified;
+
+  std::unordered_map<std::size_t, std::size_t> symbols;
+  auto domains = m_domains;
+  for (auto &&domain : domains)
+    densify_values(domain, symbols);
+  m_unified = unify_parsed_cospan(std::move(domains), symbols.size(),
+                                  m_transformation);
+  return *m_unified;
+}
+
+std::optional<IncrementalCospanParser>
+create_cospan_editor(NaturalTransformation const &transformation,
+                     CospanStructure const &cospan) {
+  IncrementalCospanParser parser(transformation);
+  if (!std::holds_alternative<UnifiedCospan>(parser.parse(to_string(cospan))))
+    return std::nullopt;
+  return std::move(parser);
+}
+
+CospanParse
+parse_unified_cospan(std::string const &cospan_string,
+                     NaturalTransformation const &transformation) {
+  std::unordered_map<std::size_t, std::size_t> symbols;
+  CospanReader reader{cospan_string, 0, 0, &symbols};
+
+  auto domain = read_type(reader, nullptr);
+  if (!domain || !read_literal(reader, "=>"))
+    return CospanSyntaxError{reader.furthest};
+  auto codomain = read_type(reader, nullptr);
+  if (!codomain || !at_end(reader))
+    return CospanSyntaxError{std::max(reader.furthest, reader.position)};
+
+  return unify_parsed_cospan({CospanMorphism{std::move(*domain)},
+                              CospanMorphism{std::move(*codomain)}},
+                             symbols.size(), transformation);
+}
+
+CospanParse
+parse_unified_cospan(std::string const &domain_string,
+                     std::string const &codomain_string,
+                     NaturalTransformation const &transformation) {
+  std::unordered_map<std::size_t, std::size_t> symbols;
+  CospanReader domain_reader{domain_string, 0, 0, &symbols};
+  auto domain = read_type(domain_reader, nullptr);
+  if (!domain || !at_end(domain_reader))
+    return CospanSyntaxError{
+        std::max(domain_reader.furthest, domain_reader.position)};
+
+  CospanReader codomain_reader{codomain_string, 0, 0, &symbols};
+  auto codomain = read_type(codomain_reader, nullptr);
+  if (!codomain || !at_end(codomain_reader))
+    return CospanSyntaxError{
+        std::max(codomain_reader.furthest, codomain_reader.position)};
+
+  return unify_parsed_cospan({CospanMorphism{std::move(*domain)},
+                              CospanMorphism{std::move(*codomain)}},
+                             symbols.size(), transformation);
+}
+
+} // namespace Types
+} // namespace Project
@@ -1,8 +1,15 @@
 #include "cospan_parser_test.hpp"
 
 #include "type_parsers/cospan_parser.hpp"
+#include "type_parsers/transformation_parser.hpp"
+#include "type_parsers/unified_cospan_parser.hpp"
+
+#include "naturality/cospan_composition.hpp"
+#include "naturality/cospan_equality.hpp"
+#include "naturality/natural_composition.hpp"
 
 using namespace Project::Types;
+using namespace Project::Naturality;
 
 CospanParserTest::CospanParserTest() {}
 
@@ -35,3 +42,107 @@ TEST(CospanParserTest, TEST_FUNCTOR_PARSE) {
 TEST(CospanParserTest, TEST_COMPLEX_PARSE) {
   auto const cospan = parse_cospan("(0 -> 0) -> 0 -> (0 -> 0) => (0 -> 0)");
 }
+
+TEST(CospanParserTest, TEST_UNIFIED_PARSE) {
+  std::vector<std::pair<std::string, std::string>> const cospans{
+      {"a => a", "0 => 0"},
+      {"a -> a => a -> a", "0 -> 1 => 1 -> 0"},
+      {"a -> (a -> a) => (a -> a)", "0 -> (1 -> 2) => (2 -> 0)"},
+      {"(a -> a) -> a => (a -> a)", "(0 -> 1) -> 1 => (2 -> 2)"},
+      {"f a b => f b a", "0 1 => 1 0"},
+      {"(a -> b) -> a => b", "(7 -> 8) -> 7 => 8"},
+      {"(a -> a) -> a -> (a -> a) => (a -> a)",
+       "(0 -> 0) -> 1 -> (2 -> 3) => (3 -> 0)"}};
+
+  for (auto &&cospan : cospans) {
+    auto const transformation = parse_transformation(cospan.first);
+    auto expected = parse_cospan(cospan.second);
+    auto const expected_count =
+        unify_cospan_with_type(transformation, expected);
+
+    auto const parsed = parse_unified_cospan(cospan.second, transformation);
+    auto const unified = std::get_if<UnifiedCospan>(&parsed);
+    ASSERT_NE(unified, nullptr) << cospan.second;
+    EXPECT_EQ(unified->value_count, expected_count);
+    EXPECT_EQ(unified->cospan.shared_counts, expected.shared_counts);
+    ASSERT_EQ(unified->cospan.domains.size(), expected.domains.size());
+    for (auto i = 0u; i < expected.domains.size(); ++i)
+      EXPECT_TRUE(is_equal(unified->cospan.domains[i], expected.domains[i]));
+  }
+}
+
+TEST(CospanParserTest, TEST_UNIFIED_PARSE_ERRORS) {
+  auto const transformation = parse_transformation("a -> a => a -> a");
+
+  auto const syntax_error = parse_unified_cospan("0 -> => 0", transformation);
+  ASSERT_TRUE(std::holds_alternative<CospanSyntaxError>(syntax_error));
+  EXPECT_EQ(std::get<CospanSyntaxError>(syntax_error).position, 5u);
+
+  EXPECT_TRUE(std::holds_alternative<CospanSyntaxError>(
+      parse_unified_cospan("0 -> 0 => 0 -> 0)", transformation)));
+  EXPECT_TRUE(std::holds_alternative<Project::Naturality::CospanMismatch>(
+      parse_unified_cospan("0 -> 0 -> 0 => 0 -> 0", transformation)));
+  EXPECT_TRUE(std::holds_alternative<UnifiedCospan>(
+      parse_unified_cospan("0 -> 1", "1 -> 0", transformation)));
+}
+
+TEST(CospanParserTest, TEST_INCREMENTAL_PARSE) {
+  auto const transformation =
+      parse_transformation("(a -> a) -> a -> (a -> a) => (a -> a)");
+  std::string text = "(0 -> 0) -> 1 -> (2 -> 3) => (3 -> 0)";
+  IncrementalCospanParser parser(transformation);
+  ASSERT_TRUE(std::holds_alternative<UnifiedCospan>(parser.parse(text)));
+
+  struct Edit {
+    std::size_t offset;
+    std::size_t removed;
+    std::string inserted;
+  };
+  std::vector<Edit> const edits{{1, 1, "4"},     {18, 1, "12"}, {12, 1, ""},
+                                {12, 0, "5"},    {3, 2, ""},    {3, 0, "->"},
+                                {0, 0, "junk "}, {0, 5, ""},    {29, 1, "7 8"},
+                                {29, 3, "3"},    {29, 1, " "},
+                                {12, 0, " "},    {13, 1, "6"},
+                                {13, 1, "6"}};
+
+  for (auto &&edit : edits) {
+    text.replace(edit.offset, edit.removed, edit.inserted);
+    auto const edited = parser.edit(edit.offset, edit.removed, edit.inserted);
+    auto const expected = parse_unified_cospan(text, transformation);
+    EXPECT_EQ(parser.text(), text);
+    ASSERT_EQ(edited.index(), expected.index()) << text;
+
+    if (auto const unified = std::get_if<UnifiedCospan>(&edited)) {
+      auto const &parsed = std::get<UnifiedCospan>(expected);
+      EXPECT_EQ(unified->value_count, parsed.value_count);
+      EXPECT_EQ(unified->cospan.shared_counts, parsed.cospan.shared_counts);
+      for (auto i = 0u; i < parsed.cospan.domains.size(); ++i)
+        EXPECT_TRUE(
+            is_equal(unified->cospan.domains[i], parsed.cospan.domains[i]));
+    }
+  }
+}
+
+TEST(CospanParserTest, TEST_COSPAN_EDITOR) {
+  auto const transformation = parse_transformation("a -> a => a -> a");
+  auto const cospan = std::get<UnifiedCospan>(
+      parse_unified_cospan("0 -> 1 => 1 -> 0", transformation));
+
+  auto editor = create_cospan_editor(transformation, cospan.cospan);
+  ASSERT_TRUE(editor.has_value());
+  auto const edited = editor->edit(0, 1, "1");
+  EXPECT_TRUE(std::holds_alternative<UnifiedCospan>(edited)) << editor->text();
+
+  auto unification = *calculate_unification(
+      transformation.domains.back(), transformation.domains.front(),
+      transformation.symbols.size(), transformation.symbols.size(),
+      transformation.functor_symbols.size(),
+      transformation.functor_symbols.size());
+  auto const composite =
+      compose_transformations(transformation, transformation, unification);
+  auto const composed = compose_cospans(
+      cospan.cospan, cospan.cospan, transformation, transformation,
+      unification, composite.symbols.size());
+
+  EXPECT_FALSE(create_cospan_editor(composite, composed.cospan).has_value());
+}